@@ -36,8 +36,10 @@ enum booleanConfig_t {
 	GLOBAL_SERVER_SAVE_CLEAN_MAP,
 	GLOBAL_SERVER_SAVE_CLOSE,
 	GLOBAL_SERVER_SAVE_SHUTDOWN,
+	SERVER_SAVE_IN_BACKGROUND,
 	FORCE_MONSTERTYPE_LOAD,
 	HOUSE_OWNED_BY_ACCOUNT,
+	LAZY_LOAD_HOUSE_ITEMS,
 	CLEAN_PROTECTION_ZONES,
 	ALLOW_BLOCK_SPAWN,
 	ONLY_INVITED_CAN_MOVE_HOUSE_ITEMS,
@@ -67,6 +69,7 @@ enum booleanConfig_t {
 	TOGGLE_DOWNLOAD_MAP,
 	USE_ANY_DATAPACK_FOLDER,
 	ALLOW_RELOAD,
+	ADAPTIVE_COMPRESSION,
 
 	LAST_BOOLEAN_CONFIG
 	};
@@ -106,6 +109,9 @@ enum stringConfig_t {
 
 enum integerConfig_t {
 	SQL_PORT,
+	MYSQL_POOL_SIZE,
+	LOGIN_LOADER_THREADS,
+	DATABASE_BATCH_DELAY,
 	MAX_PLAYERS,
 	PZ_LOCKED,
 	DEFAULT_DESPAWNRANGE,
@@ -141,6 +147,7 @@ enum integerConfig_t {
 	EXP_FROM_PLAYERS_LEVEL_RANGE,
 	MAX_PACKETS_PER_SECOND,
 	COMPRESSION_LEVEL,
+	IO_THREADS,
 	STORE_COIN_PACKET,
 	DAY_KILLS_TO_RED,
 	WEEK_KILLS_TO_RED,
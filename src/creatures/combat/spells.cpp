@@ -75,6 +75,7 @@ TalkActionResult_t Spells::playerSaySpell(Player* player, std::string& words)
 void Spells::clear()
 {
 	instants.clear();
+	instantWords.clear();
 	runes.clear();
 }
 
@@ -88,6 +89,13 @@ bool Spells::hasInstantSpell(const std::string& word) const
 	return false;
 }
 
+void Spells::setInstantSpell(const std::string &word, InstantSpell& instant)
+{
+	if (auto [it, inserted] = instants.try_emplace(word, instant); inserted) {
+		instantWords.insert(it->second.getWords(), &it->second);
+	}
+}
+
 bool Spells::registerInstantLuaEvent(InstantSpell* event)
 {
 	InstantSpell_ptr instant { event };
@@ -188,20 +196,14 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name)
 
 InstantSpell* Spells::getInstantSpell(const std::string& words)
 {
+	// Prefixes come shortest first: keep the longest, ties go to the first words in map order
 	InstantSpell* result = nullptr;
-
-	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (strncasecmp(instantSpellWords.c_str(), words.c_str(), spellLen) == 0) {
-			if (!result || spellLen > result->getWords().length()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
-			}
+	instantWords.forEachPrefix(words, [&result](InstantSpell* instantSpell) {
+		if (!result || instantSpell->getWords().length() > result->getWords().length()
+				|| instantSpell->getWords() < result->getWords()) {
+			result = instantSpell;
 		}
-	}
+	});
 
 	if (result) {
 		const std::string& resultWords = result->getWords();
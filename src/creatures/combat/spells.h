@@ -15,6 +15,7 @@
 #include "lua/creature/actions.h"
 #include "lua/creature/talkaction.h"
 #include "lua/scripts/scripts.h"
+#include "utils/prefix_tree.hpp"
 
 class InstantSpell;
 class RuneSpell;
@@ -62,9 +63,7 @@ class Spells final : public Scripts
 
 		bool hasInstantSpell(const std::string& word) const;
 
-		void setInstantSpell(const std::string &word, InstantSpell& instant) {
-			instants.try_emplace(word, instant);
-		}
+		void setInstantSpell(const std::string &word, InstantSpell& instant);
 
 		void clear();
 		bool registerInstantLuaEvent(InstantSpell* event);
@@ -73,6 +72,8 @@ class Spells final : public Scripts
 	private:
 		std::map<uint16_t, RuneSpell> runes;
 		std::map<std::string, InstantSpell> instants;
+		// Words of instants, rebuilt as they are registered
+		PrefixTree<InstantSpell*> instantWords;
 
 		friend class CombatSpell;
 };
@@ -1193,7 +1193,7 @@ void Creature::onGainExperience(uint64_t gainExp, Creature* target)
 	master->onGainExperience(gainExp, target);
 
 	if (!m->isFamiliar()) {
-		SpectatorHashSet spectators;
+		SpectatorVec spectators;
 		g_game().map.getSpectators(spectators, position, false, true);
 		if (spectators.empty()) {
 			return;
@@ -1529,6 +1529,11 @@ bool Creature::registerCreatureEvent(const std::string& name)
 	}
 
 	eventsList.push_back(event);
+
+	// Sleeping creatures do not think, the new script would never run
+	if (type == CREATURE_EVENT_THINK && isSleeping()) {
+		g_game().wakeCreature(this);
+	}
 	return true;
 }
 
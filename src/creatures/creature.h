@@ -160,6 +160,14 @@ class Creature : virtual public Thing
 			return false;
 		}
 
+		// Whether it can stop thinking while no player is near, see Game::checkCreatures
+		virtual bool canSleep() const {
+			return false;
+		}
+		bool isSleeping() const {
+			return sleeping;
+		}
+
 		int32_t getWalkDelay(Direction dir) const;
 		int32_t getWalkDelay() const;
 		int64_t getTimeSinceLastMove() const;
@@ -570,6 +578,7 @@ class Creature : virtual public Thing
 		bool isUpdatingPath = false;
 		bool creatureCheck = false;
 		bool inCheckCreaturesVector = false;
+		bool sleeping = false;
 		bool skillLoss = true;
 		bool lootDrop = true;
 		bool cancelNextWalk = false;
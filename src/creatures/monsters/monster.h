@@ -123,6 +123,10 @@ class Monster final : public Creature
 		bool canSeeInvisibility() const override {
 			return isImmune(CONDITION_INVISIBLE);
 		}
+		// Scripted think events, from the type or registered on the creature, may act without players around
+		bool canSleep() const override {
+			return mType->info.thinkEvent == -1 && !hasEventRegistered(CREATURE_EVENT_THINK);
+		}
 		uint32_t getManaCost() const {
 			return mType->info.manaCost;
 		}
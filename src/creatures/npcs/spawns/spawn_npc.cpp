@@ -150,7 +150,7 @@ SpawnNpc::~SpawnNpc()
 
 bool SpawnNpc::findPlayer(const Position& pos)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	g_game().map.getSpectators(spectators, pos, false, true);
 	for (Creature* spectator : spectators) {
 		if (!spectator->getPlayer()->hasFlag(PlayerFlags_t::IgnoredByNpcs)) {
@@ -22,6 +22,7 @@
 #include "lua/creature/movement.h"
 #include "io/iologindata.h"
 #include "io/iobestiary.h"
+#include "io/iomapserialize.h"
 #include "items/bed.h"
 #include "items/weapons/weapons.h"
 
@@ -1520,6 +1521,13 @@ void Player::onCreatureAppear(Creature* creature, bool isLogin)
 
 		updateRegeneration();
 
+		// Most players sleep in their own house, it has to be loaded to find the bed
+		if (g_game().map.houses.hasPendingHouses()) {
+			if (House* house = g_game().map.houses.getHouseByPlayerId(guid)) {
+				IOMapSerialize::loadHouseItems(house);
+			}
+		}
+
 		BedItem* bed = g_game().getBedBySleeper(guid);
 		if (bed) {
 			bed->wakeUp(this);
@@ -2156,7 +2164,7 @@ void Player::addExperience(Creature* target, uint64_t exp, bool sendText/* = fal
 		message.primary.color = TEXTCOLOR_WHITE_EXP;
 		sendTextMessage(message);
 
-		SpectatorHashSet spectators;
+		SpectatorVec spectators;
 		g_game().map.getSpectators(spectators, position, false, true);
 		spectators.erase(this);
 		if (!spectators.empty()) {
@@ -2250,7 +2258,7 @@ void Player::removeExperience(uint64_t exp, bool sendText/* = false*/)
 		message.primary.color = TEXTCOLOR_RED;
 		sendTextMessage(message);
 
-		SpectatorHashSet spectators;
+		SpectatorVec spectators;
 		g_game().map.getSpectators(spectators, position, false, true);
 		spectators.erase(this);
 		if (!spectators.empty()) {
@@ -2705,7 +2713,7 @@ bool Player::spawn()
 		return false;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	g_game().map.getSpectators(spectators, position, true);
 	for (Creature* spectator : spectators) {
 		if (!spectator) {
@@ -2748,7 +2756,7 @@ void Player::despawn()
 
 	std::vector<int32_t> oldStackPosVector;
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	g_game().map.getSpectators(spectators, tile->getPosition(), true);
 	size_t i = 0;
 	for (Creature* spectator : spectators) {
@@ -6448,7 +6456,7 @@ bool Player::saySpell(
 	SpeakClasses type,
 	const std::string& text,
 	bool ghostMode,
-	SpectatorHashSet* spectatorsPtr/* = nullptr*/,
+	SpectatorVec* spectatorsPtr/* = nullptr*/,
 	const Position* pos/* = nullptr*/)
 {
 	if (text.empty()) {
@@ -6460,10 +6468,10 @@ bool Player::saySpell(
 		pos = &getPosition();
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 
 	if (!spectatorsPtr || spectatorsPtr->empty()) {
-		// This somewhat complex construct ensures that the cached SpectatorHashSet
+		// This somewhat complex construct ensures that the cached SpectatorVec
 		// is used if available and if it can be used, else a local vector is
 		// used (hopefully the compiler will optimize away the construction of
 		// the temporary when it's not used).
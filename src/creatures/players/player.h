@@ -84,6 +84,27 @@ struct OpenContainer {
 
 using MuteCountMap = std::map<uint32_t, uint32_t>;
 
+// Rows of a player table by key, as SQL value lists without the player id
+using PlayerRows = phmap::flat_hash_map<std::string, std::string>;
+
+/**
+ * What the player tables hold for a player, as its last load or save left them.
+ * A save only writes the rows that differ, a section not known yet is rewritten.
+ */
+struct PlayerSavedRows {
+	std::optional<PlayerRows> items;
+	std::optional<PlayerRows> depotItems;
+	std::optional<PlayerRows> rewardItems;
+	std::optional<PlayerRows> inboxItems;
+	std::optional<PlayerRows> storage;
+	std::optional<PlayerRows> spells;
+	std::optional<PlayerRows> stash;
+	std::optional<PlayerRows> prey;
+	std::optional<PlayerRows> taskHunt;
+	std::optional<std::string> kills;
+	std::optional<std::string> charms;
+};
+
 static constexpr int32_t PLAYER_MAX_SPEED = 65535;
 static constexpr int32_t PLAYER_MIN_SPEED = 10;
 
@@ -2085,7 +2106,7 @@ class Player final : public Creature, public Cylinder
 			SpeakClasses type,
 			const std::string& text,
 			bool ghostMode,
-			SpectatorHashSet* spectatorsPtr = nullptr,
+			SpectatorVec* spectatorsPtr = nullptr,
 			const Position* pos = nullptr
 		);
 
@@ -2407,6 +2428,7 @@ class Player final : public Creature, public Cylinder
 		uint16_t staminaXpBoost = 100;
 		int16_t lastDepotId = -1;
 		StashItemList stashItems; // [ItemID] = amount
+		PlayerSavedRows savedRows;
 		uint32_t movedItems = 0;
 
 		// Depot search system
@@ -12,57 +12,63 @@
 #include "config/configmanager.h"
 #include "database/database.h"
 
-Database::~Database()
+namespace {
+
+// Errors after which a query is tried again, the connection reconnects by itself
+bool isConnectionLost(unsigned int error)
 {
-	if (handle != nullptr) {
-		mysql_close(handle);
-	}
+	return error == CR_SERVER_LOST || error == CR_SERVER_GONE_ERROR || error == CR_CONN_HOST_ERROR || error == 1053/*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
 }
 
-bool Database::connect()
+}  // namespace
+
+Database::Connection::~Connection()
 {
-	// connection handle initialization
-	handle = mysql_init(nullptr);
-	if (!handle) {
-		SPDLOG_ERROR("Failed to initialize MySQL connection handle");
-		return false;
+	for (const auto &[query, statement] : statements) {
+		mysql_stmt_close(statement);
 	}
 
-	// automatic reconnect
-	bool reconnect = true;
-	mysql_options(handle, MYSQL_OPT_RECONNECT, &reconnect);
-
-	// connects to database
-	if (!mysql_real_connect(handle, g_configManager().getString(MYSQL_HOST).c_str(), g_configManager().getString(MYSQL_USER).c_str(), g_configManager().getString(MYSQL_PASS).c_str(), g_configManager().getString(MYSQL_DB).c_str(), g_configManager().getNumber(SQL_PORT), g_configManager().getString(MYSQL_SOCK).c_str(), 0)) {
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		return false;
+	if (handle != nullptr) {
+		mysql_close(handle);
 	}
+}
 
-	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
-	if (result) {
-		maxPacketSize = result->getNumber<uint64_t>("Value");
-	}
-	return true;
+Database::~Database() = default;
+
+bool Database::connect()
+{
+	return connect(g_configManager().getString(MYSQL_HOST).c_str(), g_configManager().getString(MYSQL_USER).c_str(), g_configManager().getString(MYSQL_PASS).c_str(), g_configManager().getString(MYSQL_DB).c_str(), g_configManager().getNumber(SQL_PORT), g_configManager().getString(MYSQL_SOCK).c_str(), std::max<int32_t>(1, g_configManager().getNumber(MYSQL_POOL_SIZE)));
 }
 
 bool Database::connect(const char *host, const char *user, const char *password,
-                      const char *database, uint32_t port, const char *sock) {
-	// connection handle initialization
-	handle = mysql_init(nullptr);
-	if (!handle) {
-		SPDLOG_ERROR("Failed to initialize MySQL connection handle.");
-		return false;
+                      const char *database, uint32_t port, const char *sock, uint32_t poolSize) {
+	if (!connections.empty()) {
+		return true;
 	}
 
-	// automatic reconnect
-	bool reconnect = true;
-	mysql_options(handle, MYSQL_OPT_RECONNECT, &reconnect);
+	for (uint32_t i = 0; i < poolSize; ++i) {
+		auto connection = std::make_unique<Connection>();
 
-	// connects to database
-	if (!mysql_real_connect(handle, host, user, password, database, port, sock,
-                          0)) {
-		SPDLOG_ERROR("MySQL Error Message: {}", mysql_error(handle));
-		return false;
+		// connection handle initialization
+		connection->handle = mysql_init(nullptr);
+		if (!connection->handle) {
+			SPDLOG_ERROR("Failed to initialize MySQL connection handle.");
+			connections.clear();
+			return false;
+		}
+
+		// automatic reconnect
+		bool reconnect = true;
+		mysql_options(connection->handle, MYSQL_OPT_RECONNECT, &reconnect);
+
+		// connects to database
+		if (!mysql_real_connect(connection->handle, host, user, password, database, port, sock,
+                              0)) {
+			SPDLOG_ERROR("MySQL Error Message: {}", mysql_error(connection->handle));
+			connections.clear();
+			return false;
+		}
+		connections.push_back(std::move(connection));
 	}
 
 	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
@@ -72,76 +78,92 @@ bool Database::connect(const char *host, const char *user, const char *password,
 	return true;
 }
 
+Database::Connection* Database::getConnection()
+{
+	thread_local Connection* connection = nullptr;
+	if (!connection) {
+		if (connections.empty()) {
+			SPDLOG_ERROR("Database not initialized!");
+			return nullptr;
+		}
+		connection = connections[nextConnection++ % connections.size()].get();
+	}
+	return connection;
+}
+
 bool Database::beginTransaction()
 {
-	if (!executeQuery("BEGIN")) {
+	Connection* connection = getConnection();
+	if (!connection) {
 		return false;
 	}
 
-	databaseLock.lock();
+	// Held until the commit or rollback, other connections are not blocked
+	connection->lock.lock();
+	if (!executeQuery("BEGIN")) {
+		connection->lock.unlock();
+		return false;
+	}
 	return true;
 }
 
 bool Database::rollback()
 {
-	if (!handle) {
-		SPDLOG_ERROR("Database not initialized!");
+	Connection* connection = getConnection();
+	if (!connection) {
 		return false;
 	}
 
-	if (mysql_rollback(handle) != 0) {
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	if (mysql_rollback(connection->handle) != 0) {
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		connection->lock.unlock();
 		return false;
 	}
 
-	databaseLock.unlock();
+	connection->lock.unlock();
 	return true;
 }
 
 bool Database::commit()
 {
-  if (!handle) {
-    SPDLOG_ERROR("Database not initialized!");
-    return false;
-  }
+	Connection* connection = getConnection();
+	if (!connection) {
+		return false;
+	}
 
-	if (mysql_commit(handle) != 0) {
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		databaseLock.unlock();
+	if (mysql_commit(connection->handle) != 0) {
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		connection->lock.unlock();
 		return false;
 	}
 
-	databaseLock.unlock();
+	connection->lock.unlock();
 	return true;
 }
 
 bool Database::executeQuery(const std::string& query)
 {
-  if (!handle) {
-    SPDLOG_ERROR("Database not initialized!");
-    return false;
-  }
+	Connection* connection = getConnection();
+	if (!connection) {
+		return false;
+	}
 
 	bool success = true;
 
 	// executes the query
-	databaseLock.lock();
+	std::lock_guard<std::recursive_mutex> lockGuard(connection->lock);
 
-	while (mysql_real_query(handle, query.c_str(), query.length()) != 0) {
+	while (mysql_real_query(connection->handle, query.c_str(), query.length()) != 0) {
 		SPDLOG_ERROR("Query: {}", query.substr(0, 256));
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		auto error = mysql_errno(handle);
-		if (error != CR_SERVER_LOST && error != CR_SERVER_GONE_ERROR && error != CR_CONN_HOST_ERROR && error != 1053/*ER_SERVER_SHUTDOWN*/ && error != CR_CONNECTION_ERROR) {
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		if (!isConnectionLost(mysql_errno(connection->handle))) {
 			success = false;
 			break;
 		}
 		std::this_thread::sleep_for(std::chrono::seconds(1));
 	}
 
-	MYSQL_RES* m_res = mysql_store_result(handle);
-	databaseLock.unlock();
-
+	MYSQL_RES* m_res = mysql_store_result(connection->handle);
 	if (m_res) {
 		mysql_free_result(m_res);
 	}
@@ -149,21 +171,37 @@ bool Database::executeQuery(const std::string& query)
 	return success;
 }
 
+bool Database::executeQuery(const DBStatement& statement)
+{
+	Connection* connection = getConnection();
+	if (!connection) {
+		return false;
+	}
+
+	std::lock_guard<std::recursive_mutex> lockGuard(connection->lock);
+	MYSQL_STMT* handle = executeStatement(*connection, statement);
+	if (!handle) {
+		return false;
+	}
+
+	mysql_stmt_free_result(handle);
+	return true;
+}
+
 DBResult_ptr Database::storeQuery(const std::string& query)
 {
-  if (!handle) {
-    SPDLOG_ERROR("Database not initialized!");
-    return nullptr;
-  }
+	Connection* connection = getConnection();
+	if (!connection) {
+		return nullptr;
+	}
 
-	databaseLock.lock();
+	std::lock_guard<std::recursive_mutex> lockGuard(connection->lock);
 
 	retry:
-	while (mysql_real_query(handle, query.c_str(), query.length()) != 0) {
+	while (mysql_real_query(connection->handle, query.c_str(), query.length()) != 0) {
 		SPDLOG_ERROR("Query: {}", query);
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		auto error = mysql_errno(handle);
-		if (error != CR_SERVER_LOST && error != CR_SERVER_GONE_ERROR && error != CR_CONN_HOST_ERROR && error != 1053/*ER_SERVER_SHUTDOWN*/ && error != CR_CONNECTION_ERROR) {
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		if (!isConnectionLost(mysql_errno(connection->handle))) {
 			break;
 		}
 		std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -171,18 +209,15 @@ DBResult_ptr Database::storeQuery(const std::string& query)
 
 	// we should call that every time as someone would call executeQuery('SELECT...')
 	// as it is described in MySQL manual: "it doesn't hurt" :P
-	MYSQL_RES* res = mysql_store_result(handle);
+	MYSQL_RES* res = mysql_store_result(connection->handle);
 	if (res == nullptr) {
 		SPDLOG_ERROR("Query: {}", query);
-		SPDLOG_ERROR("Message: {}", mysql_error(handle));
-		auto error = mysql_errno(handle);
-		if (error != CR_SERVER_LOST && error != CR_SERVER_GONE_ERROR && error != CR_CONN_HOST_ERROR && error != 1053/*ER_SERVER_SHUTDOWN*/ && error != CR_CONNECTION_ERROR) {
-			databaseLock.unlock();
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		if (!isConnectionLost(mysql_errno(connection->handle))) {
 			return nullptr;
 		}
 		goto retry;
 	}
-	databaseLock.unlock();
 
 	// retrieving results of query
 	DBResult_ptr result = std::make_shared<DBResult>(res);
@@ -192,6 +227,162 @@ DBResult_ptr Database::storeQuery(const std::string& query)
 	return result;
 }
 
+DBResult_ptr Database::streamQuery(const std::string& query)
+{
+	Connection* connection = getConnection();
+	if (!connection) {
+		return nullptr;
+	}
+
+	std::unique_lock<std::recursive_mutex> lock(connection->lock);
+	while (mysql_real_query(connection->handle, query.c_str(), query.length()) != 0) {
+		SPDLOG_ERROR("Query: {}", query);
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		if (!isConnectionLost(mysql_errno(connection->handle))) {
+			return nullptr;
+		}
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+
+	MYSQL_RES* res = mysql_use_result(connection->handle);
+	if (res == nullptr) {
+		SPDLOG_ERROR("Query: {}", query);
+		SPDLOG_ERROR("Message: {}", mysql_error(connection->handle));
+		return nullptr;
+	}
+
+	DBResult_ptr result(new DBResult(res, connection->handle, std::move(lock)));
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
+DBResult_ptr Database::storeQuery(const DBStatement& statement)
+{
+	Connection* connection = getConnection();
+	if (!connection) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::recursive_mutex> lockGuard(connection->lock);
+	MYSQL_STMT* handle = executeStatement(*connection, statement);
+	if (!handle || mysql_stmt_field_count(handle) == 0) {
+		return nullptr;
+	}
+
+	// Buffers the whole result client side and computes the max_length of its columns
+	if (mysql_stmt_store_result(handle) != 0) {
+		SPDLOG_ERROR("Query: {}", statement.getQuery());
+		SPDLOG_ERROR("Message: {}", mysql_stmt_error(handle));
+		mysql_stmt_free_result(handle);
+		return nullptr;
+	}
+
+	MYSQL_RES* metadata = mysql_stmt_result_metadata(handle);
+	if (!metadata) {
+		mysql_stmt_free_result(handle);
+		return nullptr;
+	}
+
+	DBResult_ptr result(new DBResult(handle, metadata));
+	mysql_free_result(metadata);
+	mysql_stmt_free_result(handle);
+	if (!result->hasNext()) {
+		return nullptr;
+	}
+	return result;
+}
+
+MYSQL_STMT* Database::executeStatement(Connection &connection, const DBStatement& statement)
+{
+	const std::string& query = statement.getQuery();
+
+	std::vector<MYSQL_BIND> binds(statement.parameters.size());
+	for (size_t i = 0; i < binds.size(); ++i) {
+		const DBStatement::Parameter &parameter = statement.parameters[i];
+		MYSQL_BIND &bind = binds[i];
+		bind.buffer_type = parameter.type;
+		bind.is_unsigned = parameter.isUnsigned;
+		if (parameter.type == MYSQL_TYPE_LONGLONG) {
+			bind.buffer = const_cast<uint64_t*>(&parameter.number);
+		} else if (parameter.type == MYSQL_TYPE_DOUBLE) {
+			bind.buffer = const_cast<double*>(&parameter.real);
+		} else if (parameter.type != MYSQL_TYPE_NULL) {
+			bind.buffer = const_cast<char*>(parameter.bytes.data());
+			bind.buffer_length = parameter.bytes.size();
+		}
+	}
+
+	while (true) {
+		MYSQL_STMT* handle;
+		auto it = connection.statements.find(query);
+		if (it != connection.statements.end()) {
+			handle = it->second;
+		} else {
+			handle = mysql_stmt_init(connection.handle);
+			if (!handle) {
+				SPDLOG_ERROR("Failed to initialize MySQL statement handle");
+				return nullptr;
+			}
+
+			bool updateMaxLength = true;
+			mysql_stmt_attr_set(handle, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+			if (mysql_stmt_prepare(handle, query.c_str(), query.length()) != 0) {
+				SPDLOG_ERROR("Query: {}", query.substr(0, 256));
+				SPDLOG_ERROR("Message: {}", mysql_stmt_error(handle));
+				auto error = mysql_stmt_errno(handle);
+				mysql_stmt_close(handle);
+				if (!isConnectionLost(error)) {
+					return nullptr;
+				}
+				std::this_thread::sleep_for(std::chrono::seconds(1));
+				continue;
+			}
+			connection.statements.emplace(query, handle);
+		}
+
+		if (mysql_stmt_param_count(handle) != binds.size()) {
+			SPDLOG_ERROR("Query: {}", query.substr(0, 256));
+			SPDLOG_ERROR("Message: {} values bound to {} placeholders", binds.size(), mysql_stmt_param_count(handle));
+			return nullptr;
+		}
+
+		if (mysql_stmt_bind_param(handle, binds.data()) == 0 && mysql_stmt_execute(handle) == 0) {
+			return handle;
+		}
+
+		SPDLOG_ERROR("Query: {}", query.substr(0, 256));
+		SPDLOG_ERROR("Message: {}", mysql_stmt_error(handle));
+		auto error = mysql_stmt_errno(handle);
+		if (!isConnectionLost(error) && error != 1243/*ER_UNKNOWN_STMT_HANDLER*/) {
+			return nullptr;
+		}
+
+		// Statements do not survive a reconnection, it is prepared again
+		closeStatement(connection, query);
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+}
+
+void Database::closeStatement(Connection &connection, const std::string& query)
+{
+	auto it = connection.statements.find(query);
+	if (it != connection.statements.end()) {
+		mysql_stmt_close(it->second);
+		connection.statements.erase(it);
+	}
+}
+
+uint64_t Database::getLastInsertId()
+{
+	Connection* connection = getConnection();
+	if (!connection) {
+		return 0;
+	}
+	return static_cast<uint64_t>(mysql_insert_id(connection->handle));
+}
+
 std::string Database::escapeString(const std::string& s) const
 {
 	return escapeBlob(s.c_str(), s.length());
@@ -208,7 +399,7 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const
 
 	if (length != 0) {
 		char* output = new char[maxLength];
-		mysql_real_escape_string(handle, output, s, length);
+		mysql_real_escape_string(connections.front()->handle, output, s, length);
 		escaped.append(output);
 		delete[] output;
 	}
@@ -221,53 +412,224 @@ DBResult::DBResult(MYSQL_RES* res)
 {
 	handle = res;
 
-	size_t i = 0;
-
 	MYSQL_FIELD* field = mysql_fetch_field(handle);
 	while (field) {
-		listNames[field->name] = i++;
+		addColumn(field->name);
 		field = mysql_fetch_field(handle);
 	}
 
-	row = mysql_fetch_row(handle);
+	next();
+}
+
+DBResult::DBResult(MYSQL_RES* res, MYSQL* connection, std::unique_lock<std::recursive_mutex> lock) :
+	DBResult(res)
+{
+	streamConnection = connection;
+	streamLock = std::move(lock);
+	if (!row && mysql_errno(streamConnection) != 0) {
+		SPDLOG_ERROR("Message: {}", mysql_error(streamConnection));
+	}
+}
+
+DBResult::DBResult(MYSQL_STMT* statement, MYSQL_RES* metadata)
+{
+	columnCount = mysql_num_fields(metadata);
+	MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+
+	using NullFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+	std::vector<MYSQL_BIND> binds(columnCount);
+	std::vector<Value> fetched(columnCount);
+	std::vector<unsigned long> lengths(columnCount);
+	auto nulls = std::make_unique<NullFlag[]>(columnCount);
+
+	std::vector<size_t> offsets(columnCount);
+	size_t bufferSize = 0;
+	for (size_t i = 0; i < columnCount; ++i) {
+		const MYSQL_FIELD &field = fields[i];
+		addColumn(field.name);
+
+		MYSQL_BIND &bind = binds[i];
+		bind.length = &lengths[i];
+		bind.is_null = &nulls[i];
+		switch (field.type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &fetched[i].number;
+				bind.is_unsigned = (field.flags & UNSIGNED_FLAG) != 0;
+				fetched[i].type = (field.flags & UNSIGNED_FLAG) != 0 ? VALUE_UNSIGNED : VALUE_SIGNED;
+				break;
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &fetched[i].real;
+				fetched[i].type = VALUE_DOUBLE;
+				break;
+
+			default:
+				// Strings and blobs, dates and decimals are converted to text
+				bind.buffer_type = MYSQL_TYPE_STRING;
+				bind.buffer_length = std::max<unsigned long>(field.max_length, 64);
+				offsets[i] = bufferSize;
+				bufferSize += bind.buffer_length;
+				fetched[i].type = VALUE_BYTES;
+				break;
+		}
+	}
+
+	std::vector<char> buffer(bufferSize);
+	for (size_t i = 0; i < columnCount; ++i) {
+		if (fetched[i].type == VALUE_BYTES) {
+			binds[i].buffer = buffer.data() + offsets[i];
+		}
+	}
+
+	if (mysql_stmt_bind_result(statement, binds.data()) != 0) {
+		SPDLOG_ERROR("Message: {}", mysql_stmt_error(statement));
+		return;
+	}
+
+	values.reserve(mysql_stmt_num_rows(statement) * columnCount);
+	int status;
+	while ((status = mysql_stmt_fetch(statement)) == 0 || status == MYSQL_DATA_TRUNCATED) {
+		for (size_t i = 0; i < columnCount; ++i) {
+			Value &value = values.emplace_back(fetched[i]);
+			if (nulls[i]) {
+				value.type = VALUE_NULL;
+				continue;
+			}
+
+			if (value.type != VALUE_BYTES) {
+				continue;
+			}
+
+			value.offset = static_cast<uint32_t>(bytes.size());
+			value.length = static_cast<uint32_t>(lengths[i]);
+			if (lengths[i] <= binds[i].buffer_length) {
+				bytes.append(buffer.data() + offsets[i], lengths[i]);
+			} else {
+				// Longer than the buffer, fetched again straight into bytes
+				bytes.resize(bytes.size() + lengths[i]);
+				MYSQL_BIND column {};
+				column.buffer_type = MYSQL_TYPE_STRING;
+				column.buffer = &bytes[value.offset];
+				column.buffer_length = lengths[i];
+				mysql_stmt_fetch_column(statement, &column, static_cast<unsigned int>(i), 0);
+			}
+			bytes.push_back('\0');
+		}
+	}
+
+	if (columnCount != 0) {
+		rowCount = values.size() / columnCount;
+	}
 }
 
 DBResult::~DBResult()
 {
-	mysql_free_result(handle);
+	if (handle) {
+		// A streamed result reads the rows left before the connection is released
+		mysql_free_result(handle);
+	}
 }
 
-std::string DBResult::getString(const std::string& s) const
+void DBResult::addColumn(const char* name)
+{
+	listNames.emplace(name, columnNames.size());
+	columnNames.emplace_back(name);
+}
+
+DBResult::Column DBResult::getColumn(const std::string& s) const
 {
 	auto it = listNames.find(s);
 	if (it == listNames.end()) {
-		SPDLOG_ERROR("Column '{}' does not exist in result set", s);
+		SPDLOG_ERROR("Column '{}' doesn't exist in the result set", s);
+		return {};
+	}
+	return { it->second };
+}
+
+bool DBResult::parseFailed(size_t column, std::from_chars_result result) const
+{
+	if (result.ec == std::errc::invalid_argument) {
+		SPDLOG_ERROR("Column '{}' has an invalid value set", columnNames[column]);
+		return true;
+	} else if (result.ec == std::errc::result_out_of_range) {
+		SPDLOG_ERROR("Column '{}' has a value out of range", columnNames[column]);
+		return true;
+	}
+	return false;
+}
+
+std::string DBResult::getString(const std::string& s) const
+{
+	return getString(getColumn(s));
+}
+
+std::string DBResult::getString(Column column) const
+{
+	if (column.index >= columnNames.size()) {
 		return std::string();
 	}
 
-	if (row[it->second] == nullptr) {
+	if (!handle) {
+		const Value &value = getValue(column.index);
+		switch (value.type) {
+			case VALUE_NULL:
+				return std::string();
+			case VALUE_SIGNED:
+				return std::to_string(static_cast<int64_t>(value.number));
+			case VALUE_UNSIGNED:
+				return std::to_string(value.number);
+			case VALUE_DOUBLE:
+				return std::to_string(value.real);
+			default:
+				return std::string(&bytes[value.offset], value.length);
+		}
+	}
+
+	if (row[column.index] == nullptr) {
 		return std::string();
 	}
 
-	return std::string(row[it->second]);
+	return std::string(row[column.index], lengths[column.index]);
 }
 
 const char* DBResult::getStream(const std::string& s, unsigned long& size) const
 {
-	auto it = listNames.find(s);
-	if (it == listNames.end()) {
-		SPDLOG_ERROR("Column '{}' doesn't exist in the result set", s);
+	return getStream(getColumn(s), size);
+}
+
+const char* DBResult::getStream(Column column, unsigned long& size) const
+{
+	if (column.index >= columnNames.size()) {
 		size = 0;
 		return nullptr;
 	}
 
-	if (row[it->second] == nullptr) {
+	if (!handle) {
+		const Value &value = getValue(column.index);
+		if (value.type != VALUE_BYTES) {
+			size = 0;
+			return nullptr;
+		}
+
+		size = value.length;
+		return &bytes[value.offset];
+	}
+
+	if (row[column.index] == nullptr) {
 		size = 0;
 		return nullptr;
 	}
 
-	size = mysql_fetch_lengths(handle)[it->second];
-	return row[it->second];
+	size = lengths[column.index];
+	return row[column.index];
 }
 
 uint8_t DBResult::getU8FromString(const std::string &string, const std::string &function) const
@@ -294,22 +656,83 @@ int8_t DBResult::getInt8FromString(const std::string &string, const std::string
 
 size_t DBResult::countResults() const
 {
+	if (!handle) {
+		return rowCount;
+	}
 	return static_cast<size_t>(mysql_num_rows(handle));
 }
 
 bool DBResult::hasNext() const
 {
+	if (!handle) {
+		return currentRow < rowCount;
+	}
 	return row != nullptr;
 }
 
 bool DBResult::next()
 {
-  if (!handle) {
-    SPDLOG_ERROR("Database not initialized!");
-    return false;
-  }
+	if (!handle) {
+		if (currentRow < rowCount) {
+			++currentRow;
+		}
+		return currentRow < rowCount;
+	}
+
 	row = mysql_fetch_row(handle);
-	return row != nullptr;
+	if (!row) {
+		lengths = nullptr;
+		if (streamConnection && mysql_errno(streamConnection) != 0) {
+			SPDLOG_ERROR("Message: {}", mysql_error(streamConnection));
+		}
+		return false;
+	}
+	lengths = mysql_fetch_lengths(handle);
+	return true;
+}
+
+DBStatement& DBStatement::bind(std::string value)
+{
+	Parameter &parameter = parameters.emplace_back();
+	parameter.type = MYSQL_TYPE_STRING;
+	parameter.bytes = std::move(value);
+	return *this;
+}
+
+DBStatement& DBStatement::bindBlob(const char* data, size_t length)
+{
+	Parameter &parameter = parameters.emplace_back();
+	parameter.type = MYSQL_TYPE_BLOB;
+	if (length != 0) {
+		parameter.bytes.assign(data, length);
+	}
+	return *this;
+}
+
+DBStatement& DBStatement::bindNull()
+{
+	parameters.emplace_back();
+	return *this;
+}
+
+bool DBBatch::execute() const
+{
+	if (queries.empty()) {
+		return true;
+	}
+
+	DBTransaction transaction;
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	Database& db = Database::getInstance();
+	for (const auto& query : queries) {
+		if (!std::visit([&db](const auto& value) { return db.executeQuery(value); }, query)) {
+			return false;
+		}
+	}
+	return transaction.commit();
 }
 
 DBInsert::DBInsert(std::string insertQuery) : query(std::move(insertQuery))
@@ -317,6 +740,11 @@ DBInsert::DBInsert(std::string insertQuery) : query(std::move(insertQuery))
 	this->length = this->query.length();
 }
 
+DBInsert::DBInsert(std::string insertQuery, DBBatch& insertBatch) : DBInsert(std::move(insertQuery))
+{
+	batch = &insertBatch;
+}
+
 bool DBInsert::addRow(const std::string& row)
 {
 	// adds new row to buffer
@@ -326,13 +754,12 @@ bool DBInsert::addRow(const std::string& row)
 		return false;
 	}
 
+	// Grows geometrically, reserving the exact size of each row copied the buffer every time
 	if (values.empty()) {
-		values.reserve(rowLength + 2);
 		values.push_back('(');
 		values.append(row);
 		values.push_back(')');
 	} else {
-		values.reserve(values.length() + rowLength + 3);
 		values.push_back(',');
 		values.push_back('(');
 		values.append(row);
@@ -355,7 +782,12 @@ bool DBInsert::execute()
 	}
 
 	// executes buffer
-	bool res = Database::getInstance().executeQuery(query + values);
+	bool res = true;
+	if (batch) {
+		batch->add(query + values);
+	} else {
+		res = Database::getInstance().executeQuery(query + values);
+	}
 	values.clear();
 	length = query.length();
 	return res;
@@ -14,6 +14,7 @@
 
 class DBResult;
 using DBResult_ptr = std::shared_ptr<DBResult>;
+class DBStatement;
 
 class Database
 {
@@ -35,19 +36,27 @@ class Database
 		bool connect();
 
 		bool connect(const char *host, const char *user, const char *password,
-                     const char *database, uint32_t port, const char *sock);
+                     const char *database, uint32_t port, const char *sock, uint32_t poolSize = 1);
 
 		bool executeQuery(const std::string& query);
+		bool executeQuery(const DBStatement& statement);
 
 		DBResult_ptr storeQuery(const std::string& query);
+		DBResult_ptr storeQuery(const DBStatement& statement);
+		/**
+		 * Reads the rows from the server while the result is walked instead
+		 * of buffering all of them first, for large result sets. The calling
+		 * thread's connection is busy until the result is destroyed, so no
+		 * other query may be run on this thread in the meantime.
+		 */
+		DBResult_ptr streamQuery(const std::string& query);
 
 		std::string escapeString(const std::string& s) const;
 
 		std::string escapeBlob(const char* s, uint32_t length) const;
 
-		uint64_t getLastInsertId() const {
-			return static_cast<uint64_t>(mysql_insert_id(handle));
-		}
+		// Id generated by the last insert of the calling thread
+		uint64_t getLastInsertId();
 
 		static const char* getClientVersion() {
 			return mysql_get_client_info();
@@ -58,13 +67,31 @@ class Database
 		}
 
 	private:
+		/**
+		 * Connection of the pool. Every thread sticks to the connection it got
+		 * on its first query, so with at least as many connections as threads
+		 * using the database none of them ever waits for another.
+		 */
+		struct Connection {
+			~Connection();
+
+			MYSQL* handle = nullptr;
+			std::recursive_mutex lock;
+			// Statements prepared on this connection, by query
+			phmap::flat_hash_map<std::string, MYSQL_STMT*> statements;
+		};
+
+		Connection* getConnection();
+		MYSQL_STMT* executeStatement(Connection &connection, const DBStatement& statement);
+		static void closeStatement(Connection &connection, const std::string& query);
+
 		bool beginTransaction();
 		bool rollback();
 		bool commit();
 
 	private:
-		MYSQL* handle = nullptr;
-		std::recursive_mutex databaseLock;
+		std::vector<std::unique_ptr<Connection>> connections;
+		std::atomic<uint32_t> nextConnection = 0;
 		uint64_t maxPacketSize = 1048576;
 
 	friend class DBTransaction;
@@ -73,6 +100,15 @@ class Database
 class DBResult
 {
 	public:
+	/**
+	 * Column resolved once from its name. Loops reading the same columns
+	 * from every row take these instead of the name, which skips the name
+	 * lookup on each read.
+	 */
+	struct Column {
+		size_t index = std::numeric_limits<size_t>::max();
+	};
+
 	explicit DBResult(MYSQL_RES *res);
 	~DBResult();
 
@@ -80,110 +116,232 @@ class DBResult
 	DBResult(const DBResult &) = delete;
 	DBResult &operator=(const DBResult &) = delete;
 
+	Column getColumn(const std::string &s) const;
+
 	template < typename T>
 	T getNumber(const std::string &s) const
 	{
-		auto it = listNames.find(s);
-		if (it == listNames.end())
-		{
-			SPDLOG_ERROR("[DBResult::getNumber] - Column '{}' doesn't exist in the result set", s);
-			return T();
-		}
+		return getNumber<T>(getColumn(s));
+	}
 
-		if (row[it->second] == nullptr)
+	template < typename T>
+	T getNumber(Column column) const
+	{
+		if (column.index >= columnNames.size())
 		{
 			return T();
 		}
 
-		T data = 0;
-		try
+		if (!handle)
 		{
-			// Check if the type T is signed or unsigned
-			if constexpr(std::is_signed_v<T>)
+			const Value &value = getValue(column.index);
+			switch (value.type)
 			{
-				// Check if the type T is int8_t or int16_t
-				if constexpr(std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t>)
-				{
-					// Use std::stoi to convert string to int8_t
-					data = static_cast<T>(std::stoi(row[it->second]));
-				}
-				// Check if the type T is int32_t
-				else if constexpr(std::is_same_v<T, int32_t>)
-				{
-					// Use std::stol to convert string to int32_t
-					data = static_cast<T>(std::stol(row[it->second]));
-				}
-				// Check if the type T is int64_t
-				else if constexpr(std::is_same_v<T, int64_t>)
-				{
-					// Use std::stoll to convert string to int64_t
-					data = static_cast<T>(std::stoll(row[it->second]));
-				}
-				else
-				{
-					// Throws exception indicating that type T is invalid
-					SPDLOG_ERROR("Invalid signed type T");
-				}
-			}
-			else if (std::is_same<T, bool>::value)
-			{
-				data = static_cast<T>(std::stoi(row[it->second]));
-			}
-			else
-			{
-				// Check if the type T is uint8_t or uint16_t or uint32_t
-				if constexpr(std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t>)
-				{
-					// Use std::stoul to convert string to uint8_t
-					data = static_cast<T>(std::stoul(row[it->second]));
-				}
-				// Check if the type T is uint64_t
-				else if constexpr(std::is_same_v<T, uint64_t>)
-				{
-					// Use std::stoull to convert string to uint64_t
-					data = static_cast<T>(std::stoull(row[it->second]));
-				}
-				else
-				{
-					// Send log indicating that type T is invalid
-					SPDLOG_ERROR("Column '{}' has an invalid unsigned T is invalid", s);
-				}
+				case VALUE_NULL:
+					return T();
+				case VALUE_SIGNED:
+					return static_cast<T>(static_cast<int64_t>(value.number));
+				case VALUE_UNSIGNED:
+					return static_cast<T>(value.number);
+				case VALUE_DOUBLE:
+					return static_cast<T>(value.real);
+				default:
+					return parseNumber<T>(column.index, &bytes[value.offset], value.length);
 			}
 		}
-		catch (std::invalid_argument &e)
-		{
-			// Value of string is invalid
-			SPDLOG_ERROR("Column '{}' has an invalid value set, error code: {}", s, e.what());
-			data = T();
-		}
-		catch (std::out_of_range &e)
+
+		if (row[column.index] == nullptr)
 		{
-			// Value of string is too large to fit the range allowed by type T
-			SPDLOG_ERROR("Column '{}' has a value out of range, error code: {}", s, e.what());
-			data = T();
+			return T();
 		}
 
-		return data;
+		return parseNumber<T>(column.index, row[column.index], lengths[column.index]);
 	}
 
 	std::string getString(const std::string &s) const;
+	std::string getString(Column column) const;
 	const char *getStream(const std::string &s, unsigned long &size) const;
+	const char *getStream(Column column, unsigned long &size) const;
 	uint8_t getU8FromString(const std::string &string, const std::string &function) const;
 	int8_t getInt8FromString(const std::string &string, const std::string &function) const;
 
+	// Rows read so far for a streamed result
 	size_t countResults() const;
 	bool hasNext() const;
 	bool next();
 
 	private:
-	MYSQL_RES * handle;
-	MYSQL_ROW row;
+	enum ValueType : uint8_t {
+		VALUE_NULL,
+		VALUE_SIGNED,
+		VALUE_UNSIGNED,
+		VALUE_DOUBLE,
+		VALUE_BYTES,
+	};
+
+	// Column of a prepared statement row, bytes are kept null terminated in bytes
+	struct Value {
+		uint64_t number = 0;
+		double real = 0;
+		uint32_t offset = 0;
+		uint32_t length = 0;
+		ValueType type = VALUE_NULL;
+	};
+
+	// Fetches every row of an executed statement, the statement can be reused right after
+	DBResult(MYSQL_STMT* statement, MYSQL_RES* metadata);
+	// Reads the rows one by one from the connection, which stays locked until the result is gone
+	DBResult(MYSQL_RES* res, MYSQL* connection, std::unique_lock<std::recursive_mutex> lock);
+
+	const Value &getValue(size_t column) const {
+		return values[currentRow * columnCount + column];
+	}
+
+	void addColumn(const char* name);
+
+	template < typename T>
+	T parseNumber(size_t column, const char* value, size_t length) const
+	{
+		const char* end = value + length;
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			double data = 0;
+			if (parseFailed(column, std::from_chars(value, end, data)))
+			{
+				return T();
+			}
+			return static_cast<T>(data);
+		}
+		// Wider values wrap around like the std::stoul parsing used to
+		else if (std::is_signed_v<T> || (value != end && *value == '-'))
+		{
+			int64_t data = 0;
+			if (parseFailed(column, std::from_chars(value, end, data)))
+			{
+				return T();
+			}
+			return static_cast<T>(data);
+		}
+		else
+		{
+			uint64_t data = 0;
+			if (parseFailed(column, std::from_chars(value, end, data)))
+			{
+				return T();
+			}
+			return static_cast<T>(data);
+		}
+	}
+
+	bool parseFailed(size_t column, std::from_chars_result result) const;
+
+	// Text protocol rows, null for a prepared statement result
+	MYSQL_RES * handle = nullptr;
+	MYSQL_ROW row = nullptr;
+	unsigned long* lengths = nullptr;
+
+	// Set for a streamed result, whose connection is held until it is destroyed
+	MYSQL* streamConnection = nullptr;
+	std::unique_lock<std::recursive_mutex> streamLock;
+
+	// Binary protocol rows
+	std::vector<Value> values;
+	std::string bytes;
+	size_t columnCount = 0;
+	size_t rowCount = 0;
+	size_t currentRow = 0;
+
+	std::vector<std::string> columnNames;
+	phmap::flat_hash_map<std::string, size_t> listNames;
+
+	friend class Database;
+};
+
+/**
+ * Prepared statement: a query with ? placeholders and the values bound to
+ * them in order. Each connection prepares a query the first time it runs
+ * it, the values then travel in the binary protocol so they are neither
+ * formatted nor escaped, and MariaDB does not parse the query again.
+ */
+class DBStatement
+{
+	public:
+		explicit DBStatement(std::string initQuery) : query(std::move(initQuery)) {}
+
+		// Adds text to the query, for statements whose columns vary
+		DBStatement& append(std::string_view text) {
+			query.append(text);
+			return *this;
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_enum<T>::value, DBStatement&>::type
+		bind(T value) {
+			return bind(static_cast<std::underlying_type_t<T>>(value));
+		}
+
+		template <typename T>
+		typename std::enable_if<std::is_arithmetic<T>::value, DBStatement&>::type
+		bind(T value) {
+			Parameter &parameter = parameters.emplace_back();
+			if constexpr (std::is_floating_point_v<T>) {
+				parameter.type = MYSQL_TYPE_DOUBLE;
+				parameter.real = value;
+			} else {
+				parameter.type = MYSQL_TYPE_LONGLONG;
+				parameter.isUnsigned = std::is_unsigned_v<T>;
+				parameter.number = static_cast<uint64_t>(value);
+			}
+			return *this;
+		}
+
+		DBStatement& bind(std::string value);
+		DBStatement& bindBlob(const char* data, size_t length);
+		DBStatement& bindNull();
+
+		const std::string& getQuery() const {
+			return query;
+		}
+
+	private:
+		struct Parameter {
+			enum_field_types type = MYSQL_TYPE_NULL;
+			bool isUnsigned = false;
+			uint64_t number = 0;
+			double real = 0;
+			std::string bytes;
+		};
 
-	std::map<std::string, size_t> listNames;
+		std::string query;
+		std::vector<Parameter> parameters;
 
 	friend class Database;
 };
 
+/**
+ * Queries kept to be run later, in order and as one transaction, e.g. by
+ * another thread than the one that built them.
+ */
+class DBBatch
+{
+	public:
+		void add(std::string query) {
+			queries.emplace_back(std::move(query));
+		}
+		void add(DBStatement statement) {
+			queries.emplace_back(std::move(statement));
+		}
+
+		bool empty() const {
+			return queries.empty();
+		}
+
+		bool execute() const;
+
+	private:
+		std::vector<std::variant<std::string, DBStatement>> queries;
+};
+
 /**
  * INSERT statement.
  */
@@ -191,6 +349,8 @@ class DBInsert
 {
 	public:
 		explicit DBInsert(std::string query);
+		// The rows are added to the batch instead of being run
+		DBInsert(std::string query, DBBatch& batch);
 		bool addRow(const std::string& row);
 		bool addRow(std::ostringstream& row);
 		bool execute();
@@ -199,6 +359,7 @@ class DBInsert
 		std::string query;
 		std::string values;
 		size_t length;
+		DBBatch* batch = nullptr;
 };
 
 class DBTransaction
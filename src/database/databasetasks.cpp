@@ -11,6 +11,7 @@
 
 #include "database/databasetasks.h"
 #include "game/scheduling/tasks.h"
+#include "config/configmanager.h"
 
 DatabaseTasks::DatabaseTasks() {
   db_ = &Database::getInstance();
@@ -31,49 +32,145 @@ void DatabaseTasks::start()
     return;
   }
 	db_->connect();
-	ThreadHolder::start();
+	startThread();
 }
 
 void DatabaseTasks::startThread()
 {
+	batchDelay = std::chrono::milliseconds(std::max<int32_t>(0, g_configManager().getNumber(DATABASE_BATCH_DELAY)));
 	ThreadHolder::start();
 }
 
 void DatabaseTasks::threadMain()
 {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (true) {
+		if (tasks.empty() && batches.empty()) {
+			if (getState() == THREAD_STATE_TERMINATED) {
+				break;
+			}
+
 			if (flushTasks) {
-				flushSignal.notify_one();
+				flushTasks = false;
+				flushSignal.notify_all();
 			}
-			taskSignal.wait(taskLockUnique, [this] {
-				return tasks.empty();
-			});
+			taskSignal.wait(taskLockUnique);
+			continue;
 		}
 
+		std::vector<DatabaseBatch> writes;
+		std::optional<DatabaseTask> task;
 		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
+			task.emplace(std::move(tasks.front()));
 			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
+			writes = std::move(task->batches);
 		} else {
-			taskLockUnique.unlock();
+			// Rows wait for more of their kind within the batch delay
+			if (!batchFull && !flushTasks && getState() == THREAD_STATE_RUNNING) {
+				auto oldest = std::chrono::steady_clock::time_point::max();
+				for (const auto& it : batches) {
+					oldest = std::min(oldest, it.second.queued);
+				}
+
+				if (std::chrono::steady_clock::now() < oldest + batchDelay) {
+					taskSignal.wait_until(taskLockUnique, oldest + batchDelay);
+					continue;
+				}
+			}
+
+			writes.reserve(batches.size());
+			for (auto& it : batches) {
+				writes.push_back(std::move(it.second));
+			}
+			batches.clear();
+			batchFull = false;
+		}
+
+		for (const DatabaseBatch& batch : writes) {
+			queuedRows -= batch.rows.size();
+		}
+
+		working = true;
+		taskLockUnique.unlock();
+		spaceSignal.notify_all();
+
+		for (const DatabaseBatch& batch : writes) {
+			writeBatch(batch);
+		}
+		if (task) {
+			runTask(*task);
 		}
+
+		taskLockUnique.lock();
+		working = false;
+	}
+
+	if (flushTasks) {
+		flushTasks = false;
+		flushSignal.notify_all();
 	}
 }
 
+bool DatabaseTasks::waitForSpace(std::unique_lock<std::mutex>& lock)
+{
+	if (tasks.size() + queuedRows >= MAX_QUEUED) {
+		// No point in waiting for more rows
+		batchFull = true;
+		taskSignal.notify_one();
+	}
+
+	spaceSignal.wait(lock, [this] {
+		return tasks.size() + queuedRows < MAX_QUEUED || getState() != THREAD_STATE_RUNNING;
+	});
+	return getState() == THREAD_STATE_RUNNING;
+}
+
 void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/)
 {
-	bool signal = false;
-	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
+	std::unique_lock<std::mutex> lock(taskLock);
+	if (!waitForSpace(lock)) {
+		return;
+	}
+
+	DatabaseTask& task = tasks.emplace_back(std::move(query), std::move(callback), store);
+	// The query may depend on the rows queued so far, it takes them along
+	if (!batches.empty()) {
+		task.batches.reserve(batches.size());
+		for (auto& it : batches) {
+			task.batches.push_back(std::move(it.second));
+		}
+		batches.clear();
+		batchFull = false;
+	}
+	lock.unlock();
+	taskSignal.notify_one();
+}
+
+void DatabaseTasks::addRow(const std::string& head, std::string row, const std::string& suffix/* = std::string()*/)
+{
+	std::unique_lock<std::mutex> lock(taskLock);
+	if (!waitForSpace(lock)) {
+		return;
 	}
-	taskLock.unlock();
 
+	DatabaseBatch& batch = batches[head + suffix];
+	if (batch.rows.empty()) {
+		batch.head = head;
+		batch.suffix = suffix;
+		batch.queued = std::chrono::steady_clock::now();
+	}
+
+	batch.length += row.length() + 3;
+	batch.rows.push_back(std::move(row));
+	++queuedRows;
+
+	bool signal = batches.size() == 1 && batch.rows.size() == 1;
+	if (batch.length + batch.head.length() + batch.suffix.length() > db_->getMaxPacketSize() && !batchFull) {
+		batchFull = true;
+		signal = true;
+	}
+
+	lock.unlock();
 	if (signal) {
 		taskSignal.notify_one();
 	}
@@ -94,21 +191,100 @@ void DatabaseTasks::runTask(const DatabaseTask& task)
 		success = db_->executeQuery(task.query);
 	}
 
+	{
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		++taskCount;
+		addLatency(task.queued);
+	}
+
 	if (task.callback) {
 		g_dispatcher().addTask(createTask(std::bind(task.callback, result, success)));
 	}
 }
 
+void DatabaseTasks::writeBatch(const DatabaseBatch& batch)
+{
+  if (db_ == nullptr) {
+    return;
+  }
+
+	const size_t maxLength = db_->getMaxPacketSize();
+	const size_t fixedLength = batch.head.length() + batch.suffix.length() + 1;
+
+	uint64_t statements = 0;
+	std::string query;
+	auto rowIt = batch.rows.begin();
+	while (rowIt != batch.rows.end()) {
+		query.reserve(std::min(maxLength, fixedLength + batch.length));
+		query = batch.head;
+		bool first = true;
+		// A row too long for the packet on its own still goes, alone, and is reported by the server
+		while (rowIt != batch.rows.end() && (first || query.length() + rowIt->length() + 3 + batch.suffix.length() < maxLength)) {
+			if (!first) {
+				query.push_back(',');
+			}
+			query.push_back('(');
+			query.append(*rowIt);
+			query.push_back(')');
+			first = false;
+			++rowIt;
+		}
+
+		if (!batch.suffix.empty()) {
+			query.push_back(' ');
+			query.append(batch.suffix);
+		}
+
+		db_->executeQuery(query);
+		++statements;
+	}
+
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	rowCount += batch.rows.size();
+	statementCount += statements;
+	addLatency(batch.queued);
+}
+
+void DatabaseTasks::addLatency(std::chrono::steady_clock::time_point queued)
+{
+	const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued);
+	latencies[latencySamples++ % LATENCY_SAMPLES] = static_cast<uint32_t>(std::min<int64_t>(latency.count(), std::numeric_limits<uint32_t>::max()));
+}
+
+DatabaseTaskStats DatabaseTasks::getStats()
+{
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	DatabaseTaskStats stats;
+	stats.tasks = taskCount;
+	stats.rows = rowCount;
+	stats.statements = statementCount;
+	stats.queued = tasks.size() + queuedRows;
+
+	size_t count = std::min<uint64_t>(latencySamples, LATENCY_SAMPLES);
+	if (count == 0) {
+		return stats;
+	}
+
+	std::vector<uint32_t> times(latencies.begin(), latencies.begin() + count);
+	std::sort(times.begin(), times.end());
+	stats.p50 = times[(count - 1) * 50 / 100];
+	stats.p99 = times[(count - 1) * 99 / 100];
+	stats.max = times.back();
+	return stats;
+}
+
 void DatabaseTasks::flush()
 {
 	std::unique_lock<std::mutex> guard{ taskLock };
-	if (!tasks.empty()) {
-		flushTasks = true;
-		flushSignal.wait(guard, [this] {
-			return !flushTasks;
-		});
-		flushTasks = false;
+	if (tasks.empty() && batches.empty() && !working) {
+		return;
 	}
+
+	flushTasks = true;
+	taskSignal.notify_one();
+	flushSignal.wait(guard, [this] {
+		return !flushTasks;
+	});
 }
 
 void DatabaseTasks::shutdown()
@@ -116,6 +292,6 @@ void DatabaseTasks::shutdown()
 	taskLock.lock();
 	setState(THREAD_STATE_TERMINATED);
 	taskLock.unlock();
-	flush();
 	taskSignal.notify_one();
+	spaceSignal.notify_all();
 }
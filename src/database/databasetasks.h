@@ -13,6 +13,15 @@
 #include "database/database.h"
 #include "utils/thread_holder_base.h"
 
+// Rows queued for the same multi-row statement
+struct DatabaseBatch {
+	std::string head;
+	std::string suffix;
+	std::vector<std::string> rows;
+	size_t length = 0;
+	std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+};
+
 struct DatabaseTask {
 	DatabaseTask(std::string&& initQuery, std::function<void(DBResult_ptr, bool)>&& initCallback, bool initStore) :
 		query(std::move(initQuery)), callback(std::move(initCallback)), store(initStore) {}
@@ -20,11 +29,29 @@ struct DatabaseTask {
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
 	bool store;
+	std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+	// Rows queued before the query, written ahead of it
+	std::vector<DatabaseBatch> batches;
+};
+
+// Latencies in microseconds from queueing to written, over the last LATENCY_SAMPLES tasks and batches
+struct DatabaseTaskStats {
+	uint64_t tasks = 0;
+	uint64_t rows = 0;
+	uint64_t statements = 0;
+	uint64_t queued = 0;
+	uint64_t p50 = 0;
+	uint64_t p99 = 0;
+	uint64_t max = 0;
 };
 
 class DatabaseTasks : public ThreadHolder<DatabaseTasks>
 {
 	public:
+		static constexpr size_t LATENCY_SAMPLES = 1024;
+		// Queued tasks and rows, beyond it adding waits for the thread to catch up
+		static constexpr size_t MAX_QUEUED = 65536;
+
 		DatabaseTasks();
 
 		// non-copyable
@@ -45,18 +72,44 @@ class DatabaseTasks : public ThreadHolder<DatabaseTasks>
 		void shutdown();
 
 		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		/**
+		 * Queues one row of head + "(row)" + suffix, as in DBInsert. Rows with
+		 * the same head and suffix queued within databaseBatchDelay are
+		 * written as one multi-row statement, split at the max packet size.
+		 * A suffix such as ON DUPLICATE KEY UPDATE turns them into upserts.
+		 * Queries of addTask run after the rows queued before them.
+		 */
+		void addRow(const std::string& head, std::string row, const std::string& suffix = std::string());
+
+		DatabaseTaskStats getStats();
 
 		void threadMain();
 	private:
+		bool waitForSpace(std::unique_lock<std::mutex>& lock);
 		void runTask(const DatabaseTask& task);
+		void writeBatch(const DatabaseBatch& batch);
+		void addLatency(std::chrono::steady_clock::time_point queued);
 
 		Database *db_;
-		std::thread thread;
 		std::list<DatabaseTask> tasks;
+		// By head and suffix
+		phmap::flat_hash_map<std::string, DatabaseBatch> batches;
+		size_t queuedRows = 0;
+		bool batchFull = false;
+		bool working = false;
+		bool flushTasks = false;
+		std::chrono::milliseconds batchDelay{0};
+
 		std::mutex taskLock;
 		std::condition_variable taskSignal;
 		std::condition_variable flushSignal;
-		bool flushTasks = false;
+		std::condition_variable spaceSignal;
+
+		std::array<uint32_t, LATENCY_SAMPLES> latencies {};
+		uint64_t latencySamples = 0;
+		uint64_t taskCount = 0;
+		uint64_t rowCount = 0;
+		uint64_t statementCount = 0;
 };
 
 constexpr auto g_databaseTasks = &DatabaseTasks::getInstance;
@@ -19,7 +19,10 @@
 #include "game/functions/game_reload.hpp"
 #include "lua/global/globalevent.h"
 #include "io/iologindata.h"
+#include "io/iomapserialize.h"
 #include "io/iomarket.h"
+#include "io/playerloader.h"
+#include "io/savewriter.h"
 #include "items/items.h"
 #include "lua/scripts/lua_environment.hpp"
 #include "creatures/monsters/monster.h"
@@ -258,52 +261,93 @@ void Game::saveGameState()
 	}
 
 	SPDLOG_INFO("Saving server...");
+	const auto start = std::chrono::steady_clock::now();
 
-	for (const auto& it : players) {
-		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
-	}
+	// When shutting down nothing may be left to write
+	if (g_configManager().getBoolean(SERVER_SAVE_IN_BACKGROUND) && gameState != GAME_STATE_SHUTDOWN) {
+		for (const auto& it : players) {
+			it.second->loginPosition = it.second->getPosition();
+			IOLoginData::savePlayerAsync(it.second);
+		}
 
-	for (const auto& it : guilds) {
-		IOGuild::saveGuild(it.second);
-	}
+		auto guildSave = std::make_shared<DBBatch>();
+		for (const auto& it : guilds) {
+			IOGuild::saveGuild(it.second, *guildSave);
+		}
+
+		auto houseInfoSave = std::make_shared<DBBatch>();
+		auto houseItemsSave = std::make_shared<DBBatch>();
+		IOMapSerialize::saveHouseInfo(*houseInfoSave);
+		std::vector<uint32_t> houseIds = IOMapSerialize::saveHouseItems(*houseItemsSave);
+
+		const auto pause = std::chrono::steady_clock::now() - start;
+		// Queued after the players, so once it ran everything is written
+		g_saveWriter().addTask([guildSave, houseInfoSave, houseItemsSave, houseIds = std::move(houseIds), start, pause]() {
+			if (!guildSave->execute()) {
+				SPDLOG_ERROR("[Game::saveGameState] - Failed to save guilds");
+			}
+			if (!houseInfoSave->execute() || !houseItemsSave->execute()) {
+				SPDLOG_ERROR("[Game::saveGameState] - Failed to save houses");
+				// Written again by the next save
+				g_dispatcher().addTask(createTask([houseIds]() {
+					IOMapSerialize::setHousesDirty(houseIds);
+				}));
+			}
+
+			const auto duration = std::chrono::steady_clock::now() - start;
+			g_dispatcher().addTask(createTask([pause, duration]() {
+				g_game().onServerSaved(pause, duration);
+			}));
+		});
+	} else {
+		// A background save still queued would overwrite these rows with older data
+		g_saveWriter().flush();
+
+		for (const auto& it : players) {
+			it.second->loginPosition = it.second->getPosition();
+			IOLoginData::savePlayer(it.second);
+		}
+
+		for (const auto& it : guilds) {
+			IOGuild::saveGuild(it.second);
+		}
+
+		Map::save();
 
-	Map::save();
+		g_databaseTasks().flush();
 
-	g_databaseTasks().flush();
+		const auto duration = std::chrono::steady_clock::now() - start;
+		onServerSaved(duration, duration);
+	}
 
 	if (gameState == GAME_STATE_MAINTAIN) {
 		setGameState(GAME_STATE_NORMAL);
 	}
 }
 
+void Game::onServerSaved(std::chrono::steady_clock::duration pause, std::chrono::steady_clock::duration duration)
+{
+	serverSaveStats.saves++;
+	serverSaveStats.pause = std::chrono::duration_cast<std::chrono::microseconds>(pause).count();
+	serverSaveStats.duration = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	SPDLOG_INFO("Saved server in {} seconds, the game paused for {} seconds", serverSaveStats.duration / 1000000., serverSaveStats.pause / 1000000.);
+}
+
 bool Game::loadItemsPrice()
 {
 	itemsSaleCount = 0;
-	std::ostringstream query, marketQuery;
-	query << "SELECT DISTINCT `itemtype` FROM `market_offers`;";
+	itemsPriceMap.clear();
 
-	Database& db = Database::getInstance();
-	DBResult_ptr result = db.storeQuery(query.str());
-	if (!result) {
-		return false;
-	}
-
-	do {
-		marketQuery.str(std::string());
-		uint16_t itemId = result->getNumber<uint16_t>("itemtype");
-		marketQuery << "SELECT `price`, `tier` FROM `market_offers` WHERE `itemtype` = " << itemId << " ORDER BY `price` DESC LIMIT 1";
-		DBResult_ptr marketOffersResult = db.storeQuery(marketQuery.str());
-		if (marketOffersResult) {
-			std::map<uint8_t, uint64_t> tierAndCount;
-			auto tier = marketOffersResult->getNumber<uint8_t>("tier");
-			auto price = marketOffersResult->getNumber<uint64_t>("price");
-			tierAndCount[tier] = price;
-			itemsPriceMap[itemId] = tierAndCount;
+	// Highest offer of each item, from the market order book
+	for (const auto &[offerId, offer] : IOMarket::getInstance().getOffers()) {
+		auto it = itemsPriceMap.find(offer.itemId);
+		if (it == itemsPriceMap.end()) {
+			itemsPriceMap[offer.itemId] = { { offer.tier, offer.price } };
 			itemsSaleCount++;
+		} else if (it->second.begin()->second < offer.price) {
+			it->second = { { offer.tier, offer.price } };
 		}
-	} while (result->next());
-
+	}
 
 	return true;
 }
@@ -688,7 +732,7 @@ bool Game::placeCreature(Creature* creature, const Position& pos, bool extendedP
 		return false;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true);
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
@@ -717,7 +761,7 @@ bool Game::removeCreature(Creature* creature, bool isLogout/* = true*/)
 
 	std::vector<int32_t> oldStackPosVector;
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, tile->getPosition(), true);
 	for (Creature* spectator : spectators) {
 		if (Player* player = spectator->getPlayer()) {
@@ -2737,7 +2781,7 @@ void Game::playerCloseNpcChannel(uint32_t playerId)
 		return;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, player->getPosition());
 	for (Creature* spectator : spectators) {
 		if (Npc* npc = spectator->getNpc()) {
@@ -3358,7 +3402,7 @@ void Game::playerSetShowOffSocket(uint32_t playerId, Outfit_t& outfit, const Pos
 	item->setCustomAttribute("PodiumVisible", static_cast<int64_t>(podiumVisible));
 	item->setCustomAttribute("LookDirection", static_cast<int64_t>(direction));
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	g_game().map.getSpectators(spectators, pos, true);
 
 	// send to client
@@ -3524,6 +3568,8 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, const std::
 		writeItem->removeAttribute(ItemAttribute_t::WRITER);
 		writeItem->removeAttribute(ItemAttribute_t::DATE);
 	}
+	writeItem->markHouseDirty();
+	writeItem->markTileChanged();
 
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
@@ -5094,7 +5140,7 @@ bool Game::playerSaySpell(Player* player, SpeakClasses type, const std::string&
 
 void Game::playerWhisper(Player* player, const std::string& text)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, player->getPosition(), false, false,
                  Map::maxClientViewportX, Map::maxClientViewportX,
                  Map::maxClientViewportY, Map::maxClientViewportY);
@@ -5178,7 +5224,7 @@ void Game::playerSpeakToNpc(Player* player, const std::string& text)
 		return;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, player->getPosition());
 	for (Creature* spectator : spectators) {
 		if (spectator->getNpc()) {
@@ -5213,7 +5259,7 @@ bool Game::internalCreatureTurn(Creature* creature, Direction dir)
 	creature->setDirection(dir);
 
 	// Send to client
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		Player* tmpPlayer = spectator->getPlayer();
@@ -5226,7 +5272,7 @@ bool Game::internalCreatureTurn(Creature* creature, Direction dir)
 }
 
 bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std::string& text,
-                               bool ghostMode, SpectatorHashSet* spectatorsPtr/* = nullptr*/, const Position* pos/* = nullptr*/)
+                               bool ghostMode, SpectatorVec* spectatorsPtr/* = nullptr*/, const Position* pos/* = nullptr*/)
 {
 	if (text.empty()) {
 		return false;
@@ -5236,10 +5282,10 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std:
 		pos = &creature->getPosition();
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 
 	if (!spectatorsPtr || spectatorsPtr->empty()) {
-		// This somewhat complex construct ensures that the cached SpectatorHashSet
+		// This somewhat complex construct ensures that the cached SpectatorVec
 		// is used if available and if it can be used, else a local vector is
 		// used (hopefully the compiler will optimize away the construction of
 		// the temporary when it's not used).
@@ -5309,6 +5355,11 @@ void Game::addCreatureCheck(Creature* creature)
 		return;
 	}
 
+	if (creature->sleeping) {
+		wakeCreature(creature);
+		return;
+	}
+
 	creature->inCheckCreaturesVector = true;
 	checkCreatureLists[uniform_random(0, EVENT_CREATURECOUNT - 1)].push_back(creature);
 	creature->incrementReferenceCounter();
@@ -5316,21 +5367,80 @@ void Game::addCreatureCheck(Creature* creature)
 
 void Game::removeCreatureCheck(Creature* creature)
 {
+	if (creature->sleeping) {
+		// Released by the next pass of its check list
+		g_game().wakeCreature(creature);
+	}
+
 	if (creature->inCheckCreaturesVector) {
 		creature->creatureCheck = false;
 	}
 }
 
+void Game::wakeCreatures(const Position& pos)
+{
+	if (activityStats.sleepingCreatures == 0) {
+		return;
+	}
+
+	map.getSpectatorGrid().takeSleepers(wokenCreatures, pos);
+	for (Creature* creature : wokenCreatures) {
+		resumeCreatureCheck(creature);
+	}
+	wokenCreatures.clear();
+}
+
+void Game::wakeCreature(Creature* creature)
+{
+	map.getSpectatorGrid().removeSleeper(creature, creature->getPosition());
+	resumeCreatureCheck(creature);
+}
+
+void Game::resumeCreatureCheck(Creature* creature)
+{
+	// Still holds the reference taken when it was first added
+	creature->sleeping = false;
+	creature->inCheckCreaturesVector = true;
+	checkCreatureLists[uniform_random(0, EVENT_CREATURECOUNT - 1)].push_back(creature);
+
+	activityStats.sleepingCreatures--;
+	activityStats.wokenCreatures++;
+}
+
+CreatureActivityStats Game::getCreatureActivityStats() const
+{
+	CreatureActivityStats stats = activityStats;
+	for (const auto &checkCreatureList : checkCreatureLists) {
+		stats.activeCreatures += checkCreatureList.size();
+	}
+	return stats;
+}
+
 void Game::checkCreatures(size_t index)
 {
 	g_scheduler().addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL, std::bind(&Game::checkCreatures, this, (index + 1) % EVENT_CREATURECOUNT)));
 
+	const auto start = std::chrono::steady_clock::now();
+	SpectatorGrid &spectatorGrid = map.getSpectatorGrid();
 	auto& checkCreatureList = checkCreatureLists[index];
 	size_t it = 0, end = checkCreatureList.size();
 	while (it < end) {
 		Creature* creature = checkCreatureList[it];
 		if (creature && creature->creatureCheck) {
 			if (creature->getHealth() > 0) {
+				if (creature->canSleep() && !spectatorGrid.hasPlayersNear(creature->getPosition())) {
+					// Keeps its reference until a player wakes it
+					creature->inCheckCreaturesVector = false;
+					creature->sleeping = true;
+					spectatorGrid.addSleeper(creature, creature->getPosition());
+					activityStats.sleepingCreatures++;
+
+					checkCreatureList[it] = checkCreatureList.back();
+					checkCreatureList.pop_back();
+					--end;
+					continue;
+				}
+
 				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
 				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
 				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
@@ -5347,6 +5457,9 @@ void Game::checkCreatures(size_t index)
 			--end;
 		}
 	}
+
+	activityStats.lastThink = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	activityStats.maxThink = std::max(activityStats.maxThink, activityStats.lastThink);
 	cleanup();
 }
 
@@ -5358,7 +5471,7 @@ void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
 	creature->setSpeed(varSpeed);
 
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), false, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendChangeSpeed(creature, creature->getStepSpeed());
@@ -5373,7 +5486,7 @@ void Game::changePlayerSpeed(Player& player, int32_t varSpeedDelta)
 	player.setSpeed(varSpeed);
 
 	// Send new player speed to the spectators
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, player.getPosition(), false, true);
 	for (Creature* creatureSpectator : spectators) {
 		if (creatureSpectator == nullptr) {
@@ -5404,7 +5517,7 @@ void Game::internalCreatureChangeOutfit(Creature* creature, const Outfit_t& outf
 	}
 
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureChangeOutfit(creature, outfit);
@@ -5414,7 +5527,7 @@ void Game::internalCreatureChangeOutfit(Creature* creature, const Outfit_t& outf
 void Game::internalCreatureChangeVisible(Creature* creature, bool visible)
 {
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureChangeVisible(creature, visible);
@@ -5424,7 +5537,7 @@ void Game::internalCreatureChangeVisible(Creature* creature, bool visible)
 void Game::changeLight(const Creature* creature)
 {
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureLight(creature);
@@ -5434,7 +5547,7 @@ void Game::changeLight(const Creature* creature)
 void Game::updateCreatureIcon(const Creature* creature)
 {
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureIcon(creature);
@@ -5443,7 +5556,7 @@ void Game::updateCreatureIcon(const Creature* creature)
 
 void Game::reloadCreature(const Creature* creature)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), false, true);
 	for (Creature* spectator : spectators) {
 		Player* tmpPlayer = spectator->getPlayer();
@@ -5758,7 +5871,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			message.primary.value = realHealthChange;
 			message.primary.color = TEXTCOLOR_PASTELRED;
 
-			SpectatorHashSet spectators;
+			SpectatorVec spectators;
 			map.getSpectators(spectators, targetPos, false, true);
 			for (Creature* spectator : spectators) {
 				Player* tmpPlayer = spectator->getPlayer();
@@ -5863,7 +5976,7 @@ bool Game::combatChangeHealth(Creature* attacker, Creature* target, CombatDamage
 			return true;
 		}
 
-		SpectatorHashSet spectators;
+		SpectatorVec spectators;
 		map.getSpectators(spectators, targetPos, true, true);
 
 		if (damage.fatal) {
@@ -6085,7 +6198,7 @@ void Game::updatePlayerPartyHuntAnalyzer(const CombatDamage &damage, const Playe
 void Game::sendDamageMessageAndEffects(
 	const Creature *attacker, Creature *target, const CombatDamage &damage,
 	const Position &targetPos, Player *attackerPlayer, Player *targetPlayer,
-	TextMessage &message, const SpectatorHashSet &spectators, int32_t realDamage
+	TextMessage &message, const SpectatorVec &spectators, int32_t realDamage
 )
 {
 	message.primary.value = damage.primary.value;
@@ -6107,7 +6220,7 @@ bool Game::shouldSendMessage(const TextMessage &message) const
 void Game::sendMessages(
 	const Creature *attacker, const Creature *target, const CombatDamage &damage,
 	const Position &targetPos, Player *attackerPlayer, Player *targetPlayer,
-	TextMessage &message, const SpectatorHashSet &spectators, int32_t realDamage
+	TextMessage &message, const SpectatorVec &spectators, int32_t realDamage
 ) const
 {
 	if (attackerPlayer) {
@@ -6227,7 +6340,7 @@ void Game::buildMessageAsAttacker(
 
 void Game::sendEffects(
 	Creature *target, const CombatDamage &damage, const Position &targetPos, TextMessage &message,
-	const SpectatorHashSet &spectators
+	const SpectatorVec &spectators
 )
 {
 	uint8_t hitEffect;
@@ -6380,7 +6493,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 			message.primary.value = realManaChange;
 			message.primary.color = TEXTCOLOR_MAYABLUE;
 
-			SpectatorHashSet spectators;
+			SpectatorVec spectators;
 			map.getSpectators(spectators, targetPos, false, true);
 			for (Creature* spectator : spectators) {
 				Player* tmpPlayer = spectator->getPlayer();
@@ -6480,7 +6593,7 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 		message.primary.value = manaLoss;
 		message.primary.color = TEXTCOLOR_BLUE;
 
-		SpectatorHashSet spectators;
+		SpectatorVec spectators;
 		map.getSpectators(spectators, targetPos, false, true);
 		for (Creature* spectator : spectators) {
 			Player* tmpPlayer = spectator->getPlayer();
@@ -6534,12 +6647,12 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, CombatDamage&
 
 void Game::addCreatureHealth(const Creature* target)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, target->getPosition(), true, true);
 	addCreatureHealth(spectators, target);
 }
 
-void Game::addCreatureHealth(const SpectatorHashSet& spectators, const Creature* target)
+void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* target)
 {
 	uint8_t healthPercent = std::ceil((static_cast<double>(target->getHealth()) / std::max<int32_t>(target->getMaxHealth(), 1)) * 100);
 	if (const Player* targetPlayer = target->getPlayer()) {
@@ -6574,7 +6687,7 @@ void Game::addPlayerVocation(const Player* target)
 		party->updatePlayerVocation(target);
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, target->getPosition(), true, true);
 
 	for (Creature* spectator : spectators) {
@@ -6586,12 +6699,12 @@ void Game::addPlayerVocation(const Player* target)
 
 void Game::addMagicEffect(const Position& pos, uint8_t effect)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, pos, true, true);
 	addMagicEffect(spectators, pos, effect);
 }
 
-void Game::addMagicEffect(const SpectatorHashSet& spectators, const Position& pos, uint8_t effect)
+void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
 {
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
@@ -6602,13 +6715,13 @@ void Game::addMagicEffect(const SpectatorHashSet& spectators, const Position& po
 
 void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, fromPos, false, true);
 	map.getSpectators(spectators, toPos, false, true);
 	addDistanceEffect(spectators, fromPos, toPos, effect);
 }
 
-void Game::addDistanceEffect(const SpectatorHashSet& spectators, const Position& fromPos, const Position& toPos, uint8_t effect)
+void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect)
 {
 	for (Creature* spectator : spectators) {
 		if (Player* tmpPlayer = spectator->getPlayer()) {
@@ -6726,7 +6839,12 @@ void Game::shutdown()
 
 	SPDLOG_INFO("Shutting down...");
 
+	// Sends what is still queued, up to Webhook::SHUTDOWN_TIMEOUT
+	g_webhook().shutdown();
+
 	g_scheduler().shutdown();
+	g_playerLoader().shutdown();
+	g_saveWriter().shutdown();
 	g_databaseTasks().shutdown();
 	g_dispatcher().shutdown();
 	map.spawnsMonster.clear();
@@ -6793,7 +6911,7 @@ void Game::broadcastMessage(const std::string& text, MessageClasses type) const
 void Game::updateCreatureWalkthrough(const Creature* creature)
 {
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		Player* tmpPlayer = spectator->getPlayer();
@@ -6807,7 +6925,7 @@ void Game::updateCreatureSkull(const Creature* creature)
 		return;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureSkull(creature);
@@ -6816,7 +6934,7 @@ void Game::updateCreatureSkull(const Creature* creature)
 
 void Game::updatePlayerShield(Player* player)
 {
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, player->getPosition(), true, true);
 	for (Creature* spectator : spectators) {
 		spectator->getPlayer()->sendCreatureShield(player);
@@ -6845,7 +6963,7 @@ void Game::updateCreatureType(Creature* creature)
 	}
 
 	//send to clients
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 	if (creatureType == CREATURETYPE_SUMMON_OTHERS) {
 		for (Creature* spectator : spectators) {
@@ -7451,7 +7569,7 @@ void Game::playerNpcGreet(uint32_t playerId, uint32_t npcId)
 		return;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	spectators.insert(npc);
 	map.getSpectators(spectators, player->getPosition(), true, true);
 	internalCreatureSay(player, TALKTYPE_SAY, "hi", false, &spectators);
@@ -7730,7 +7848,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t ite
 		return;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t> (type), it.id, amount, price, tier, anonymous);
+	IOMarket::createOffer(player->getGUID(), player->getName(), static_cast<MarketAction_t> (type), it.id, amount, price, tier, anonymous);
 
 	// uint8_t = tier, uint64_t price
 	std::map<uint8_t, uint64_t> tierAndPriceMap;
@@ -8456,7 +8574,7 @@ void Game::sendUpdateCreature(const Creature* creature) {
 		return;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true);
 	for (Creature *spectator : spectators) {
 		if (const Player *tmpPlayer = spectator->getPlayer()) {
@@ -41,6 +41,22 @@ static constexpr int32_t EVENT_DECAYINTERVAL = 250;
 static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 static constexpr int32_t EVENT_FORGEABLEMONSTERCHECKINTERVAL = 300000;
 
+// Last server save in microseconds: the game paused to serialize, the duration lasts until all was written
+struct ServerSaveStats {
+	uint64_t saves = 0;
+	uint64_t pause = 0;
+	uint64_t duration = 0;
+};
+
+// Creatures in the check lists and sleeping ones, think times of a bucket in microseconds
+struct CreatureActivityStats {
+	uint64_t activeCreatures = 0;
+	uint64_t sleepingCreatures = 0;
+	uint64_t wokenCreatures = 0;
+	uint64_t lastThink = 0;
+	uint64_t maxThink = 0;
+};
+
 class Game
 {
 	public:
@@ -136,6 +152,9 @@ class Game
 
 		void addCreatureCheck(Creature* creature);
 		static void removeCreatureCheck(Creature* creature);
+		// Gives back to the check lists the sleeping creatures a player at pos could notice
+		void wakeCreatures(const Position& pos);
+		void wakeCreature(Creature* creature);
 
 		size_t getPlayersOnline() const {
 			return players.size();
@@ -219,7 +238,7 @@ class Game
 		bool internalCreatureSay(Creature* creature, SpeakClasses type,
                                  const std::string& text,
                                  bool ghostMode,
-                                 SpectatorHashSet* spectatorsPtr = nullptr,
+                                 SpectatorVec* spectatorsPtr = nullptr,
                                  const Position* pos = nullptr);
 
 		void internalQuickLootCorpse(Player* player, Container* corpse);
@@ -428,6 +447,12 @@ class Game
 		GameState_t getGameState() const;
 		void setGameState(GameState_t newState);
 		void saveGameState();
+		// Dispatcher thread, once everything saved is written
+		void onServerSaved(std::chrono::steady_clock::duration pause, std::chrono::steady_clock::duration duration);
+		const ServerSaveStats& getServerSaveStats() const {
+			return serverSaveStats;
+		}
+		CreatureActivityStats getCreatureActivityStats() const;
 
 		// Events
 		void checkCreatureWalk(uint32_t creatureId);
@@ -455,13 +480,13 @@ class Game
 
 		// Animation help functions
 		void addCreatureHealth(const Creature* target);
-		static void addCreatureHealth(const SpectatorHashSet& spectators, const Creature* target);
+		static void addCreatureHealth(const SpectatorVec& spectators, const Creature* target);
 		void addPlayerMana(const Player* target);
 		void addPlayerVocation(const Player* target);
 		void addMagicEffect(const Position& pos, uint8_t effect);
-		static void addMagicEffect(const SpectatorHashSet& spectators, const Position& pos, uint8_t effect);
+		static void addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect);
 		void addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect);
-		static void addDistanceEffect(const SpectatorHashSet& spectators, const Position& fromPos, const Position& toPos, uint8_t effect);
+		static void addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos, uint8_t effect);
 
 		int32_t getLightHour() const {
 			return lightHour;
@@ -596,6 +621,7 @@ class Game
 		bool playerYell(Player* player, const std::string& text);
 		bool playerSpeakTo(Player* player, SpeakClasses type, const std::string& receiver, const std::string& text);
 		void playerSpeakToNpc(Player* player, const std::string& text);
+		void resumeCreatureCheck(Creature* creature);
 
 		phmap::flat_hash_map<uint32_t, Player*> players;
 		phmap::flat_hash_map<std::string, Player*> mappedPlayerNames;
@@ -652,6 +678,10 @@ class Game
 		bool browseField = false;
 
 		GameState_t gameState = GAME_STATE_NORMAL;
+		ServerSaveStats serverSaveStats;
+		CreatureActivityStats activityStats;
+		std::vector<Creature*> wokenCreatures;
+
 		WorldType_t worldType = WORLD_TYPE_PVP;
 
 		LightState_t lightState = LIGHT_STATE_DAY;
@@ -679,20 +709,20 @@ class Game
 		void sendDamageMessageAndEffects(
 			const Creature *attacker, Creature *target, const CombatDamage &damage, const Position &targetPos,
 			Player *attackerPlayer, Player *targetPlayer, TextMessage &message,
-			const SpectatorHashSet &spectators, int32_t realDamage
+			const SpectatorVec &spectators, int32_t realDamage
 		);
 
 		void updatePlayerPartyHuntAnalyzer(const CombatDamage &damage, const Player *player) const;
 
 		void sendEffects(
 			Creature *target, const CombatDamage &damage, const Position &targetPos,
-			TextMessage &message, const SpectatorHashSet &spectators
+			TextMessage &message, const SpectatorVec &spectators
 		);
 
 		void sendMessages(
 			const Creature *attacker, const Creature *target, const CombatDamage &damage,
 			const Position &targetPos, Player *attackerPlayer, Player *targetPlayer,
-			TextMessage &message, const SpectatorHashSet &spectators, int32_t realDamage
+			TextMessage &message, const SpectatorVec &spectators, int32_t realDamage
 		) const;
 
 		bool shouldSendMessage(const TextMessage &message) const;
@@ -11,47 +11,45 @@
 
 #include "game/scheduling/scheduler.h"
 
+int64_t Scheduler::getTime()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
 void Scheduler::threadMain()
 {
-	std::unique_lock<std::mutex> eventLockUnique(eventLock, std::defer_lock);
+	std::unique_lock<std::mutex> eventLockUnique(eventLock);
 	while (getState() != THREAD_STATE_TERMINATED) {
-		std::cv_status ret = std::cv_status::no_timeout;
+		auto events = advance(getTime());
+		if (!events.empty()) {
+			executedEvents += events.size();
+			++dispatchedBatches;
+			eventLockUnique.unlock();
 
-		eventLockUnique.lock();
-		if (eventList.empty()) {
-			eventSignal.wait(eventLockUnique, [this] {
-				return eventList.empty();
-			});
-		} else {
-			ret = eventSignal.wait_until(eventLockUnique, eventList.top()->getCycle());
-		}
+			g_dispatcher().addTask(createTask([events = std::move(events)]() {
+				for (const auto &task : events) {
+					(*task)();
+				}
+			}), true);
 
-		// the mutex is locked again now...
-		if (ret == std::cv_status::timeout && !eventList.empty()) {
-			// ok we had a timeout, so there has to be an event we have to execute...
-			SchedulerTask* task = eventList.top();
-			eventList.pop();
-
-			// check if the event was stopped
-			auto it = eventIds.find(task->getEventId());
-			if (it == eventIds.end()) {
-				eventLockUnique.unlock();
-				delete task;
-				continue;
-			}
-			eventIds.erase(it);
-			eventLockUnique.unlock();
+			eventLockUnique.lock();
+			continue;
+		}
 
-			task->setDontExpire();
-			g_dispatcher().addTask(task, true);
+		wakeupTime = getNextWheelTime();
+		if (wakeupTime == std::numeric_limits<int64_t>::max()) {
+			eventSignal.wait(eventLockUnique);
 		} else {
-			eventLockUnique.unlock();
+			eventSignal.wait_until(eventLockUnique, std::chrono::system_clock::time_point(std::chrono::milliseconds(wakeupTime)));
 		}
+		wakeupTime = std::numeric_limits<int64_t>::max();
 	}
 }
 
 uint32_t Scheduler::addEvent(SchedulerTask* task)
 {
+	int64_t time = std::chrono::duration_cast<std::chrono::milliseconds>(task->getCycle().time_since_epoch()).count();
+
 	bool do_signal;
 	eventLock.lock();
 
@@ -67,27 +65,32 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 		}
 
 		// insert the event id in the list of active events
-		eventIds.insert(task->getEventId());
+		eventIds[task->getEventId()] = task;
+
+		// an empty wheel can jump straight to the current time
+		if (pendingCount == 0) {
+			currentTime = std::max<int64_t>(currentTime, getTime());
+		}
 
-		// add the event to the queue
-		eventList.push(task);
+		task->wheelTime = time;
+		insertEvent(task);
 
-		// if the list was empty or this event is the top in the list
-		// we have to signal it
-		do_signal = (task == eventList.top());
+		// wake the scheduler thread if it sleeps past this event
+		do_signal = time < wakeupTime;
 	} else {
 		eventLock.unlock();
 		delete task;
 		return 0;
 	}
 
+	uint32_t eventId = task->getEventId();
 	eventLock.unlock();
 
 	if (do_signal) {
 		eventSignal.notify_one();
 	}
 
-	return task->getEventId();
+	return eventId;
 }
 
 bool Scheduler::stopEvent(uint32_t eventid)
@@ -96,15 +99,24 @@ bool Scheduler::stopEvent(uint32_t eventid)
 		return false;
 	}
 
-	std::lock_guard<std::mutex> lockClass(eventLock);
+	SchedulerTask* task;
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
 
-	// search the event id..
-	auto it = eventIds.find(eventid);
-	if (it == eventIds.end()) {
-		return false;
+		// search the event id..
+		auto it = eventIds.find(eventid);
+		if (it == eventIds.end()) {
+			return false;
+		}
+
+		task = it->second;
+		eventIds.erase(it);
+		unlinkEvent(task);
+		++cancelledEvents;
 	}
 
-	eventIds.erase(it);
+	// The callable may hold resources, release them outside of the lock
+	delete task;
 	return true;
 }
 
@@ -114,17 +126,184 @@ void Scheduler::shutdown()
 	eventLock.lock();
 
 	//this list should already be empty
-	while (!eventList.empty()) {
-		delete eventList.top();
-		eventList.pop();
+	for (const auto &it : eventIds) {
+		delete it.second;
 	}
 
 	eventIds.clear();
+	for (auto &level : wheel) {
+		level.fill(SchedulerWheelSlot());
+	}
+	expiredSlot = SchedulerWheelSlot();
+	levelCount.fill(0);
+	pendingCount = 0;
 	eventLock.unlock();
 	eventSignal.notify_one();
 }
 
-SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f)
+SchedulerStats Scheduler::getStats()
+{
+	std::lock_guard<std::mutex> lockClass(eventLock);
+	SchedulerStats stats;
+	std::copy(levelCount.begin(), levelCount.end(), stats.pendingEvents.begin());
+	stats.executedEvents = executedEvents;
+	stats.cancelledEvents = cancelledEvents;
+	stats.dispatchedBatches = dispatchedBatches;
+	return stats;
+}
+
+void Scheduler::insertEvent(SchedulerTask* task)
+{
+	const int64_t time = task->wheelTime;
+	SchedulerWheelSlot* slot = nullptr;
+	uint8_t level = 0;
+
+	if (time <= currentTime) {
+		slot = &expiredSlot;
+	} else {
+		// pick the finest level whose window still covers the event
+		for (; level < SCHEDULER_WHEEL_LEVELS; ++level) {
+			const int64_t granularity = SCHEDULER_WHEEL_GRANULARITY[level];
+			const int64_t slots = SCHEDULER_WHEEL_SLOTS[level];
+			if (time / granularity - currentTime / granularity < slots) {
+				slot = &wheel[level][(time / granularity) % slots];
+				break;
+			}
+		}
+
+		// beyond the wheel range: park it in the farthest slot, it will be
+		// inserted again when that slot is cascaded
+		if (!slot) {
+			level = SCHEDULER_WHEEL_LEVELS - 1;
+			const int64_t granularity = SCHEDULER_WHEEL_GRANULARITY[level];
+			const int64_t slots = SCHEDULER_WHEEL_SLOTS[level];
+			slot = &wheel[level][(currentTime / granularity + slots - 1) % slots];
+		}
+	}
+
+	task->wheelSlot = slot;
+	task->wheelLevel = level;
+	task->wheelNext = nullptr;
+	task->wheelPrev = slot->tail;
+	if (slot->tail) {
+		slot->tail->wheelNext = task;
+	} else {
+		slot->head = task;
+	}
+	slot->tail = task;
+
+	++levelCount[level];
+	++pendingCount;
+}
+
+void Scheduler::unlinkEvent(SchedulerTask* task)
+{
+	SchedulerWheelSlot* slot = task->wheelSlot;
+	if (task->wheelPrev) {
+		task->wheelPrev->wheelNext = task->wheelNext;
+	} else {
+		slot->head = task->wheelNext;
+	}
+
+	if (task->wheelNext) {
+		task->wheelNext->wheelPrev = task->wheelPrev;
+	} else {
+		slot->tail = task->wheelPrev;
+	}
+
+	task->wheelSlot = nullptr;
+	task->wheelPrev = nullptr;
+	task->wheelNext = nullptr;
+
+	--levelCount[task->wheelLevel];
+	--pendingCount;
+}
+
+void Scheduler::cascade(size_t level, SchedulerWheelSlot &slot)
+{
+	SchedulerTask* task = slot.head;
+	slot = SchedulerWheelSlot();
+
+	while (task) {
+		SchedulerTask* next = task->wheelNext;
+		--levelCount[level];
+		--pendingCount;
+		insertEvent(task);
+		task = next;
+	}
+}
+
+void Scheduler::collect(SchedulerWheelSlot &slot, std::vector<std::unique_ptr<SchedulerTask>> &events)
+{
+	SchedulerTask* task = slot.head;
+	while (task) {
+		SchedulerTask* next = task->wheelNext;
+		--levelCount[task->wheelLevel];
+		--pendingCount;
+		eventIds.erase(task->getEventId());
+		task->wheelSlot = nullptr;
+		events.emplace_back(task);
+		task = next;
+	}
+	slot = SchedulerWheelSlot();
+}
+
+int64_t Scheduler::getNextWheelTime() const
+{
+	if (expiredSlot.head) {
+		return currentTime;
+	}
+
+	int64_t next = std::numeric_limits<int64_t>::max();
+	if (pendingCount == 0) {
+		return next;
+	}
+
+	// Only the first non empty slot of each level matters: for the finest
+	// level it is the event time, for the others the time it must be cascaded
+	for (size_t level = 0; level < SCHEDULER_WHEEL_LEVELS; ++level) {
+		if (levelCount[level] == 0) {
+			continue;
+		}
+
+		const int64_t granularity = SCHEDULER_WHEEL_GRANULARITY[level];
+		const int64_t slots = SCHEDULER_WHEEL_SLOTS[level];
+		const int64_t base = currentTime / granularity;
+		for (int64_t i = 1; i < slots; ++i) {
+			if (wheel[level][(base + i) % slots].head) {
+				next = std::min<int64_t>(next, (base + i) * granularity);
+				break;
+			}
+		}
+	}
+	return next;
+}
+
+std::vector<std::unique_ptr<SchedulerTask>> Scheduler::advance(int64_t now)
 {
-	return new SchedulerTask(delay, std::move(f));
+	std::vector<std::unique_ptr<SchedulerTask>> events;
+	collect(expiredSlot, events);
+
+	while (pendingCount != 0) {
+		const int64_t next = getNextWheelTime();
+		if (next > now) {
+			break;
+		}
+
+		currentTime = next;
+
+		// coarse levels first, so cascaded events due now are collected below
+		for (size_t level = SCHEDULER_WHEEL_LEVELS - 1; level > 0; --level) {
+			const int64_t granularity = SCHEDULER_WHEEL_GRANULARITY[level];
+			if (currentTime % granularity == 0) {
+				cascade(level, wheel[level][(currentTime / granularity) % SCHEDULER_WHEEL_SLOTS[level]]);
+			}
+		}
+
+		collect(wheel[0][currentTime % SCHEDULER_WHEEL_SLOTS[0]], events);
+		collect(expiredSlot, events);
+	}
+
+	currentTime = std::max<int64_t>(currentTime, now);
+	return events;
 }
@@ -15,6 +15,18 @@
 
 static constexpr int32_t SCHEDULER_MINTICKS = 50;
 
+// Timing wheel levels: 1 ms, 50 ms, seconds and minutes
+static constexpr size_t SCHEDULER_WHEEL_LEVELS = 4;
+static constexpr std::array<int64_t, SCHEDULER_WHEEL_LEVELS> SCHEDULER_WHEEL_GRANULARITY = { 1, 50, 1000, 60000 };
+static constexpr std::array<int64_t, SCHEDULER_WHEEL_LEVELS> SCHEDULER_WHEEL_SLOTS = { 50, 20, 60, 60 };
+
+class SchedulerTask;
+
+struct SchedulerWheelSlot {
+	SchedulerTask* head = nullptr;
+	SchedulerTask* tail = nullptr;
+};
+
 class SchedulerTask : public Task
 {
 	public:
@@ -30,21 +42,44 @@ class SchedulerTask : public Task
 		}
 
 	private:
-		SchedulerTask(uint32_t delay, std::function<void (void)>&& f) : Task(delay, std::move(f)) {}
+		SchedulerTask(uint32_t delay, TaskFunction&& f) : Task(delay, std::move(f)) {}
 
 		uint32_t eventId = 0;
 
-		friend SchedulerTask* createSchedulerTask(uint32_t, std::function<void (void)>);
-};
+		// Timing wheel bookkeeping, guarded by the scheduler lock
+		int64_t wheelTime = 0;
+		SchedulerWheelSlot* wheelSlot = nullptr;
+		SchedulerTask* wheelPrev = nullptr;
+		SchedulerTask* wheelNext = nullptr;
+		uint8_t wheelLevel = 0;
 
-SchedulerTask* createSchedulerTask(uint32_t delay, std::function<void (void)> f);
+		template <typename F>
+		friend SchedulerTask* createSchedulerTask(uint32_t, F&&);
+		friend class Scheduler;
+};
 
-struct TaskComparator {
-	bool operator()(const SchedulerTask* lhs, const SchedulerTask* rhs) const {
-		return lhs->getCycle() > rhs->getCycle();
-	}
+template <typename F>
+SchedulerTask* createSchedulerTask(uint32_t delay, F&& f) {
+	return new SchedulerTask(delay, TaskFunction(std::forward<F>(f)));
+}
+
+struct SchedulerStats {
+	// Events waiting in each wheel level (1 ms, 50 ms, seconds, minutes)
+	std::array<uint64_t, SCHEDULER_WHEEL_LEVELS> pendingEvents {};
+	uint64_t executedEvents = 0;
+	uint64_t cancelledEvents = 0;
+	// Dispatcher tasks created, each one runs every event due in the same tick
+	uint64_t dispatchedBatches = 0;
 };
 
+/**
+ * Hierarchical timing wheel.
+ *
+ * Adding and stopping an event is O(1): a stopped event is unlinked from its
+ * slot and released immediately. Events of a coarse level are cascaded to the
+ * finer levels when their slot is reached, and every event due in the same
+ * tick is handed to the dispatcher as a single task.
+ */
 class Scheduler : public ThreadHolder<Scheduler>
 {
 	public:
@@ -65,16 +100,40 @@ class Scheduler : public ThreadHolder<Scheduler>
 
 		void shutdown();
 
+		SchedulerStats getStats();
+
 		void threadMain();
 
 	private:
-		std::thread thread;
+		static int64_t getTime();
+
+		void insertEvent(SchedulerTask* task);
+		void unlinkEvent(SchedulerTask* task);
+		void cascade(size_t level, SchedulerWheelSlot &slot);
+		void collect(SchedulerWheelSlot &slot, std::vector<std::unique_ptr<SchedulerTask>> &events);
+		int64_t getNextWheelTime() const;
+		std::vector<std::unique_ptr<SchedulerTask>> advance(int64_t now);
+
 		std::mutex eventLock;
 		std::condition_variable eventSignal;
 
 		uint32_t lastEventId {0};
-		std::priority_queue<SchedulerTask*, std::deque<SchedulerTask*>, TaskComparator> eventList;
-		phmap::flat_hash_set<uint32_t> eventIds;
+		phmap::flat_hash_map<uint32_t, SchedulerTask*> eventIds;
+
+		std::array<std::array<SchedulerWheelSlot, 60>, SCHEDULER_WHEEL_LEVELS> wheel;
+		// Events whose time was already reached when they were inserted
+		SchedulerWheelSlot expiredSlot;
+		std::array<uint64_t, SCHEDULER_WHEEL_LEVELS> levelCount {};
+		uint64_t pendingCount = 0;
+
+		// Wheel clock, in milliseconds
+		int64_t currentTime = 0;
+		// Time the scheduler thread is sleeping until, used to avoid needless wake ups
+		int64_t wakeupTime = std::numeric_limits<int64_t>::max();
+
+		uint64_t executedEvents = 0;
+		uint64_t cancelledEvents = 0;
+		uint64_t dispatchedBatches = 0;
 };
 
 constexpr auto g_scheduler = &Scheduler::getInstance;
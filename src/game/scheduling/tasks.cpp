@@ -12,85 +12,96 @@
 #include "game/game.h"
 #include "game/scheduling/tasks.h"
 
-Task* createTask(std::function<void (void)> f)
-{
-	return new Task(std::move(f));
-}
-
-Task* createTask(uint32_t expiration, std::function<void (void)> f)
-{
-	return new Task(expiration, std::move(f));
-}
-
 void Dispatcher::threadMain()
 {
-	// NOTE: second argument defer_lock is to prevent from immediate locking
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-
 	while (getState() != THREAD_STATE_TERMINATED) {
-		// check if there are tasks waiting
-		taskLockUnique.lock();
-
-		if (taskList.empty()) {
-			//if the list is empty wait for signal
-			taskSignal.wait(taskLockUnique, [this] {
-				return taskList.empty();
-			});
+		// Read the signal before checking the queues, so a task pushed
+		// after the check makes the wait below return immediately
+		const uint32_t currentSignal = taskSignal.load(std::memory_order_acquire);
+
+		Task* task = priorityTaskList.pop();
+		if (!task) {
+			task = taskList.pop();
 		}
 
-		if (!taskList.empty()) {
-			// take the first task
-			Task* task = taskList.front();
-			taskList.pop_front();
-			taskLockUnique.unlock();
-
-			if (!task->hasExpired()) {
-				++dispatcherCycle;
-				// execute it
-				(*task)();
-			}
-			delete task;
-		} else {
-			taskLockUnique.unlock();
+		if (!task) {
+			taskSignal.wait(currentSignal, std::memory_order_acquire);
+			continue;
 		}
+
+		queueDepth.fetch_sub(1, std::memory_order_relaxed);
+
+		if (!task->hasExpired()) {
+			++dispatcherCycle;
+
+			auto latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - task->enqueueTime).count());
+			executedTasks.fetch_add(1, std::memory_order_relaxed);
+			totalLatency.fetch_add(latency, std::memory_order_relaxed);
+			uint64_t currentMax = maxLatency.load(std::memory_order_relaxed);
+			while (latency > currentMax && !maxLatency.compare_exchange_weak(currentMax, latency, std::memory_order_relaxed)) {}
+
+			// execute it
+			(*task)();
+		}
+		delete task;
+	}
+
+	// Tasks that raced with the shutdown are never executed
+	while (Task* task = priorityTaskList.pop()) {
+		delete task;
+	}
+	while (Task* task = taskList.pop()) {
+		delete task;
 	}
 }
 
 void Dispatcher::addTask(Task* task, bool push_front /*= false*/)
 {
-	bool do_signal = false;
-
-	taskLock.lock();
+	if (getState() != THREAD_STATE_RUNNING) {
+		delete task;
+		return;
+	}
 
-	if (getState() == THREAD_STATE_RUNNING) {
-		do_signal = taskList.empty();
+	task->enqueueTime = std::chrono::steady_clock::now();
+	queueDepth.fetch_add(1, std::memory_order_relaxed);
 
-		if (push_front) {
-			taskList.push_front(task);
-		} else {
-			taskList.push_back(task);
-		}
+	if (push_front) {
+		priorityTaskList.push(task);
 	} else {
-		delete task;
+		taskList.push(task);
 	}
 
-	taskLock.unlock();
+	signal();
+}
 
-	// send a signal if the list was empty
-	if (do_signal) {
-		taskSignal.notify_one();
-	}
+void Dispatcher::signal()
+{
+	taskSignal.fetch_add(1, std::memory_order_release);
+	taskSignal.notify_one();
 }
 
 void Dispatcher::shutdown()
 {
 	Task* task = createTask([this]() {
 		setState(THREAD_STATE_TERMINATED);
-		taskSignal.notify_one();
+		signal();
 	});
 
-	std::lock_guard<std::mutex> lockClass(taskLock);
-	taskList.push_back(task);
+	task->enqueueTime = std::chrono::steady_clock::now();
+	queueDepth.fetch_add(1, std::memory_order_relaxed);
+	taskList.push(task);
+	signal();
+}
 
-	taskSignal.notify_one();
+DispatcherStats Dispatcher::getStats()
+{
+	DispatcherStats stats;
+	stats.queueDepth = queueDepth.load(std::memory_order_relaxed);
+	stats.executedTasks = executedTasks.load(std::memory_order_relaxed);
+	if (stats.executedTasks != 0) {
+		stats.averageLatency = totalLatency.load(std::memory_order_relaxed) / stats.executedTasks;
+	}
+	stats.maxLatency = maxLatency.exchange(0, std::memory_order_relaxed);
+	return stats;
 }
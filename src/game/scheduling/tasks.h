@@ -10,17 +10,28 @@
 #ifndef SRC_GAME_SCHEDULING_TASKS_H_
 #define SRC_GAME_SCHEDULING_TASKS_H_
 
+#include "utils/block_pool.hpp"
+#include "utils/inplace_function.hpp"
+#include "utils/mpsc_queue.hpp"
 #include "utils/thread_holder_base.h"
 
 const int DISPATCHER_TASK_EXPIRATION = 2000;
 const auto SYSTEM_TIME_ZERO = std::chrono::system_clock::time_point(std::chrono::milliseconds(0));
 
-class Task
+// Callables up to this size (e.g. a std::bind with a handful of ids) are stored inside the task
+static constexpr size_t TASK_FUNCTION_CAPACITY = 64;
+// Tasks and scheduler tasks are recycled through blocks of this size
+static constexpr size_t TASK_BLOCK_SIZE = 192;
+
+using TaskFunction = InplaceFunction<TASK_FUNCTION_CAPACITY>;
+using TaskPool = BlockPool<TASK_BLOCK_SIZE>;
+
+class Task : public MpscNode
 {
 	public:
 		// DO NOT allocate this class on the stack
-		explicit Task(std::function<void (void)>&& f) : func(std::move(f)) {}
-		Task(uint32_t ms, std::function<void (void)>&& f) :
+		explicit Task(TaskFunction&& f) : func(std::move(f)) {}
+		Task(uint32_t ms, TaskFunction&& f) :
 			expiration(std::chrono::system_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f)) {}
 
 		virtual ~Task() = default;
@@ -39,6 +50,21 @@ class Task
 			return expiration < std::chrono::system_clock::now();
 		}
 
+		static void* operator new(size_t size) {
+			if (size <= TASK_BLOCK_SIZE) {
+				return TaskPool::allocate();
+			}
+			return ::operator new(size);
+		}
+
+		static void operator delete(void* ptr, size_t size) {
+			if (size <= TASK_BLOCK_SIZE) {
+				TaskPool::deallocate(ptr);
+				return;
+			}
+			::operator delete(ptr);
+		}
+
 	protected:
 		std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
 
@@ -46,11 +72,34 @@ class Task
 		// Expiration has another meaning for scheduler tasks,
 		// then it is the time the task should be added to the
 		// dispatcher
-		std::function<void (void)> func;
+		TaskFunction func;
+
+		// Set by the dispatcher when the task is queued
+		std::chrono::steady_clock::time_point enqueueTime;
+
+		friend class Dispatcher;
 };
 
-Task* createTask(std::function<void (void)> f);
-Task* createTask(uint32_t expiration, std::function<void (void)> f);
+template <typename F>
+Task* createTask(F&& f) {
+	return new Task(TaskFunction(std::forward<F>(f)));
+}
+
+template <typename F>
+Task* createTask(uint32_t expiration, F&& f) {
+	return new Task(expiration, TaskFunction(std::forward<F>(f)));
+}
+
+struct DispatcherStats {
+	// Tasks waiting to be executed
+	uint64_t queueDepth = 0;
+	// Tasks executed since the server started
+	uint64_t executedTasks = 0;
+	// Time between addTask and execution, in microseconds
+	uint64_t averageLatency = 0;
+	// Worst latency since the previous call to getStats
+	uint64_t maxLatency = 0;
+};
 
 class Dispatcher : public ThreadHolder<Dispatcher> {
 	public:
@@ -66,6 +115,11 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 			return instance;
 		}
 
+		/**
+		 * Queues a task, it can be called from any thread.
+		 * Tasks added with push_front are executed before any regular task
+		 * (used for expired scheduler events).
+		 */
 		void addTask(Task* task, bool push_front = false);
 
 		void shutdown();
@@ -74,13 +128,24 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 			return dispatcherCycle;
 		}
 
+		DispatcherStats getStats();
+
 		void threadMain();
 
 	private:
-		std::mutex taskLock;
-		std::condition_variable taskSignal;
+		void signal();
+
+		MpscQueue<Task> taskList;
+		MpscQueue<Task> priorityTaskList;
+
+		// Bumped on every push, the dispatcher sleeps on it when both queues are empty
+		std::atomic<uint32_t> taskSignal {0};
+
+		std::atomic<uint64_t> queueDepth {0};
+		std::atomic<uint64_t> executedTasks {0};
+		std::atomic<uint64_t> totalLatency {0};
+		std::atomic<uint64_t> maxLatency {0};
 
-		std::list<Task*> taskList;
 		uint64_t dispatcherCycle = 0;
 };
 
@@ -12,9 +12,7 @@
 #include "io/functions/iologindata_load_player.hpp"
 
 void IOLoginDataLoad::loadPlayerForgeHistory(Player *player, DBResult_ptr result) {
-	std::ostringstream query;
-	query << "SELECT * FROM `forge_history` WHERE `player_id` = " << player->getGUID();
-	if (result = Database::getInstance().storeQuery(query.str())) {
+	if (result) {
 		do {
 			auto actionEnum = magic_enum::enum_value<ForgeConversion_t>(result->getNumber<uint16_t>("action_type"));
 			ForgeHistory history;
@@ -11,16 +11,14 @@
 
 #include "io/functions/iologindata_save_player.hpp"
 
-bool IOLoginDataSave::savePlayerForgeHistory(Player *player) {
+bool IOLoginDataSave::savePlayerForgeHistory(Player *player, DBBatch &batch) {
 	std::ostringstream query;
 	query << "DELETE FROM `forge_history` WHERE `player_id` = " << player->getGUID();
-	if (!Database::getInstance().executeQuery(query.str())) {
-		return false;
-	}
+	batch.add(query.str());
 
 	query.str(std::string());
 
-	DBInsert insertQuery("INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES");
+	DBInsert insertQuery("INSERT INTO `forge_history` (`player_id`, `action_type`, `description`, `done_at`, `is_success`) VALUES", batch);
 	for (const auto &history : player->getForgeHistory()) {
 		const auto stringDescription = Database::getInstance().escapeString(history.description);
 		auto actionString = magic_enum::enum_integer(history.actionType);
@@ -15,7 +15,7 @@
 class IOLoginDataSave : public IOLoginData
 {
 public:
-	static bool savePlayerForgeHistory(Player *player);
+	static bool savePlayerForgeHistory(Player *player, DBBatch &batch);
 };
 
 #endif  // SRC_IO__FUNCTIONS_IOLOGINDATASAVE_HPP_
@@ -35,14 +35,19 @@ Guild* IOGuild::loadGuild(uint32_t guildId)
 }
 
 void IOGuild::saveGuild(Guild* guild) {
+  DBBatch batch;
+  saveGuild(guild, batch);
+  batch.execute();
+}
+
+void IOGuild::saveGuild(Guild* guild, DBBatch& batch) {
   if (!guild)
     return;
-  Database& db = Database::getInstance();
   std::ostringstream updateQuery;
   updateQuery << "UPDATE `guilds` SET ";
   updateQuery << "`balance` = " << guild->getBankBalance();
   updateQuery << " WHERE `id` = " << guild->getId();
-  db.executeQuery(updateQuery.str());
+  batch.add(updateQuery.str());
 }
 
 uint32_t IOGuild::getGuildIdByName(const std::string& name)
@@ -10,6 +10,7 @@
 #ifndef SRC_IO_IOGUILD_H_
 #define SRC_IO_IOGUILD_H_
 
+class DBBatch;
 class Guild;
 using GuildWarVector = std::vector<uint32_t>;
 
@@ -18,6 +19,7 @@ class IOGuild
 	public:
 		static Guild* loadGuild(uint32_t guildId);
     static void saveGuild(Guild* guild);
+    static void saveGuild(Guild* guild, DBBatch& batch);
 		static uint32_t getGuildIdByName(const std::string& name);
 		static void getWarList(uint32_t guildId, GuildWarVector& guildWarVector);
 };
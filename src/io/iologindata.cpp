@@ -15,6 +15,87 @@
 #include "game/game.h"
 #include "creatures/monsters/monster.h"
 #include "io/ioprey.h"
+#include "io/savewriter.h"
+#include "database/databasetasks.h"
+#include "game/scheduling/tasks.h"
+
+namespace {
+
+constexpr std::string_view ITEM_COLUMNS = "`pid`, `sid`, `itemtype`, `count`, `attributes`";
+
+// Dispatcher thread, like every save
+uint64_t saveSequence = 0;
+phmap::flat_hash_map<uint32_t, uint64_t> lastSaves;
+// Saves queued on the save writer, by player
+phmap::flat_hash_map<uint32_t, uint32_t> pendingSaves;
+PlayerSaveStats saveStats;
+
+void addSaveStats(uint64_t rows)
+{
+  ++saveStats.saves;
+  saveStats.rows += rows;
+  saveStats.lastRows = rows;
+}
+
+/**
+ * Adds the writes of the rows of a player table that differ from the saved
+ * ones: the keys whose row changed or is gone are deleted, then the changed and
+ * new rows are inserted. Without saved rows the whole table is rewritten.
+ */
+void saveRows(std::string_view table, std::string_view keyColumn, std::string_view columns, uint32_t guid, DBBatch& batch,
+              const std::optional<PlayerRows>& saved, const PlayerRows& rows, uint64_t& written)
+{
+  std::string staleKeys;
+  size_t staleRows = 0;
+  if (saved) {
+    for (const auto& [key, row] : *saved) {
+      auto it = rows.find(key);
+      if (it == rows.end() || it->second != row) {
+        if (staleRows++ != 0) {
+          staleKeys.push_back(',');
+        }
+        staleKeys.append(key);
+      }
+    }
+  }
+
+  if (!saved || (staleRows != 0 && staleRows == saved->size())) {
+    batch.add(fmt::format("DELETE FROM `{}` WHERE `player_id` = {}", table, guid));
+  } else if (staleRows != 0) {
+    batch.add(fmt::format("DELETE FROM `{}` WHERE `player_id` = {} AND `{}` IN ({})", table, guid, keyColumn, staleKeys));
+  }
+  written += staleRows;
+
+  DBInsert insert(fmt::format("INSERT INTO `{}` (`player_id`, {}) VALUES ", table, columns), batch);
+  for (const auto& [key, row] : rows) {
+    if (saved) {
+      auto it = saved->find(key);
+      if (it != saved->end() && it->second == row) {
+        continue;
+      }
+    }
+
+    insert.addRow(fmt::format("{},{}", guid, row));
+    ++written;
+  }
+  insert.execute();
+}
+
+// Takes the sections a save wrote, the ones it skipped stay as they were
+void updateSavedRows(PlayerSavedRows& saved, PlayerSavedRows&& written)
+{
+  for (auto section : { &PlayerSavedRows::items, &PlayerSavedRows::depotItems, &PlayerSavedRows::rewardItems,
+                        &PlayerSavedRows::inboxItems, &PlayerSavedRows::storage, &PlayerSavedRows::spells,
+                        &PlayerSavedRows::stash, &PlayerSavedRows::prey, &PlayerSavedRows::taskHunt }) {
+    if (written.*section) {
+      saved.*section = std::move(written.*section);
+    }
+  }
+  saved.kills = std::move(written.kills);
+  saved.charms = std::move(written.charms);
+}
+
+}  // namespace
 
 bool IOLoginData::authenticateAccountPassword(const std::string& email, const std::string& password, account::Account *account) {
 	if (account::ERROR_NO != account->LoadAccountDB(email)) {
@@ -74,31 +155,125 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
     return;
   }
 
-  std::ostringstream query;
+  // Queued in order, so a quick relog still ends up online
   if (login) {
-    query << "INSERT INTO `players_online` VALUES (" << guid << ')';
+    g_databaseTasks().addRow("INSERT INTO `players_online` (`player_id`) VALUES ", std::to_string(guid), "ON DUPLICATE KEY UPDATE `player_id` = VALUES(`player_id`)");
   } else {
-    query << "DELETE FROM `players_online` WHERE `player_id` = " << guid;
+    g_databaseTasks().addTask(fmt::format("DELETE FROM `players_online` WHERE `player_id` = {}", guid));
   }
-  Database::getInstance().executeQuery(query.str());
 }
 
-bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
+bool IOLoginData::fetchPlayerById(PlayerLoadData& data, uint32_t id)
 {
-  Database& db = Database::getInstance();
+  DBStatement statement("SELECT * FROM `players` WHERE `id` = ?");
+  statement.bind(id);
+  return fetchPlayer(data, Database::getInstance().storeQuery(statement));
+}
 
-  std::ostringstream query;
-  query << "SELECT `id`, `account_id`, `group_id`, `deletion`, (SELECT `type` FROM `accounts` WHERE `accounts`.`id` = `account_id`) AS `account_type`";
-  if (!g_configManager().getBoolean(FREE_PREMIUM)) {
-    query << ", (SELECT `premdays` FROM `accounts` WHERE `accounts`.`id` = `account_id`) AS `premium_days`";
-  }
-  query << " FROM `players` WHERE `name` = " << db.escapeString(name);
-  DBResult_ptr result = db.storeQuery(query.str());
+bool IOLoginData::fetchPlayerByName(PlayerLoadData& data, const std::string& name)
+{
+  DBStatement statement("SELECT * FROM `players` WHERE `name` = ?");
+  statement.bind(name);
+  return fetchPlayer(data, Database::getInstance().storeQuery(statement));
+}
+
+bool IOLoginData::fetchPlayer(PlayerLoadData& data, DBResult_ptr result)
+{
   if (!result) {
     return false;
   }
 
-  if (result->getNumber<uint64_t>("deletion") != 0) {
+  Database& db = Database::getInstance();
+  data.player = result;
+  uint32_t guid = result->getNumber<uint32_t>("id");
+  uint32_t accountId = result->getNumber<uint32_t>("account_id");
+
+  DBStatement accountStatement("SELECT `id`, `type`, `premdays`, `coins` FROM `accounts` WHERE `id` = ?");
+  accountStatement.bind(accountId);
+  data.account = db.storeQuery(accountStatement);
+
+  DBStatement membershipStatement("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = ?");
+  membershipStatement.bind(guid);
+  if ((data.guildMembership = db.storeQuery(membershipStatement))) {
+    uint32_t guildId = data.guildMembership->getNumber<uint32_t>("guild_id");
+
+    DBStatement rankStatement("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = ?");
+    rankStatement.bind(data.guildMembership->getNumber<uint32_t>("rank_id"));
+    data.guildRank = db.storeQuery(rankStatement);
+
+    DBStatement countStatement("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = ?");
+    countStatement.bind(guildId);
+    data.guildMemberCount = db.storeQuery(countStatement);
+
+    IOGuild::getWarList(guildId, data.guildWars);
+  }
+
+  DBStatement stashStatement("SELECT `item_count`, `item_id` FROM `player_stash` WHERE `player_id` = ?");
+  stashStatement.bind(guid);
+  data.stash = db.storeQuery(stashStatement);
+
+  DBStatement charmsStatement("SELECT * FROM `player_charms` WHERE `player_guid` = ?");
+  charmsStatement.bind(guid);
+  if (!(data.charms = db.storeQuery(charmsStatement))) {
+    DBStatement insertStatement("INSERT INTO `player_charms` (`player_guid`) VALUES (?)");
+    insertStatement.bind(guid);
+    db.executeQuery(insertStatement);
+  }
+
+  DBStatement spellsStatement("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = ?");
+  spellsStatement.bind(guid);
+  data.spells = db.storeQuery(spellsStatement);
+
+  DBStatement killsStatement("SELECT `player_id`, `time`, `target`, `unavenged` FROM `player_kills` WHERE `player_id` = ?");
+  killsStatement.bind(guid);
+  data.kills = db.storeQuery(killsStatement);
+
+  DBStatement itemsStatement("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = ? ORDER BY `sid` DESC");
+  itemsStatement.bind(guid);
+  data.items = db.storeQuery(itemsStatement);
+
+  DBStatement depotStatement("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = ? ORDER BY `sid` DESC");
+  depotStatement.bind(guid);
+  data.depotItems = db.storeQuery(depotStatement);
+
+  DBStatement rewardsStatement("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_rewards` WHERE `player_id` = ? ORDER BY `sid` DESC");
+  rewardsStatement.bind(guid);
+  data.rewardItems = db.storeQuery(rewardsStatement);
+
+  DBStatement inboxStatement("SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC");
+  inboxStatement.bind(guid);
+  data.inboxItems = db.storeQuery(inboxStatement);
+
+  DBStatement storageStatement("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?");
+  storageStatement.bind(guid);
+  data.storage = db.storeQuery(storageStatement);
+
+  DBStatement vipStatement("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = ?");
+  vipStatement.bind(accountId);
+  data.vip = db.storeQuery(vipStatement);
+
+  if (g_configManager().getBoolean(PREY_ENABLED)) {
+    DBStatement preyStatement("SELECT * FROM `player_prey` WHERE `player_id` = ?");
+    preyStatement.bind(guid);
+    data.prey = db.storeQuery(preyStatement);
+  }
+
+  DBStatement forgeStatement("SELECT * FROM `forge_history` WHERE `player_id` = ?");
+  forgeStatement.bind(guid);
+  data.forgeHistory = db.storeQuery(forgeStatement);
+
+  if (g_configManager().getBoolean(TASK_HUNTING_ENABLED)) {
+    DBStatement taskHuntStatement("SELECT * FROM `player_taskhunt` WHERE `player_id` = ?");
+    taskHuntStatement.bind(guid);
+    data.taskHunt = db.storeQuery(taskHuntStatement);
+  }
+  return true;
+}
+
+bool IOLoginData::preloadPlayer(Player* player, const PlayerLoadData& data)
+{
+  const DBResult_ptr& result = data.player;
+  if (!result || result->getNumber<uint64_t>("deletion") != 0) {
     return false;
   }
 
@@ -111,9 +286,11 @@ bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
   }
   player->setGroup(group);
   player->accountNumber = result->getNumber<uint32_t>("account_id");
-  player->accountType = static_cast<account::AccountType>(result->getNumber<uint16_t>("account_type"));
+  if (data.account) {
+    player->accountType = static_cast<account::AccountType>(data.account->getNumber<uint16_t>("type"));
+  }
   if (!g_configManager().getBoolean(FREE_PREMIUM)) {
-    player->premiumDays = result->getNumber<uint16_t>("premium_days");
+    player->premiumDays = data.account ? data.account->getNumber<uint16_t>("premdays") : 0;
   } else {
     player->premiumDays = std::numeric_limits<uint16_t>::max();
   }
@@ -122,46 +299,56 @@ bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
 {
-  Database& db = Database::getInstance();
-  std::ostringstream query;
-  query << "SELECT * FROM `players` WHERE `id` = " << id;
-  return loadPlayer(player, db.storeQuery(query.str()));
+  // The rows must not predate a save still being written
+  if (isSavePending(id)) {
+    g_saveWriter().flush();
+  }
+
+  PlayerLoadData data;
+  return fetchPlayerById(data, id) && loadPlayer(player, data);
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
 {
-  Database& db = Database::getInstance();
-  std::ostringstream query;
-  query << "SELECT * FROM `players` WHERE `name` = " << db.escapeString(name);
-  return loadPlayer(player, db.storeQuery(query.str()));
+  PlayerLoadData data;
+  if (!fetchPlayerByName(data, name)) {
+    return false;
+  }
+
+  uint32_t guid = data.player->getNumber<uint32_t>("id");
+  if (isSavePending(guid)) {
+    return loadPlayerById(player, guid);
+  }
+  return loadPlayer(player, data);
 }
 
 bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 {
+  PlayerLoadData data;
+  return fetchPlayer(data, result) && loadPlayer(player, data);
+}
+
+bool IOLoginData::loadPlayer(Player* player, const PlayerLoadData& data)
+{
+  DBResult_ptr result = data.player;
   if (!result || !player) {
     return false;
   }
 
-  Database& db = Database::getInstance();
-
-  uint32_t accountId = result->getNumber<uint32_t>("account_id");
-  account::Account acc;
-  acc.SetDatabaseInterface(&db);
-  acc.LoadAccountDB(accountId);
-
   player->setGUID(result->getNumber<uint32_t>("id"));
   player->name = result->getString("name");
-  acc.GetID(&(player->accountNumber));
-  acc.GetAccountType(&(player->accountType));
+  if (const DBResult_ptr& accountResult = data.account) {
+    player->accountNumber = accountResult->getNumber<uint32_t>("id");
+    player->accountType = static_cast<account::AccountType>(accountResult->getNumber<int32_t>("type"));
+    player->coinBalance = accountResult->getNumber<uint32_t>("coins");
+  }
 
   if (g_configManager().getBoolean(FREE_PREMIUM)) {
     player->premiumDays = std::numeric_limits<uint16_t>::max();
   } else {
-    acc.GetPremiumRemaningDays(&(player->premiumDays));
+    player->premiumDays = data.account ? data.account->getNumber<uint16_t>("premdays") : 0;
   }
 
-  acc.GetCoins(&(player->coinBalance));
-
   Group* group = g_game().groups.getGroup(result->getNumber<uint16_t>("group_id"));
   if (!group) {
     SPDLOG_ERROR("Player {} has group id {} which doesn't exist", player->name, result->getNumber<uint16_t>("group_id"));
@@ -328,9 +515,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   player->setManaShield(result->getNumber<uint16_t>("manashield"));
   player->setMaxManaShield(result->getNumber<uint16_t>("max_manashield"));
 
-  std::ostringstream query;
-  query << "SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  if ((result = data.guildMembership)) {
     uint32_t guildId = result->getNumber<uint32_t>("guild_id");
     uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
     player->guildNick = result->getString("nick");
@@ -345,10 +530,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
       player->guild = guild;
       GuildRank_ptr rank = guild->getRankById(playerRankId);
       if (!rank) {
-        query.str(std::string());
-        query << "SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = " << playerRankId;
-
-        if ((result = db.storeQuery(query.str()))) {
+        if ((result = data.guildRank)) {
           guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"), result->getNumber<uint16_t>("level"));
         }
 
@@ -359,30 +541,28 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
       }
 
       player->guildRank = rank;
+      player->guildWarVector = data.guildWars;
 
-      IOGuild::getWarList(guildId, player->guildWarVector);
-
-      query.str(std::string());
-      query << "SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = " << guildId;
-      if ((result = db.storeQuery(query.str()))) {
+      if ((result = data.guildMemberCount)) {
         guild->setMemberCount(result->getNumber<uint32_t>("members"));
       }
     }
   }
 
   // Stash load items
-  query.str(std::string());
-  query << "SELECT `item_count`, `item_id`  FROM `player_stash` WHERE `player_id` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  Database& db = Database::getInstance();
+  PlayerRows& savedStash = player->savedRows.stash.emplace();
+  if ((result = data.stash)) {
     do {
-      player->addItemOnStash(result->getNumber<uint16_t>("item_id"), result->getNumber<uint32_t>("item_count"));
+      uint16_t itemId = result->getNumber<uint16_t>("item_id");
+      uint32_t itemCount = result->getNumber<uint32_t>("item_count");
+      player->addItemOnStash(itemId, itemCount);
+      savedStash[std::to_string(itemId)] = fmt::format("{},{}", itemId, itemCount);
     } while (result->next());
   }
 
-  // Bestiary charms
-  query.str(std::string());
-  query << "SELECT * FROM `player_charms` WHERE `player_guid` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  // Bestiary charms, the row was created by the fetch when missing
+  if ((result = data.charms)) {
 	player->charmPoints = result->getNumber<uint32_t>("charm_points");
 	player->charmExpansion = result->getNumber<bool>("charm_expansion");
 	player->charmRuneWound = result->getNumber<uint16_t>("rune_wound");
@@ -421,41 +601,38 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   }
 
 
-  } else {
-	query.str(std::string());
-	query << "INSERT INTO `player_charms` (`player_guid`) VALUES (" << player->getGUID() << ')';
-	Database::getInstance().executeQuery(query.str());
   }
 
-  query.str(std::string());
-  query << "SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  PlayerRows& savedSpells = player->savedRows.spells.emplace();
+  if ((result = data.spells)) {
     do {
-      player->learnedInstantSpellList.emplace_front(result->getString("name"));
+      const std::string& spellName = player->learnedInstantSpellList.emplace_front(result->getString("name"));
+      std::string escapedName = db.escapeString(spellName);
+      savedSpells[escapedName] = escapedName;
     } while (result->next());
   }
 
   //load inventory items
   ItemMap itemMap;
 
-  query.str(std::string());
-  query << "SELECT `player_id`, `time`, `target`, `unavenged` FROM `player_kills` WHERE `player_id` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  std::string& savedKills = player->savedRows.kills.emplace();
+  if ((result = data.kills)) {
     do {
+      uint32_t target = result->getNumber<uint32_t>("target");
       time_t killTime = result->getNumber<time_t>("time");
+      bool unavenged = result->getNumber<bool>("unavenged");
       if ((time(nullptr) - killTime) <= g_configManager().getNumber(FRAG_TIME)) {
-        player->unjustifiedKills.emplace_back(result->getNumber<uint32_t>("target"), killTime, result->getNumber<bool>("unavenged"));
+        player->unjustifiedKills.emplace_back(target, killTime, unavenged);
       }
+      savedKills += fmt::format("({},{},{})", target, killTime, unavenged);
     } while (result->next());
   }
 
-  query.str(std::string());
-  query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-
   std::vector<std::pair<uint8_t, Container*>> openContainersList;
 
-  if ((result = db.storeQuery(query.str()))) {
-    loadItems(itemMap, result, *player);
+  PlayerRows& savedItems = player->savedRows.items.emplace();
+  if ((result = data.items)) {
+    loadItems(itemMap, result, *player, savedItems);
 
     for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
       const std::pair<Item*, int32_t>& pair = it->second;
@@ -517,10 +694,9 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   //load depot items
   itemMap.clear();
 
-  query.str(std::string());
-  query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-  if ((result = db.storeQuery(query.str()))) {
-    loadItems(itemMap, result, *player);
+  PlayerRows& savedDepotItems = player->savedRows.depotItems.emplace();
+  if ((result = data.depotItems)) {
+    loadItems(itemMap, result, *player, savedDepotItems);
 
     for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
       const std::pair<Item*, int32_t>& pair = it->second;
@@ -551,10 +727,9 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   //load reward chest items
   itemMap.clear();
 
-  query.str(std::string());
-  query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_rewards` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-    if ((result = db.storeQuery(query.str()))) {
-    loadItems(itemMap, result, *player);
+  PlayerRows& savedRewardItems = player->savedRows.rewardItems.emplace();
+  if ((result = data.rewardItems)) {
+    loadItems(itemMap, result, *player, savedRewardItems);
 
     //first loop handles the reward containers to retrieve its date attribute
     //for (ItemMap::iterator it = itemMap.begin(), end = itemMap.end(); it != end; ++it) {
@@ -600,10 +775,9 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   //load inbox items
   itemMap.clear();
 
-  query.str(std::string());
-  query << "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = " << player->getGUID() << " ORDER BY `sid` DESC";
-  if ((result = db.storeQuery(query.str()))) {
-    loadItems(itemMap, result, *player);
+  PlayerRows& savedInboxItems = player->savedRows.inboxItems.emplace();
+  if ((result = data.inboxItems)) {
+    loadItems(itemMap, result, *player, savedInboxItems);
 
     for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
       const std::pair<Item*, int32_t>& pair = it->second;
@@ -630,18 +804,20 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   }
 
   //load storage map
-  query.str(std::string());
-  query << "SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = " << player->getGUID();
-  if ((result = db.storeQuery(query.str()))) {
+  PlayerRows& savedStorage = player->savedRows.storage.emplace();
+  if ((result = data.storage)) {
+    const auto keyColumn = result->getColumn("key");
+    const auto valueColumn = result->getColumn("value");
     do {
-      player->addStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
+      uint32_t key = result->getNumber<uint32_t>(keyColumn);
+      int32_t value = result->getNumber<int32_t>(valueColumn);
+      player->addStorageValue(key, value, true);
+      savedStorage[std::to_string(key)] = fmt::format("{},{}", key, value);
     } while (result->next());
   }
 
   //load vip
-  query.str(std::string());
-  query << "SELECT `player_id` FROM `account_viplist` WHERE `account_id` = " << player->getAccount();
-  if ((result = db.storeQuery(query.str()))) {
+  if ((result = data.vip)) {
     do {
       player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
     } while (result->next());
@@ -649,9 +825,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 
   // Load prey class
   if (g_configManager().getBoolean(PREY_ENABLED)) {
-    query.str(std::string());
-    query << "SELECT * FROM `player_prey` WHERE `player_id` = " << player->getGUID();
-    if (result = db.storeQuery(query.str())) {
+    if ((result = data.prey)) {
       do {
         auto slot = new PreySlot(static_cast<PreySlot_t>(result->getNumber<uint16_t>("slot")));
         PreyDataState_t state = static_cast<PreyDataState_t>(result->getNumber<uint16_t>("state"));
@@ -687,13 +861,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
     }
   }
 
-  IOLoginDataLoad::loadPlayerForgeHistory(player, result);
+  IOLoginDataLoad::loadPlayerForgeHistory(player, data.forgeHistory);
 
   // Load task hunting class
   if (g_configManager().getBoolean(TASK_HUNTING_ENABLED)) {
-    query.str(std::string());
-    query << "SELECT * FROM `player_taskhunt` WHERE `player_id` = " << player->getGUID();
-    if (result = db.storeQuery(query.str())) {
+    if ((result = data.taskHunt)) {
       do {
         auto slot = new TaskHuntingSlot(static_cast<PreySlot_t>(result->getNumber<uint16_t>("slot")));
         PreyTaskDataState_t state = static_cast<PreyTaskDataState_t>(result->getNumber<uint16_t>("state"));
@@ -740,12 +912,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
   return true;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream)
+void IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, PlayerRows& rows, PropWriteStream& propWriteStream)
 {
   Database& db = Database::getInstance();
 
-  std::ostringstream ss;
-
   using ContainerBlock = std::pair<Container*, int32_t>;
   std::list<ContainerBlock> queue;
 
@@ -783,11 +953,7 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
     size_t attributesSize;
     const char* attributes = propWriteStream.getStream(attributesSize);
 
-    ss << player->getGUID() << ',' << pid << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, attributesSize);
-    if (!query_insert.addRow(ss)) {
-      return false;
-    }
-
+    rows[std::to_string(runningId)] = fmt::format("{},{},{},{},{}", pid, runningId, item->getID(), item->getSubType(), db.escapeBlob(attributes, attributesSize));
   }
 
   while (!queue.empty()) {
@@ -825,84 +991,137 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
       size_t attributesSize;
       const char* attributes = propWriteStream.getStream(attributesSize);
 
-      ss << player->getGUID() << ',' << parentId << ',' << runningId << ',' << item->getID() << ',' << item->getSubType() << ',' << db.escapeBlob(attributes, attributesSize);
-      if (!query_insert.addRow(ss)) {
-        return false;
-      }
+      rows[std::to_string(runningId)] = fmt::format("{},{},{},{},{}", parentId, runningId, item->getID(), item->getSubType(), db.escapeBlob(attributes, attributesSize));
     }
   }
-  return query_insert.execute();
 }
 
-bool IOLoginData::savePlayer(Player* player)
+PlayerSaveResult_t PlayerSave::write() const
 {
-  if (player->getHealth() <= 0) {
-    player->changeHealth(1);
-  }
   Database& db = Database::getInstance();
 
-  std::ostringstream query;
-  query << "SELECT `save` FROM `players` WHERE `id` = " << player->getGUID();
-  DBResult_ptr result = db.storeQuery(query.str());
+  DBStatement selectSave("SELECT `save` FROM `players` WHERE `id` = ?");
+  selectSave.bind(guid);
+  DBResult_ptr result = db.storeQuery(selectSave);
   if (!result) {
-    SPDLOG_WARN("[IOLoginData::savePlayer] - Error for select result query from player: {}", player->getName());
-    return false;
+    SPDLOG_WARN("[IOLoginData::savePlayer] - Error for select result query from player: {}", name);
+    return PLAYER_SAVE_FAILED;
   }
 
   if (result->getNumber<uint16_t>("save") == 0) {
-    query.str(std::string());
-    query << "UPDATE `players` SET `lastlogin` = " << player->lastLoginSaved << ", `lastip` = " << player->lastIP << " WHERE `id` = " << player->getGUID();
-    return db.executeQuery(query.str());
+    return db.executeQuery(updateLogin) ? PLAYER_SAVE_LOGIN : PLAYER_SAVE_FAILED;
+  }
+  return batch.execute() ? PLAYER_SAVE_DONE : PLAYER_SAVE_FAILED;
+}
+
+bool IOLoginData::savePlayer(Player* player)
+{
+  if (isSavePending(player->getGUID())) {
+    savePlayerAsync(player);
+    return true;
+  }
+
+  PlayerSave save;
+  serializePlayer(player, save);
+  lastSaves[save.guid] = ++saveSequence;
+
+  PlayerSaveResult_t result = save.write();
+  if (result == PLAYER_SAVE_DONE) {
+    updateSavedRows(player->savedRows, std::move(save.savedRows));
+    addSaveStats(save.rows);
   }
+  return result != PLAYER_SAVE_FAILED;
+}
+
+void IOLoginData::savePlayerAsync(Player* player)
+{
+  auto save = std::make_shared<PlayerSave>();
+  serializePlayer(player, *save);
+  // Taken as written already, so the next save diffs against this one; a failed write drops them
+  updateSavedRows(player->savedRows, std::move(save->savedRows));
+  ++pendingSaves[save->guid];
+
+  g_saveWriter().addTask([save]() {
+    PlayerSaveResult_t result = save->write();
+    g_dispatcher().addTask(createTask([guid = save->guid, rows = save->rows, result]() {
+      onPlayerSaved(guid, rows, result);
+    }));
+  });
+}
+
+void IOLoginData::onPlayerSaved(uint32_t guid, uint64_t rows, PlayerSaveResult_t result)
+{
+  auto it = pendingSaves.find(guid);
+  if (it != pendingSaves.end() && --it->second == 0) {
+    pendingSaves.erase(it);
+  }
+  lastSaves[guid] = ++saveSequence;
+
+  if (result == PLAYER_SAVE_DONE) {
+    addSaveStats(rows);
+    return;
+  }
+
+  if (result == PLAYER_SAVE_FAILED) {
+    SPDLOG_ERROR("[IOLoginData::onPlayerSaved] - Failed to save player with guid {}", guid);
+  }
+
+  // The tables do not hold what was assumed, its next save rewrites them
+  if (Player* player = g_game().getPlayerByGUID(guid)) {
+    player->savedRows = PlayerSavedRows();
+  }
+}
+
+bool IOLoginData::isSavePending(uint32_t guid)
+{
+  return pendingSaves.contains(guid);
+}
+
+void IOLoginData::serializePlayer(Player* player, PlayerSave& save)
+{
+  if (player->getHealth() <= 0) {
+    player->changeHealth(1);
+  }
+  Database& db = Database::getInstance();
+
+  save.guid = player->getGUID();
+  save.name = player->getName();
+  save.updateLogin.bind(player->lastLoginSaved).bind(player->lastIP).bind(player->getGUID());
 
   //First, an UPDATE query to write the player itself
-  query.str(std::string());
-  query << "UPDATE `players` SET ";
-  query << "`level` = " << player->level << ',';
-  query << "`group_id` = " << player->group->id << ',';
-  query << "`vocation` = " << player->getVocationId() << ',';
-  query << "`health` = " << player->health << ',';
-  query << "`healthmax` = " << player->healthMax << ',';
-  query << "`experience` = " << player->experience << ',';
-  query << "`lookbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookBody) << ',';
-  query << "`lookfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookFeet) << ',';
-  query << "`lookhead` = " << static_cast<uint32_t>(player->defaultOutfit.lookHead) << ',';
-  query << "`looklegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookLegs) << ',';
-  query << "`looktype` = " << player->defaultOutfit.lookType << ',';
-  query << "`lookaddons` = " << static_cast<uint32_t>(player->defaultOutfit.lookAddons) << ',';
-  query << "`lookmountbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountBody) << ',';
-  query << "`lookmountfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountFeet) << ',';
-  query << "`lookmounthead` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountHead) << ',';
-  query << "`lookmountlegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountLegs) << ',';
-  query << "`lookfamiliarstype` = " << player->defaultOutfit.lookFamiliarsType << ',';
-  query << "`isreward` = " << static_cast<uint16_t>(player->isDailyReward) << ',';
-  query << "`maglevel` = " << player->magLevel << ',';
-  query << "`mana` = " << player->mana << ',';
-  query << "`manamax` = " << player->manaMax << ',';
-  query << "`manaspent` = " << player->manaSpent << ',';
-  query << "`soul` = " << static_cast<uint16_t>(player->soul) << ',';
-  query << "`town_id` = " << player->town->getID() << ',';
+  DBStatement update("UPDATE `players` SET `level` = ?, `group_id` = ?, `vocation` = ?, `health` = ?, `healthmax` = ?, `experience` = ?, "
+    "`lookbody` = ?, `lookfeet` = ?, `lookhead` = ?, `looklegs` = ?, `looktype` = ?, `lookaddons` = ?, "
+    "`lookmountbody` = ?, `lookmountfeet` = ?, `lookmounthead` = ?, `lookmountlegs` = ?, `lookfamiliarstype` = ?, "
+    "`isreward` = ?, `maglevel` = ?, `mana` = ?, `manamax` = ?, `manaspent` = ?, `soul` = ?, `town_id` = ?, "
+    "`posx` = ?, `posy` = ?, `posz` = ?, "
+    "`prey_wildcard` = ?, `task_points` = ?, `forge_dusts` = ?, `forge_dust_level` = ?, `randomize_mount` = ?, "
+    "`cap` = ?, `sex` = ?");
+  update.bind(player->level).bind(player->group->id).bind(player->getVocationId());
+  update.bind(player->health).bind(player->healthMax).bind(player->experience);
+  update.bind(player->defaultOutfit.lookBody).bind(player->defaultOutfit.lookFeet);
+  update.bind(player->defaultOutfit.lookHead).bind(player->defaultOutfit.lookLegs);
+  update.bind(player->defaultOutfit.lookType).bind(player->defaultOutfit.lookAddons);
+  update.bind(player->defaultOutfit.lookMountBody).bind(player->defaultOutfit.lookMountFeet);
+  update.bind(player->defaultOutfit.lookMountHead).bind(player->defaultOutfit.lookMountLegs);
+  update.bind(player->defaultOutfit.lookFamiliarsType);
+  update.bind(player->isDailyReward).bind(player->magLevel).bind(player->mana).bind(player->manaMax);
+  update.bind(player->manaSpent).bind(player->soul).bind(player->town->getID());
 
   const Position& loginPosition = player->getLoginPosition();
-  query << "`posx` = " << loginPosition.getX() << ',';
-  query << "`posy` = " << loginPosition.getY() << ',';
-  query << "`posz` = " << loginPosition.getZ() << ',';
+  update.bind(loginPosition.getX()).bind(loginPosition.getY()).bind(loginPosition.getZ());
 
-  query << "`prey_wildcard` = " << player->getPreyCards() << ',';
-  query << "`task_points` = " << player->getTaskHuntingPoints() << ',';
-  query << "`forge_dusts` = " << player->getForgeDusts() << ',';
-  query << "`forge_dust_level` = " << player->getForgeDustLevel() << ',';
-  query << "`randomize_mount` = " << static_cast<uint16_t>(player->isRandomMounted()) << ',';
+  update.bind(player->getPreyCards()).bind(player->getTaskHuntingPoints());
+  update.bind(player->getForgeDusts()).bind(player->getForgeDustLevel());
+  update.bind(player->isRandomMounted());
 
-  query << "`cap` = " << (player->capacity / 100) << ',';
-  query << "`sex` = " << static_cast<uint16_t>(player->sex) << ',';
+  update.bind(player->capacity / 100).bind(player->sex);
 
   if (player->lastLoginSaved != 0) {
-    query << "`lastlogin` = " << player->lastLoginSaved << ',';
+    update.append(", `lastlogin` = ?").bind(player->lastLoginSaved);
   }
 
   if (player->lastIP != 0) {
-    query << "`lastip` = " << player->lastIP << ',';
+    update.append(", `lastip` = ?").bind(player->lastIP);
   }
 
   //serialize conditions
@@ -917,7 +1136,7 @@ bool IOLoginData::savePlayer(Player* player)
   size_t attributesSize;
   const char* attributes = propWriteStream.getStream(attributesSize);
 
-  query << "`conditions` = " << db.escapeBlob(attributes, attributesSize) << ',';
+  update.append(", `conditions` = ?").bindBlob(attributes, attributesSize);
 
   if (g_game().getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
     int64_t skullTime = 0;
@@ -926,138 +1145,113 @@ bool IOLoginData::savePlayer(Player* player)
       skullTime = time(nullptr) + player->skullTicks;
     }
 
-    query << "`skulltime` = " << skullTime << ',';
-
     Skulls_t skull = SKULL_NONE;
     if (player->skull == SKULL_RED) {
       skull = SKULL_RED;
     } else if (player->skull == SKULL_BLACK) {
       skull = SKULL_BLACK;
     }
-    query << "`skull` = " << static_cast<int64_t>(skull) << ',';
-  }
-
-  query << "`lastlogout` = " << player->getLastLogout() << ',';
-  query << "`balance` = " << player->bankBalance << ',';
-  query << "`offlinetraining_time` = " << player->getOfflineTrainingTime() / 1000 << ',';
-  query << "`offlinetraining_skill` = " << std::to_string(player->getOfflineTrainingSkill()) << ',';
-  query << "`stamina` = " << player->getStaminaMinutes() << ',';
-  query << "`skill_fist` = " << player->skills[SKILL_FIST].level << ',';
-  query << "`skill_fist_tries` = " << player->skills[SKILL_FIST].tries << ',';
-  query << "`skill_club` = " << player->skills[SKILL_CLUB].level << ',';
-  query << "`skill_club_tries` = " << player->skills[SKILL_CLUB].tries << ',';
-  query << "`skill_sword` = " << player->skills[SKILL_SWORD].level << ',';
-  query << "`skill_sword_tries` = " << player->skills[SKILL_SWORD].tries << ',';
-  query << "`skill_axe` = " << player->skills[SKILL_AXE].level << ',';
-  query << "`skill_axe_tries` = " << player->skills[SKILL_AXE].tries << ',';
-  query << "`skill_dist` = " << player->skills[SKILL_DISTANCE].level << ',';
-  query << "`skill_dist_tries` = " << player->skills[SKILL_DISTANCE].tries << ',';
-  query << "`skill_shielding` = " << player->skills[SKILL_SHIELD].level << ',';
-  query << "`skill_shielding_tries` = " << player->skills[SKILL_SHIELD].tries << ',';
-  query << "`skill_fishing` = " << player->skills[SKILL_FISHING].level << ',';
-  query << "`skill_fishing_tries` = " << player->skills[SKILL_FISHING].tries << ',';
-  query << "`skill_critical_hit_chance` = " << player->skills[SKILL_CRITICAL_HIT_CHANCE].level << ',';
-  query << "`skill_critical_hit_chance_tries` = " << player->skills[SKILL_CRITICAL_HIT_CHANCE].tries << ',';
-  query << "`skill_critical_hit_damage` = " << player->skills[SKILL_CRITICAL_HIT_DAMAGE].level << ',';
-  query << "`skill_critical_hit_damage_tries` = " << player->skills[SKILL_CRITICAL_HIT_DAMAGE].tries << ',';
-  query << "`skill_life_leech_chance` = " << player->skills[SKILL_LIFE_LEECH_CHANCE].level << ',';
-  query << "`skill_life_leech_chance_tries` = " << player->skills[SKILL_LIFE_LEECH_CHANCE].tries << ',';
-  query << "`skill_life_leech_amount` = " << player->skills[SKILL_LIFE_LEECH_AMOUNT].level << ',';
-  query << "`skill_life_leech_amount_tries` = " << player->skills[SKILL_LIFE_LEECH_AMOUNT].tries << ',';
-  query << "`skill_mana_leech_chance` = " << player->skills[SKILL_MANA_LEECH_CHANCE].level << ',';
-  query << "`skill_mana_leech_chance_tries` = " << player->skills[SKILL_MANA_LEECH_CHANCE].tries << ',';
-  query << "`skill_mana_leech_amount` = " << player->skills[SKILL_MANA_LEECH_AMOUNT].level << ',';
-  query << "`skill_mana_leech_amount_tries` = " << player->skills[SKILL_MANA_LEECH_AMOUNT].tries << ',';
-  query << "`manashield` = " << player->getManaShield() << ',';
-  query << "`max_manashield` = " << player->getMaxManaShield() << ',';
-  query << "`xpboost_value` = " << player->getStoreXpBoost() << ',';
-  query << "`xpboost_stamina` = " << player->getExpBoostStamina() << ',';
-  query << "`quickloot_fallback` = " << (player->quickLootFallbackToMainContainer ? 1 : 0) << ',';
+    update.append(", `skulltime` = ?, `skull` = ?").bind(skullTime).bind(skull);
+  }
+
+  update.append(", `lastlogout` = ?, `balance` = ?, `offlinetraining_time` = ?, `offlinetraining_skill` = ?, `stamina` = ?, "
+    "`skill_fist` = ?, `skill_fist_tries` = ?, `skill_club` = ?, `skill_club_tries` = ?, "
+    "`skill_sword` = ?, `skill_sword_tries` = ?, `skill_axe` = ?, `skill_axe_tries` = ?, "
+    "`skill_dist` = ?, `skill_dist_tries` = ?, `skill_shielding` = ?, `skill_shielding_tries` = ?, "
+    "`skill_fishing` = ?, `skill_fishing_tries` = ?, "
+    "`skill_critical_hit_chance` = ?, `skill_critical_hit_chance_tries` = ?, "
+    "`skill_critical_hit_damage` = ?, `skill_critical_hit_damage_tries` = ?, "
+    "`skill_life_leech_chance` = ?, `skill_life_leech_chance_tries` = ?, "
+    "`skill_life_leech_amount` = ?, `skill_life_leech_amount_tries` = ?, "
+    "`skill_mana_leech_chance` = ?, `skill_mana_leech_chance_tries` = ?, "
+    "`skill_mana_leech_amount` = ?, `skill_mana_leech_amount_tries` = ?, "
+    "`manashield` = ?, `max_manashield` = ?, `xpboost_value` = ?, `xpboost_stamina` = ?, `quickloot_fallback` = ?");
+  update.bind(player->getLastLogout()).bind(player->bankBalance);
+  update.bind(player->getOfflineTrainingTime() / 1000).bind(player->getOfflineTrainingSkill());
+  update.bind(player->getStaminaMinutes());
+  for (skills_t skill : { SKILL_FIST, SKILL_CLUB, SKILL_SWORD, SKILL_AXE, SKILL_DISTANCE, SKILL_SHIELD, SKILL_FISHING,
+                          SKILL_CRITICAL_HIT_CHANCE, SKILL_CRITICAL_HIT_DAMAGE, SKILL_LIFE_LEECH_CHANCE, SKILL_LIFE_LEECH_AMOUNT,
+                          SKILL_MANA_LEECH_CHANCE, SKILL_MANA_LEECH_AMOUNT }) {
+    update.bind(player->skills[skill].level).bind(player->skills[skill].tries);
+  }
+  update.bind(player->getManaShield()).bind(player->getMaxManaShield());
+  update.bind(player->getStoreXpBoost()).bind(player->getExpBoostStamina());
+  update.bind(player->quickLootFallbackToMainContainer);
 
   if (!player->isOffline()) {
-    query << "`onlinetime` = `onlinetime` + " << (time(nullptr) - player->lastLoginSaved) << ',';
-  }
-  for (int i = 1; i <= 8; i++) {
-    query << "`blessings" << i << "`" << " = " << static_cast<uint32_t>(player->getBlessingCount(i)) << ((i == 8) ? ' ' : ',');
+    update.append(", `onlinetime` = `onlinetime` + ?").bind(time(nullptr) - player->lastLoginSaved);
   }
-  query << " WHERE `id` = " << player->getGUID();
 
-  DBTransaction transaction;
-  if (!transaction.begin()) {
-    return false;
+  update.append(", `blessings1` = ?, `blessings2` = ?, `blessings3` = ?, `blessings4` = ?, `blessings5` = ?, `blessings6` = ?, `blessings7` = ?, `blessings8` = ?");
+  for (uint8_t i = 1; i <= 8; i++) {
+    update.bind(player->getBlessingCount(i));
   }
+  update.append(" WHERE `id` = ?").bind(player->getGUID());
 
-  if (!db.executeQuery(query.str())) {
-    return false;
-  }
+  save.batch.add(std::move(update));
+
+  const uint32_t guid = save.guid;
+  PlayerSavedRows& savedRows = save.savedRows;
+  // The players row
+  uint64_t& rowsWritten = save.rows;
+  rowsWritten = 1;
 
   // Stash save items
-  query.str(std::string());
-  query << "DELETE FROM `player_stash` WHERE `player_id` = " << player->getGUID();
-  db.executeQuery(query.str());
-  for (auto it : player->getStashItems()) {
-	query.str(std::string());
-    query << "INSERT INTO `player_stash` (`player_id`,`item_id`,`item_count`) VALUES (";
-    query << player->getGUID() << ", ";
-    query << it.first << ", ";
-    query << it.second << ")";
-	db.executeQuery(query.str());
+  PlayerRows& stashRows = savedRows.stash.emplace();
+  for (const auto& [itemId, itemCount] : player->getStashItems()) {
+    stashRows[std::to_string(itemId)] = fmt::format("{},{}", itemId, itemCount);
   }
 
+  saveRows("player_stash", "item_id", "`item_id`, `item_count`", guid, save.batch, player->savedRows.stash, stashRows, rowsWritten);
+
   // learned spells
-  query.str(std::string());
-  query << "DELETE FROM `player_spells` WHERE `player_id` = " << player->getGUID();
-  if (!db.executeQuery(query.str())) {
-    return false;
+  PlayerRows& spellRows = savedRows.spells.emplace();
+  for (const std::string& spellName : player->learnedInstantSpellList) {
+    std::string escapedName = db.escapeString(spellName);
+    spellRows[escapedName] = escapedName;
   }
 
-  query.str(std::string());
+  saveRows("player_spells", "name", "`name`", guid, save.batch, player->savedRows.spells, spellRows, rowsWritten);
 
-  DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ");
-  for (const std::string& spellName : player->learnedInstantSpellList) {
-    query << player->getGUID() << ',' << db.escapeString(spellName);
-    if (!spellsQuery.addRow(query)) {
-      return false;
-    }
+  //player kills, few rows without a key of their own: rewritten when any changed
+  std::string& kills = savedRows.kills.emplace();
+  for (const auto& kill : player->unjustifiedKills) {
+    kills += fmt::format("({},{},{})", kill.target, kill.time, kill.unavenged);
   }
 
-  if (!spellsQuery.execute()) {
-    return false;
-  }
+  if (player->savedRows.kills != kills) {
+    DBStatement deleteKills("DELETE FROM `player_kills` WHERE `player_id` = ?");
+    deleteKills.bind(guid);
+    save.batch.add(std::move(deleteKills));
 
-  //player kills
-  query.str(std::string());
-  query << "DELETE FROM `player_kills` WHERE `player_id` = " << player->getGUID();
-  if (!db.executeQuery(query.str())) {
-    return false;
+    std::ostringstream query;
+    DBInsert killsQuery("INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES", save.batch);
+    for (const auto& kill : player->unjustifiedKills) {
+      query << guid << ',' << kill.target << ',' << kill.time << ',' << kill.unavenged;
+      killsQuery.addRow(query);
+      ++rowsWritten;
+    }
+    killsQuery.execute();
   }
 
   //player bestiary charms
-  query.str(std::string());
-  query << "UPDATE `player_charms` SET ";
-  query << "`charm_points` = " << player->charmPoints << ',';
-  query << "`charm_expansion` = " << ((player->charmExpansion) ? 1 : 0) << ',';
-  query << "`rune_wound` = " << player->charmRuneWound << ',';
-  query << "`rune_enflame` = " << player->charmRuneEnflame << ',';
-  query << "`rune_poison` = " << player->charmRunePoison << ',';
-  query << "`rune_freeze` = " << player->charmRuneFreeze << ',';
-  query << "`rune_zap` = " << player->charmRuneZap << ',';
-  query << "`rune_curse` = " << player->charmRuneCurse << ',';
-  query << "`rune_cripple` = " << player->charmRuneCripple << ',';
-  query << "`rune_parry` = " << player->charmRuneParry << ',';
-  query << "`rune_dodge` = " << player->charmRuneDodge << ',';
-  query << "`rune_adrenaline` = " << player->charmRuneAdrenaline << ',';
-  query << "`rune_numb` = " << player->charmRuneNumb << ',';
-  query << "`rune_cleanse` = " << player->charmRuneCleanse << ',';
-  query << "`rune_bless` = " << player->charmRuneBless << ',';
-  query << "`rune_scavenge` = " << player->charmRuneScavenge << ',';
-  query << "`rune_gut` = " << player->charmRuneGut << ',';
-  query << "`rune_low_blow` = " << player->charmRuneLowBlow << ',';
-  query << "`rune_divine` = " << player->charmRuneDivine << ',';
-  query << "`rune_vamp` = " << player->charmRuneVamp << ',';
-  query << "`rune_void` = " << player->charmRuneVoid << ',';
-  query << "`UsedRunesBit` = " << player->UsedRunesBit << ',';
-  query << "`UnlockedRunesBit` = " << player->UnlockedRunesBit << ',';
+  DBStatement updateCharms("UPDATE `player_charms` SET `charm_points` = ?, `charm_expansion` = ?, "
+    "`rune_wound` = ?, `rune_enflame` = ?, `rune_poison` = ?, `rune_freeze` = ?, `rune_zap` = ?, `rune_curse` = ?, "
+    "`rune_cripple` = ?, `rune_parry` = ?, `rune_dodge` = ?, `rune_adrenaline` = ?, `rune_numb` = ?, `rune_cleanse` = ?, "
+    "`rune_bless` = ?, `rune_scavenge` = ?, `rune_gut` = ?, `rune_low_blow` = ?, `rune_divine` = ?, `rune_vamp` = ?, "
+    "`rune_void` = ?, `UsedRunesBit` = ?, `UnlockedRunesBit` = ?, `tracker list` = ? WHERE `player_guid` = ?");
+  std::string& charms = savedRows.charms.emplace();
+  for (int64_t value : { int64_t(player->charmPoints), int64_t(player->charmExpansion),
+                         int64_t(player->charmRuneWound), int64_t(player->charmRuneEnflame), int64_t(player->charmRunePoison),
+                         int64_t(player->charmRuneFreeze), int64_t(player->charmRuneZap), int64_t(player->charmRuneCurse),
+                         int64_t(player->charmRuneCripple), int64_t(player->charmRuneParry), int64_t(player->charmRuneDodge),
+                         int64_t(player->charmRuneAdrenaline), int64_t(player->charmRuneNumb), int64_t(player->charmRuneCleanse),
+                         int64_t(player->charmRuneBless), int64_t(player->charmRuneScavenge), int64_t(player->charmRuneGut),
+                         int64_t(player->charmRuneLowBlow), int64_t(player->charmRuneDivine), int64_t(player->charmRuneVamp),
+                         int64_t(player->charmRuneVoid), int64_t(player->UsedRunesBit), int64_t(player->UnlockedRunesBit) }) {
+    updateCharms.bind(value);
+    charms += fmt::format("{},", value);
+  }
 
   // Bestiary tracker
   PropWriteStream propBestiaryStream;
@@ -1066,37 +1260,15 @@ bool IOLoginData::savePlayer(Player* player)
   }
   size_t trackerSize;
   const char* trackerList = propBestiaryStream.getStream(trackerSize);
-  query << " `tracker list` = " << db.escapeBlob(trackerList, trackerSize);
-  query << " WHERE `player_guid` = " << player->getGUID();
+  updateCharms.bindBlob(trackerList, trackerSize).bind(guid);
+  charms.append(trackerList, trackerSize);
 
-  if (!db.executeQuery(query.str())) {
-    SPDLOG_WARN("[IOLoginData::savePlayer] - Error saving bestiary data from player: {}", player->getName());
-    return false;
-  }
-
-  query.str(std::string());
-
-  DBInsert killsQuery("INSERT INTO `player_kills` (`player_id`, `target`, `time`, `unavenged`) VALUES");
-  for (const auto& kill : player->unjustifiedKills) {
-    query << player->getGUID() << ',' << kill.target << ',' << kill.time << ',' << kill.unavenged;
-    if (!killsQuery.addRow(query)) {
-      return false;
-    }
-  }
-
-  if (!killsQuery.execute()) {
-    return false;
+  if (player->savedRows.charms != charms) {
+    save.batch.add(std::move(updateCharms));
+    ++rowsWritten;
   }
 
   //item saving
-  query << "DELETE FROM `player_items` WHERE `player_id` = " << player->getGUID();
-  if (!db.executeQuery(query.str())) {
-    SPDLOG_WARN("[IOLoginData::savePlayer] - Error delete query 'player_items' from player: {}", player->getName());
-    return false;
-  }
-
-  DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
   ItemBlockList itemList;
   for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
     Item* item = player->inventory[slotId];
@@ -1105,21 +1277,12 @@ bool IOLoginData::savePlayer(Player* player)
     }
   }
 
-  if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
-    SPDLOG_WARN("[IOLoginData::savePlayer] - Failed for save items from player: {}", player->getName());
-    return false;
-  }
+  PlayerRows& itemRows = savedRows.items.emplace();
+  saveItems(player, itemList, itemRows, propWriteStream);
+  saveRows("player_items", "sid", ITEM_COLUMNS, guid, save.batch, player->savedRows.items, itemRows, rowsWritten);
 
   if (player->lastDepotId != -1) {
     //save depot items
-    query.str(std::string());
-    query << "DELETE FROM `player_depotitems` WHERE `player_id` = " << player->getGUID();
-
-    if (!db.executeQuery(query.str())) {
-      return false;
-    }
-
-    DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
     itemList.clear();
 
     for (const auto& it : player->depotChests) {
@@ -1129,82 +1292,46 @@ bool IOLoginData::savePlayer(Player* player)
       }
     }
 
-    if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-      return false;
-    }
+    PlayerRows& depotRows = savedRows.depotItems.emplace();
+    saveItems(player, itemList, depotRows, propWriteStream);
+    saveRows("player_depotitems", "sid", ITEM_COLUMNS, guid, save.batch, player->savedRows.depotItems, depotRows, rowsWritten);
   }
 
   //save reward items
-  query.str(std::string());
-  query << "DELETE FROM `player_rewards` WHERE `player_id` = " << player->getGUID();
-
-  if (!db.executeQuery(query.str())) {
-    return false;
-  }
-
   std::vector<uint32_t> rewardList;
   player->getRewardList(rewardList);
 
-  if (!rewardList.empty()) {
-    DBInsert rewardQuery("INSERT INTO `player_rewards` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-    itemList.clear();
-
-    int running = 0;
-    for (const auto& rewardId : rewardList) {
-      Reward* reward = player->getReward(rewardId, false);
-      // rewards that are empty or older than 7 days aren't stored
-      if (!reward->empty() && (time(nullptr) - rewardId <= 60 * 60 * 24 * 7)) {
-        itemList.emplace_back(++running, reward);
-      }
-    }
-
-    if (!saveItems(player, itemList, rewardQuery, propWriteStream)) {
-      return false;
+  itemList.clear();
+  int running = 0;
+  for (const auto& rewardId : rewardList) {
+    Reward* reward = player->getReward(rewardId, false);
+    // rewards that are empty or older than 7 days aren't stored
+    if (!reward->empty() && (time(nullptr) - rewardId <= 60 * 60 * 24 * 7)) {
+      itemList.emplace_back(++running, reward);
     }
   }
 
-  //save inbox items
-  query.str(std::string());
-  query << "DELETE FROM `player_inboxitems` WHERE `player_id` = " << player->getGUID();
-  if (!db.executeQuery(query.str())) {
-    return false;
-  }
+  PlayerRows& rewardRows = savedRows.rewardItems.emplace();
+  saveItems(player, itemList, rewardRows, propWriteStream);
+  saveRows("player_rewards", "sid", ITEM_COLUMNS, guid, save.batch, player->savedRows.rewardItems, rewardRows, rowsWritten);
 
-  DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
+  //save inbox items
   itemList.clear();
 
   for (Item* item : player->getInbox()->getItemList()) {
     itemList.emplace_back(0, item);
   }
 
-  if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-    return false;
-  }
+  PlayerRows& inboxRows = savedRows.inboxItems.emplace();
+  saveItems(player, itemList, inboxRows, propWriteStream);
+  saveRows("player_inboxitems", "sid", ITEM_COLUMNS, guid, save.batch, player->savedRows.inboxItems, inboxRows, rowsWritten);
 
   // Save prey class
   if (g_configManager().getBoolean(PREY_ENABLED)) {
-    query.str(std::string());
-    query << "DELETE FROM `player_prey` WHERE `player_id` = " << player->getGUID();
-    if (!db.executeQuery(query.str())) {
-      return false;
-    }
-
+    PlayerRows& preyRows = savedRows.prey.emplace();
     for (uint8_t slotId = PreySlot_First; slotId <= PreySlot_Last; slotId++) {
       PreySlot* slot = player->getPreySlotById(static_cast<PreySlot_t>(slotId));
       if (slot) {
-        query.str(std::string());
-        query << "INSERT INTO `player_prey` (`player_id`, `slot`, `state`, `raceid`, `option`, `bonus_type`, `bonus_rarity`, `bonus_percentage`, `bonus_time`, `free_reroll`, `monster_list`) VALUES (";
-          query << player->getGUID() << ", ";
-          query << static_cast<uint16_t>(slot->id) << ", ";
-          query << static_cast<uint16_t>(slot->state) << ", ";
-          query << slot->selectedRaceId << ", ";
-          query << static_cast<uint16_t>(slot->option) << ", ";
-          query << static_cast<uint16_t>(slot->bonus) << ", ";
-          query << static_cast<uint16_t>(slot->bonusRarity) << ", ";
-          query << slot->bonusPercentage << ", ";
-          query << slot->bonusTimeLeft << ", ";
-          query << slot->freeRerollTimeStamp << ", ";
-
         PropWriteStream propPreyStream;
         std::for_each(slot->raceIdList.begin(), slot->raceIdList.end(), [&propPreyStream](uint16_t raceId)
         {
@@ -1213,39 +1340,22 @@ bool IOLoginData::savePlayer(Player* player)
 
         size_t preySize;
         const char* preyList = propPreyStream.getStream(preySize);
-        query << db.escapeBlob(preyList, static_cast<uint32_t>(preySize)) << ")";
-
-        if (!db.executeQuery(query.str())) {
-          SPDLOG_WARN("[IOLoginData::savePlayer] - Error saving prey slot data from player: {}", player->getName());
-          return false;
-        }
+        preyRows[std::to_string(slotId)] = fmt::format("{},{},{},{},{},{},{},{},{},{}",
+          static_cast<uint16_t>(slot->id), static_cast<uint16_t>(slot->state), slot->selectedRaceId,
+          static_cast<uint16_t>(slot->option), static_cast<uint16_t>(slot->bonus), static_cast<uint16_t>(slot->bonusRarity),
+          slot->bonusPercentage, slot->bonusTimeLeft, slot->freeRerollTimeStamp, db.escapeBlob(preyList, preySize));
       }
     }
+
+    saveRows("player_prey", "slot", "`slot`, `state`, `raceid`, `option`, `bonus_type`, `bonus_rarity`, `bonus_percentage`, `bonus_time`, `free_reroll`, `monster_list`", guid, save.batch, player->savedRows.prey, preyRows, rowsWritten);
   }
 
   // Save task hunting class
   if (g_configManager().getBoolean(TASK_HUNTING_ENABLED)) {
-    query.str(std::string());
-    query << "DELETE FROM `player_taskhunt` WHERE `player_id` = " << player->getGUID();
-    if (!db.executeQuery(query.str())) {
-      return false;
-    }
-
+    PlayerRows& taskHuntRows = savedRows.taskHunt.emplace();
     for (uint8_t slotId = PreySlot_First; slotId <= PreySlot_Last; slotId++) {
       TaskHuntingSlot* slot = player->getTaskHuntingSlotById(static_cast<PreySlot_t>(slotId));
       if (slot) {
-        query.str(std::string());
-        query << "INSERT INTO `player_taskhunt` (`player_id`, `slot`, `state`, `raceid`, `upgrade`, `rarity`, `kills`, `disabled_time`, `free_reroll`, `monster_list`) VALUES (";
-          query << player->getGUID() << ", ";
-          query << static_cast<uint16_t>(slot->id) << ", ";
-          query << static_cast<uint16_t>(slot->state) << ", ";
-          query << slot->selectedRaceId << ", ";
-          query << (slot->upgrade ? 1 : 0) << ", ";
-          query << static_cast<uint16_t>(slot->rarity) << ", ";
-          query << slot->currentKills << ", ";
-          query << slot->disabledUntilTimeStamp << ", ";
-          query << slot->freeRerollTimeStamp << ", ";
-
         PropWriteStream propTaskHuntingStream;
         std::for_each(slot->raceIdList.begin(), slot->raceIdList.end(), [&propTaskHuntingStream](uint16_t raceId)
         {
@@ -1254,42 +1364,42 @@ bool IOLoginData::savePlayer(Player* player)
 
         size_t taskHuntingSize;
         const char* taskHuntingList = propTaskHuntingStream.getStream(taskHuntingSize);
-        query << db.escapeBlob(taskHuntingList, static_cast<uint32_t>(taskHuntingSize)) << ")";
-
-        if (!db.executeQuery(query.str())) {
-          SPDLOG_WARN("[IOLoginData::savePlayer] - Error saving task hunting slot data from player: {}", player->getName());
-          return false;
-        }
+        taskHuntRows[std::to_string(slotId)] = fmt::format("{},{},{},{},{},{},{},{},{}",
+          static_cast<uint16_t>(slot->id), static_cast<uint16_t>(slot->state), slot->selectedRaceId,
+          static_cast<uint16_t>(slot->upgrade), static_cast<uint16_t>(slot->rarity), slot->currentKills,
+          slot->disabledUntilTimeStamp, slot->freeRerollTimeStamp, db.escapeBlob(taskHuntingList, taskHuntingSize));
       }
     }
-  }
 
-  IOLoginDataSave::savePlayerForgeHistory(player);
-
-  query.str(std::string());
-  query << "DELETE FROM `player_storage` WHERE `player_id` = " << player->getGUID();
-  if (!db.executeQuery(query.str())) {
-    return false;
+    saveRows("player_taskhunt", "slot", "`slot`, `state`, `raceid`, `upgrade`, `rarity`, `kills`, `disabled_time`, `free_reroll`, `monster_list`", guid, save.batch, player->savedRows.taskHunt, taskHuntRows, rowsWritten);
   }
 
-  query.str(std::string());
+  IOLoginDataSave::savePlayerForgeHistory(player, save.batch);
 
-  DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
   player->genReservedStorageRange();
 
-  for (const auto& it : player->storageMap) {
-    query << player->getGUID() << ',' << it.first << ',' << it.second;
-    if (!storageQuery.addRow(query)) {
-      return false;
-    }
+  PlayerRows& storageRows = savedRows.storage.emplace();
+  for (const auto& [key, value] : player->storageMap) {
+    storageRows[std::to_string(key)] = fmt::format("{},{}", key, value);
   }
 
-  if (!storageQuery.execute()) {
-    return false;
-  }
+  saveRows("player_storage", "key", "`key`, `value`", guid, save.batch, player->savedRows.storage, storageRows, rowsWritten);
+}
+
+uint64_t IOLoginData::getSaveSequence()
+{
+  return saveSequence;
+}
+
+bool IOLoginData::hasSavedSince(uint32_t guid, uint64_t sequence)
+{
+  auto it = lastSaves.find(guid);
+  return it != lastSaves.end() && it->second > sequence;
+}
 
-  //End the transaction
-  return transaction.commit();
+PlayerSaveStats IOLoginData::getSaveStats()
+{
+  return saveStats;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid)
@@ -1353,16 +1463,23 @@ bool IOLoginData::formatPlayerName(std::string& name)
   return true;
 }
 
-void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result, Player &player)
+void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result, Player &player, PlayerRows& rows)
 {
+  Database& db = Database::getInstance();
+  const auto sidColumn = result->getColumn("sid");
+  const auto pidColumn = result->getColumn("pid");
+  const auto typeColumn = result->getColumn("itemtype");
+  const auto countColumn = result->getColumn("count");
+  const auto attributesColumn = result->getColumn("attributes");
   do {
-    uint32_t sid = result->getNumber<uint32_t>("sid");
-    uint32_t pid = result->getNumber<uint32_t>("pid");
-    uint16_t type = result->getNumber<uint16_t>("itemtype");
-    uint16_t count = result->getNumber<uint16_t>("count");
+    uint32_t sid = result->getNumber<uint32_t>(sidColumn);
+    uint32_t pid = result->getNumber<uint32_t>(pidColumn);
+    uint16_t type = result->getNumber<uint16_t>(typeColumn);
+    uint16_t count = result->getNumber<uint16_t>(countColumn);
 
     unsigned long attrSize;
-    const char* attr = result->getStream("attributes", attrSize);
+    const char* attr = result->getStream(attributesColumn, attrSize);
+    rows[std::to_string(sid)] = fmt::format("{},{},{},{},{}", pid, sid, type, count, db.escapeBlob(attr, attrSize));
 
     PropStream propStream;
     propStream.init(attr, attrSize);
@@ -1371,7 +1488,8 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result, Player &playe
     if (item) {
       if (!item->unserializeAttr(propStream)) {
         SPDLOG_WARN("[IOLoginData::loadItems] - Failed to unserialize attributes of item {}, of player {}, from account id {}", item->getID(), player.getName(), player.getAccount());
-        savePlayer(&player);
+        // Stale row, the next save rewrites the item without them
+        rows[std::to_string(sid)].clear();
       }
 
       std::pair<Item*, uint32_t> pair(item, pid);
@@ -1400,10 +1518,10 @@ std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId)
 {
   std::forward_list<VIPEntry> entries;
 
-  std::ostringstream query;
-  query << "SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = " << accountId;
+  DBStatement statement("SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = ?");
+  statement.bind(accountId);
 
-  DBResult_ptr result = Database::getInstance().storeQuery(query.str());
+  DBResult_ptr result = Database::getInstance().storeQuery(statement);
   if (result) {
     do {
       entries.emplace_front(
@@ -1420,27 +1538,22 @@ std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId)
 
 void IOLoginData::addVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon, bool notify)
 {
-  Database& db = Database::getInstance();
-
-  std::ostringstream query;
-  query << "INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES (" << accountId << ',' << guid << ',' << db.escapeString(description) << ',' << icon << ',' << notify << ')';
-  db.executeQuery(query.str());
+  // Adding and editing are the same upsert, so both batch together
+  editVIPEntry(accountId, guid, description, icon, notify);
 }
 
 void IOLoginData::editVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon, bool notify)
 {
-  Database& db = Database::getInstance();
-
-  std::ostringstream query;
-  query << "UPDATE `account_viplist` SET `description` = " << db.escapeString(description) << ", `icon` = " << icon << ", `notify` = " << notify << " WHERE `account_id` = " << accountId << " AND `player_id` = " << guid;
-  db.executeQuery(query.str());
+  g_databaseTasks().addRow(
+    "INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES ",
+    fmt::format("{},{},{},{},{}", accountId, guid, Database::getInstance().escapeString(description), icon, notify ? 1 : 0),
+    "ON DUPLICATE KEY UPDATE `description` = VALUES(`description`), `icon` = VALUES(`icon`), `notify` = VALUES(`notify`)"
+  );
 }
 
 void IOLoginData::removeVIPEntry(uint32_t accountId, uint32_t guid)
 {
-  std::ostringstream query;
-  query << "DELETE FROM `account_viplist` WHERE `account_id` = " << accountId << " AND `player_id` = " << guid;
-  Database::getInstance().executeQuery(query.str());
+  g_databaseTasks().addTask(fmt::format("DELETE FROM `account_viplist` WHERE `account_id` = {} AND `player_id` = {}", accountId, guid));
 }
 
 void IOLoginData::addPremiumDays(uint32_t accountId, int32_t addDays)
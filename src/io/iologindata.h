@@ -16,6 +16,62 @@
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+/**
+ * Every row a player is built from. Fetching only runs queries, so it can be
+ * done away from the dispatcher; building the player from the rows cannot.
+ */
+struct PlayerLoadData {
+	DBResult_ptr player;
+	DBResult_ptr account;
+	DBResult_ptr guildMembership;
+	DBResult_ptr guildRank;
+	DBResult_ptr guildMemberCount;
+	GuildWarVector guildWars;
+	DBResult_ptr stash;
+	DBResult_ptr charms;
+	DBResult_ptr spells;
+	DBResult_ptr kills;
+	DBResult_ptr items;
+	DBResult_ptr depotItems;
+	DBResult_ptr rewardItems;
+	DBResult_ptr inboxItems;
+	DBResult_ptr storage;
+	DBResult_ptr vip;
+	DBResult_ptr prey;
+	DBResult_ptr forgeHistory;
+	DBResult_ptr taskHunt;
+};
+
+enum PlayerSaveResult_t : uint8_t {
+	PLAYER_SAVE_FAILED,
+	// The player has its `save` flag off, only its last login was written
+	PLAYER_SAVE_LOGIN,
+	PLAYER_SAVE_DONE,
+};
+
+/**
+ * A player save serialized on the dispatcher. Writing it only runs queries,
+ * so it can be done by another thread while the game goes on.
+ */
+struct PlayerSave {
+	uint32_t guid = 0;
+	std::string name;
+	DBStatement updateLogin { "UPDATE `players` SET `lastlogin` = ?, `lastip` = ? WHERE `id` = ?" };
+	DBBatch batch;
+	// What the tables hold once the batch is written
+	PlayerSavedRows savedRows;
+	uint64_t rows = 0;
+
+	PlayerSaveResult_t write() const;
+};
+
+// Rows written by the player saves, inserted ones and deleted keys
+struct PlayerSaveStats {
+	uint64_t saves = 0;
+	uint64_t rows = 0;
+	uint64_t lastRows = 0;
+};
+
 class IOLoginData
 {
 	public:
@@ -29,12 +85,29 @@ class IOLoginData
 		static account::AccountType getAccountType(uint32_t accountId);
 		static void setAccountType(uint32_t accountId, account::AccountType accountType);
 		static void updateOnlineStatus(uint32_t guid, bool login);
-		static bool preloadPlayer(Player* player, const std::string& name);
+
+		static bool fetchPlayerById(PlayerLoadData& data, uint32_t id);
+		static bool fetchPlayerByName(PlayerLoadData& data, const std::string& name);
+		static bool fetchPlayer(PlayerLoadData& data, DBResult_ptr result);
+		// Sets what the login checks need (guid, group, account), fails if the player was deleted
+		static bool preloadPlayer(Player* player, const PlayerLoadData& data);
 
 		static bool loadPlayerById(Player* player, uint32_t id);
 		static bool loadPlayerByName(Player* player, const std::string& name);
 		static bool loadPlayer(Player* player, DBResult_ptr result);
+		static bool loadPlayer(Player* player, const PlayerLoadData& data);
+		// Saves now, unless a save of the player is still being written: then it goes after it
 		static bool savePlayer(Player* player);
+		// Serializes the player and leaves writing it to the save writer
+		static void savePlayerAsync(Player* player);
+		static bool isSavePending(uint32_t guid);
+		/**
+		 * Saves are numbered, a fetch taken before getSaveSequence() returned
+		 * sequence is stale if hasSavedSince(guid, sequence).
+		 */
+		static uint64_t getSaveSequence();
+		static bool hasSavedSince(uint32_t guid, uint64_t sequence);
+		static PlayerSaveStats getSaveStats();
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 		static std::string getNameByGuid(uint32_t guid);
@@ -53,8 +126,10 @@ class IOLoginData
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
-		static void loadItems(ItemMap& itemMap, DBResult_ptr result, Player &player);
-		static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& stream);
+		static void loadItems(ItemMap& itemMap, DBResult_ptr result, Player &player, PlayerRows& rows);
+		static void saveItems(const Player* player, const ItemBlockList& itemList, PlayerRows& rows, PropWriteStream& stream);
+		static void serializePlayer(Player* player, PlayerSave& save);
+		static void onPlayerSaved(uint32_t guid, uint64_t rows, PlayerSaveResult_t result);
 };
 
 #endif  // SRC_IO_IOLOGINDATA_H_
@@ -37,17 +37,17 @@
 	|--- OTBM_ITEM_DEF (not implemented)
 */
 
-Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z)
+Tile* IOMap::createTile(Arena &arena, Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z)
 {
 	if (!ground) {
-		return new StaticTile(x, y, z);
+		return arena.create<StaticTile>(x, y, z);
 	}
 
 	Tile* tile;
 	if ((item && item->isBlocking()) || ground->isBlocking()) {
-		tile = new StaticTile(x, y, z);
+		tile = arena.create<StaticTile>(x, y, z);
 	} else {
-		tile = new DynamicTile(x, y, z);
+		tile = arena.create<DynamicTile>(x, y, z);
 	}
 
 	tile->internalAddThing(ground);
@@ -127,6 +127,7 @@ bool IOMap::loadMap(Map* map, const std::string& fileName, const Position& pos,
 	}
 
 	SPDLOG_INFO("Map loading time: {} seconds", (OTSYS_TIME() - start) / (1000.));
+	SPDLOG_DEBUG("Map arena: {} KB used of {} KB", map->arena.getUsed() / 1024, map->arena.getReserved() / 1024);
 	return true;
 }
 
@@ -276,7 +277,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 					return false;
 				}
 
-				tile = new HouseTile(x, y, z, house);
+				tile = map.arena.create<HouseTile>(x, y, z, house);
 				house->addTile(static_cast<HouseTile*>(tile));
 				isHouseTile = true;
 			}
@@ -314,7 +315,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				}
 
 				case OTBM_ATTR_ITEM: {
-					Item* item = Item::CreateItem(propStream);
+					Item* item = Item::CreateItem(propStream, &map.arena);
 					if (!item) {
 						std::ostringstream ss;
 						ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to create item.";
@@ -367,7 +368,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 							delete ground_item;
 							ground_item = item;
 						} else {
-							tile = createTile(ground_item, item, x, y, z);
+							tile = createTile(map.arena, ground_item, item, x, y, z);
 							tile->internalAddThing(item);
 							item->startDecaying();
 							item->setLoadedFromMap(true);
@@ -398,7 +399,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				return false;
 			}
 
-			Item* item = Item::CreateItem(stream);
+			Item* item = Item::CreateItem(stream, &map.arena);
 			if (!item) {
 				std::ostringstream ss;
 				ss << "[x:" << x << ", y:" << y << ", z:" << z << "] Failed to create item.";
@@ -434,7 +435,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 					delete ground_item;
 					ground_item = item;
 				} else {
-					tile = createTile(ground_item, item, x, y, z);
+					tile = createTile(map.arena, ground_item, item, x, y, z);
 					tile->internalAddThing(item);
 					item->startDecaying();
 					item->setLoadedFromMap(true);
@@ -443,7 +444,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 		}
 
 		if (!tile) {
-			tile = createTile(ground_item, nullptr, x, y, z);
+			tile = createTile(map.arena, ground_item, nullptr, x, y, z);
 		}
 
 		tile->setFlag(static_cast<TileFlags_t>(tileflags));
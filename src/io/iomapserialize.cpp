@@ -13,66 +13,188 @@
 #include "game/game.h"
 #include "items/bed.h"
 
+namespace {
+	// Rows of houses that are gone from the map, they are deleted by the next save
+	std::vector<uint32_t> staleHouseIds;
+}
+
 void IOMapSerialize::loadHouseItems(Map* map)
 {
 	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
+	// Loading beds looks up the names of their sleepers, which cannot be done while the rows are streamed
+	bool lazy = g_configManager().getBoolean(LAZY_LOAD_HOUSE_ITEMS);
+	const std::string query = "SELECT `house_id`, `data` FROM `tile_store`";
+	DBResult_ptr result = lazy ? Database::getInstance().streamQuery(query) : Database::getInstance().storeQuery(query);
 	if (!result) {
 		return;
 	}
 
+	const auto houseIdColumn = result->getColumn("house_id");
+	const auto dataColumn = result->getColumn("data");
+	// Houses whose stored rows no longer match the map, they are loaded now and written again by the next save
+	phmap::flat_hash_set<House*> changedHouses;
 	do {
+		uint32_t houseId = result->getNumber<uint32_t>(houseIdColumn);
 		unsigned long attrSize;
-		const char* attr = result->getStream("data", attrSize);
+		const char* attr = result->getStream(dataColumn, attrSize);
 
 		PropStream propStream;
 		propStream.init(attr, attrSize);
 
-		uint16_t x, y;
-		uint8_t z;
-		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
-			continue;
+		Tile* tile = readTilePosition(propStream, *map);
+		House* house = tile ? tile->getHouse() : nullptr;
+		if (!house || house->getId() != houseId) {
+			if (House* storedHouse = map->houses.getHouse(houseId)) {
+				changedHouses.insert(storedHouse);
+			} else if (std::find(staleHouseIds.begin(), staleHouseIds.end(), houseId) == staleHouseIds.end()) {
+				staleHouseIds.push_back(houseId);
+			}
+
+			if (!house) {
+				continue;
+			}
+			changedHouses.insert(house);
 		}
 
-		Tile* tile = map->getTile(x, y, z);
-		if (!tile) {
-			continue;
+		if (lazy) {
+			house->addPendingItems(std::string(attr, attrSize));
+		} else {
+			loadTile(propStream, tile);
+		}
+	} while (result->next());
+	result.reset();
+
+	for (const auto& [id, house] : map->houses.getHouses()) {
+		// Loading transforms doors and beds, which is not a change to save
+		house->setDirty(false);
+		if (house->hasPendingItems()) {
+			map->houses.addPendingHouse(house);
+		}
+	}
+
+	for (House* house : changedHouses) {
+		loadHouseItems(house);
+		house->setDirty(true);
+	}
+
+	if (lazy) {
+		SPDLOG_INFO("Read house items in {} seconds, they are loaded once a player gets close", (OTSYS_TIME() - start) / (1000.));
+	} else {
+		SPDLOG_INFO("Loaded house items in {} seconds", (OTSYS_TIME() - start) / (1000.));
+	}
+}
+
+void IOMapSerialize::loadHouseItems(House* house)
+{
+	if (!house->hasPendingItems()) {
+		return;
+	}
+
+	Map& map = g_game().map;
+	for (const std::string& data : house->takePendingItems()) {
+		PropStream propStream;
+		propStream.init(data.data(), data.size());
+		if (Tile* tile = readTilePosition(propStream, map)) {
+			loadTile(propStream, tile);
 		}
+	}
+	house->setDirty(false);
 
-		uint32_t item_count;
-		if (!propStream.read<uint32_t>(item_count)) {
+	// Sleepers that logged in before their bed was loaded wake up now
+	for (BedItem* bed : house->getBeds()) {
+		if (bed->getSleeper() == 0) {
 			continue;
 		}
 
-		while (item_count--) {
-			loadItem(propStream, tile);
+		if (Player* player = g_game().getPlayerByGUID(bed->getSleeper())) {
+			bed->wakeUp(player);
 		}
-	} while (result->next());
-	SPDLOG_INFO("Loaded house items in {} seconds", (OTSYS_TIME() - start) / (1000.));
+	}
+}
+
+Tile* IOMapSerialize::readTilePosition(PropStream& propStream, const Map& map)
+{
+	uint16_t x, y;
+	uint8_t z;
+	if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
+		return nullptr;
+	}
+	return map.getTile(x, y, z);
+}
+
+void IOMapSerialize::loadTile(PropStream& propStream, Tile* tile)
+{
+	uint32_t item_count;
+	if (!propStream.read<uint32_t>(item_count)) {
+		return;
+	}
+
+	while (item_count--) {
+		loadItem(propStream, tile);
+	}
 }
 
 bool IOMapSerialize::saveHouseItems()
 {
 	int64_t start = OTSYS_TIME();
+	DBBatch batch;
+	std::vector<uint32_t> houseIds = saveHouseItems(batch);
+	bool success = batch.execute();
+	if (!success) {
+		setHousesDirty(houseIds);
+	}
+	SPDLOG_INFO("Saved items of {} houses in {} seconds", houseIds.size(), (OTSYS_TIME() - start) / (1000.));
+	return success;
+}
+
+std::vector<uint32_t> IOMapSerialize::saveHouseItems(DBBatch& batch)
+{
 	Database& db = Database::getInstance();
 	std::ostringstream query;
 
-	//Start the transaction
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
+	std::vector<House*> houses;
+	for (const auto& [key, house] : g_game().map.houses.getHouses()) {
+		if (house->isDirty()) {
+			// Its rows are replaced, so the stored items not loaded yet have to be written too
+			if (house->hasPendingItems()) {
+				loadHouseItems(house);
+				house->setDirty(true);
+			}
+			houses.push_back(house);
+		}
 	}
 
-	//clear old tile data
-	if (!db.executeQuery("DELETE FROM `tile_store`")) {
-		return false;
+	std::vector<uint32_t> houseIds;
+	houseIds.reserve(houses.size() + staleHouseIds.size());
+	for (const House* house : houses) {
+		houseIds.push_back(house->getId());
+	}
+
+	// Stale houses are not handed back, their rows are found again by the next startup if this fails
+	std::vector<uint32_t> deleteIds = houseIds;
+	deleteIds.insert(deleteIds.end(), staleHouseIds.begin(), staleHouseIds.end());
+	staleHouseIds.clear();
+	if (deleteIds.empty()) {
+		return houseIds;
 	}
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
+	//replace the stored tiles of the changed houses
+	query << "DELETE FROM `tile_store` WHERE `house_id` IN (";
+	for (size_t i = 0; i < deleteIds.size(); ++i) {
+		if (i != 0) {
+			query << ',';
+		}
+		query << deleteIds[i];
+	}
+	query << ')';
+	batch.add(query.str());
+	query.str(std::string());
+
+	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ", batch);
 
 	PropWriteStream stream;
-	for (const auto& [key, house] : g_game().map.houses.getHouses()) {
+	for (House* house : houses) {
 		//save house items
 		for (HouseTile* tile : house->getTiles()) {
 			saveTile(stream, tile);
@@ -81,22 +203,23 @@ bool IOMapSerialize::saveHouseItems()
 			const char* attributes = stream.getStream(attributesSize);
 			if (attributesSize > 0) {
 				query << house->getId() << ',' << db.escapeBlob(attributes, attributesSize);
-				if (!stmt.addRow(query)) {
-					return false;
-				}
+				stmt.addRow(query);
 				stream.clear();
 			}
 		}
+		house->setDirty(false);
 	}
+	stmt.execute();
+	return houseIds;
+}
 
-	if (!stmt.execute()) {
-		return false;
+void IOMapSerialize::setHousesDirty(const std::vector<uint32_t>& houseIds)
+{
+	for (uint32_t houseId : houseIds) {
+		if (House* house = g_game().map.houses.getHouse(houseId)) {
+			house->setDirty(true);
+		}
 	}
-
-	//End the transaction
-	bool success = transaction.commit();
-	SPDLOG_INFO("Saved house items in {} seconds", (OTSYS_TIME() - start) / (1000.));
-	return success;
 }
 
 bool IOMapSerialize::loadContainer(PropStream& propStream, Container* container)
@@ -286,52 +409,40 @@ bool IOMapSerialize::loadHouseInfo()
 }
 
 bool IOMapSerialize::saveHouseInfo()
+{
+	DBBatch batch;
+	saveHouseInfo(batch);
+	return batch.execute();
+}
+
+void IOMapSerialize::saveHouseInfo(DBBatch& batch)
 {
 	Database& db = Database::getInstance();
 
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
-
-	if (!db.executeQuery("DELETE FROM `house_lists`")) {
-		return false;
-	}
+	batch.add("DELETE FROM `house_lists`");
 
 	std::ostringstream query;
 	for (const auto& [key, house] : g_game().map.houses.getHouses()) {
-		query << "SELECT `id` FROM `houses` WHERE `id` = " << house->getId();
-		DBResult_ptr result = db.storeQuery(query.str());
-		if (result) {
-			query.str(std::string());
-			query << "UPDATE `houses` SET `owner` = " << house->getOwner() << ", `paid` = " << house->getPaidUntil() << ", `warnings` = " << house->getPayRentWarnings() << ", `name` = " << db.escapeString(house->getName()) << ", `town_id` = " << house->getTownId() << ", `rent` = " << house->getRent() << ", `size` = " << house->getTiles().size() << ", `beds` = " << house->getBedCount() << " WHERE `id` = " << house->getId();
-		} else {
-			query.str(std::string());
-			query << "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES (" << house->getId() << ',' << house->getOwner() << ',' << house->getPaidUntil() << ',' << house->getPayRentWarnings() << ',' << db.escapeString(house->getName()) << ',' << house->getTownId() << ',' << house->getRent() << ',' << house->getTiles().size() << ',' << house->getBedCount() << ')';
-		}
-
-		db.executeQuery(query.str());
+		query << "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES (" << house->getId() << ',' << house->getOwner() << ',' << house->getPaidUntil() << ',' << house->getPayRentWarnings() << ',' << db.escapeString(house->getName()) << ',' << house->getTownId() << ',' << house->getRent() << ',' << house->getTiles().size() << ',' << house->getBedCount() << ')'
+			<< " ON DUPLICATE KEY UPDATE `owner` = VALUES(`owner`), `paid` = VALUES(`paid`), `warnings` = VALUES(`warnings`), `name` = VALUES(`name`), `town_id` = VALUES(`town_id`), `rent` = VALUES(`rent`), `size` = VALUES(`size`), `beds` = VALUES(`beds`)";
+		batch.add(query.str());
 		query.str(std::string());
 	}
 
-	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ");
+	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ", batch);
 
 	for (const auto& [key, house] : g_game().map.houses.getHouses()) {
 		std::string listText;
 		if (house->getAccessList(GUEST_LIST, listText) && !listText.empty()) {
 			query << house->getId() << ',' << GUEST_LIST << ',' << db.escapeString(listText);
-			if (!stmt.addRow(query)) {
-				return false;
-			}
+			stmt.addRow(query);
 
 			listText.clear();
 		}
 
 		if (house->getAccessList(SUBOWNER_LIST, listText) && !listText.empty()) {
 			query << house->getId() << ',' << SUBOWNER_LIST << ',' << db.escapeString(listText);
-			if (!stmt.addRow(query)) {
-				return false;
-			}
+			stmt.addRow(query);
 
 			listText.clear();
 		}
@@ -339,18 +450,11 @@ bool IOMapSerialize::saveHouseInfo()
 		for (Door* door : house->getDoors()) {
 			if (door->getAccessList(listText) && !listText.empty()) {
 				query << house->getId() << ',' << door->getDoorId() << ',' << db.escapeString(listText);
-				if (!stmt.addRow(query)) {
-					return false;
-				}
+				stmt.addRow(query);
 
 				listText.clear();
 			}
 		}
 	}
-
-	if (!stmt.execute()) {
-		return false;
-	}
-
-	return transaction.commit();
+	stmt.execute();
 }
@@ -12,18 +12,28 @@
 
 #include "map/map.h"
 
+class DBBatch;
+
 class IOMapSerialize
 {
 	public:
 		static void loadHouseItems(Map* map);
+		// Loads the stored tiles of a house that lazyLoadHouseItems held back
+		static void loadHouseItems(House* house);
 		static bool saveHouseItems();
+		// Returns the houses written to the batch, so they can be marked again if it fails
+		static std::vector<uint32_t> saveHouseItems(DBBatch& batch);
+		static void setHousesDirty(const std::vector<uint32_t>& houseIds);
 		static bool loadHouseInfo();
 		static bool saveHouseInfo();
+		static void saveHouseInfo(DBBatch& batch);
 
 	private:
 		static void saveItem(PropWriteStream& stream, const Item* item);
 		static void saveTile(PropWriteStream& stream, const Tile* tile);
 
+		static Tile* readTilePosition(PropStream& propStream, const Map& map);
+		static void loadTile(PropStream& propStream, Tile* tile);
 		static bool loadContainer(PropStream& propStream, Container* container);
 		static bool loadItem(PropStream& propStream, Cylinder* parent);
 };
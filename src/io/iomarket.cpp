@@ -25,34 +25,143 @@ uint8_t IOMarket::getTierFromDatabaseTable(const std::string &string) {
 	return tier;
 }
 
+bool IOMarket::loadOffers()
+{
+	offers.clear();
+	books.clear();
+	playerOffers.clear();
+	counters.clear();
+	expirations.clear();
+	nextOfferId = 1;
+
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `market_offers`.`id` AS `id`, `player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `tier`, `players`.`name` AS `player_name` FROM `market_offers` INNER JOIN `players` ON `players`.`id` = `market_offers`.`player_id`");
+	if (!result) {
+		return true;
+	}
+
+	const auto idColumn = result->getColumn("id");
+	const auto playerIdColumn = result->getColumn("player_id");
+	const auto saleColumn = result->getColumn("sale");
+	const auto itemTypeColumn = result->getColumn("itemtype");
+	const auto amountColumn = result->getColumn("amount");
+	const auto createdColumn = result->getColumn("created");
+	const auto anonymousColumn = result->getColumn("anonymous");
+	const auto priceColumn = result->getColumn("price");
+	const auto tierColumn = result->getColumn("tier");
+	const auto playerNameColumn = result->getColumn("player_name");
+
+	do {
+		MarketOrder offer;
+		offer.id = result->getNumber<uint32_t>(idColumn);
+		offer.playerId = result->getNumber<uint32_t>(playerIdColumn);
+		offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>(saleColumn));
+		offer.itemId = result->getNumber<uint16_t>(itemTypeColumn);
+		offer.amount = result->getNumber<uint16_t>(amountColumn);
+		offer.created = result->getNumber<time_t>(createdColumn);
+		offer.anonymous = result->getNumber<uint16_t>(anonymousColumn) != 0;
+		offer.price = result->getNumber<uint64_t>(priceColumn);
+		offer.tier = getTierFromDatabaseTable(result->getString(tierColumn));
+		offer.playerName = result->getString(playerNameColumn);
+		nextOfferId = std::max<uint32_t>(nextOfferId, offer.id + 1);
+		addOffer(std::move(offer));
+	} while (result->next());
+
+	SPDLOG_INFO("Loaded {} market offers", offers.size());
+	return true;
+}
+
+void IOMarket::addOffer(MarketOrder &&offer)
+{
+	const uint32_t offerId = offer.id;
+	MarketBook &book = books[getBookKey(offer.itemId, offer.tier)];
+	if (offer.type == MARKETACTION_BUY) {
+		book.buyOffers.emplace(offer.price, offerId);
+	} else {
+		book.sellOffers.emplace(offer.price, offerId);
+	}
+
+	playerOffers[offer.playerId].insert(offerId);
+	counters[getCounterKey(offer.created, offerId & 0xFFFF)] = offerId;
+	expirations.emplace(offer.created, offerId);
+	offers.emplace(offerId, std::move(offer));
+}
+
+void IOMarket::removeOffer(uint32_t offerId)
+{
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return;
+	}
+
+	const MarketOrder &offer = it->second;
+	if (auto bookIt = books.find(getBookKey(offer.itemId, offer.tier)); bookIt != books.end()) {
+		MarketBook &book = bookIt->second;
+		if (offer.type == MARKETACTION_BUY) {
+			book.buyOffers.erase({offer.price, offerId});
+		} else {
+			book.sellOffers.erase({offer.price, offerId});
+		}
+
+		if (book.buyOffers.empty() && book.sellOffers.empty()) {
+			books.erase(bookIt);
+		}
+	}
+
+	if (auto playerIt = playerOffers.find(offer.playerId); playerIt != playerOffers.end()) {
+		playerIt->second.erase(offerId);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
+		}
+	}
+
+	if (auto counterIt = counters.find(getCounterKey(offer.created, offerId & 0xFFFF)); counterIt != counters.end() && counterIt->second == offerId) {
+		counters.erase(counterIt);
+	}
+
+	expirations.erase({offer.created, offerId});
+	offers.erase(it);
+}
+
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId, uint8_t tier)
 {
 	MarketOfferList offerList;
 
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `tier`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = " << action << " AND `itemtype` = " << itemId << " AND `tier` = " << std::to_string(tier);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	const IOMarket &market = getInstance();
+	auto bookIt = market.books.find(getBookKey(itemId, tier));
+	if (bookIt == market.books.end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = g_configManager().getNumber(MARKET_OFFER_DURATION);
 
-	do {
+	auto pushOffer = [&](uint32_t offerId) {
+		const MarketOrder &order = market.offers.at(offerId);
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		offer.amount = order.amount;
+		offer.price = order.price;
+		offer.timestamp = static_cast<uint32_t>(order.created + marketOfferDuration);
+		offer.counter = order.id & 0xFFFF;
+		offer.itemId = order.itemId;
+		if (!order.anonymous) {
+			offer.playerName = order.playerName;
 		} else {
 			offer.playerName = "Anonymous";
 		}
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.tier = order.tier;
 		offerList.push_back(offer);
-	} while (result->next());
+	};
+
+	// Best prices first: highest buy offers and lowest sell offers
+	const MarketBook &book = bookIt->second;
+	if (action == MARKETACTION_BUY) {
+		for (auto it = book.buyOffers.rbegin(); it != book.buyOffers.rend(); ++it) {
+			pushOffer(it->second);
+		}
+	} else {
+		for (const auto &[price, offerId] : book.sellOffers) {
+			pushOffer(offerId);
+		}
+	}
 	return offerList;
 }
 
@@ -60,26 +169,29 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = g_configManager().getNumber(MARKET_OFFER_DURATION);
-
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `created`, `itemtype`, `tier` FROM `market_offers` WHERE `player_id` = " << playerId << " AND `sale` = " << action;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	const IOMarket &market = getInstance();
+	auto playerIt = market.playerOffers.find(playerId);
+	if (playerIt == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
+	const int32_t marketOfferDuration = g_configManager().getNumber(MARKET_OFFER_DURATION);
+
+	for (uint32_t offerId : playerIt->second) {
+		const MarketOrder &order = market.offers.at(offerId);
+		if (order.type != action) {
+			continue;
+		}
+
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.tier = getTierFromDatabaseTable(result->getString("tier"));
+		offer.amount = order.amount;
+		offer.price = order.price;
+		offer.timestamp = static_cast<uint32_t>(order.created + marketOfferDuration);
+		offer.counter = order.id & 0xFFFF;
+		offer.itemId = order.itemId;
+		offer.tier = order.tier;
 		offerList.push_back(offer);
-	} while (result->next());
+	}
 	return offerList;
 }
 
@@ -87,10 +199,10 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 {
 	HistoryMarketOfferList offerList;
 
-	std::ostringstream query;
-	query << "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state`, `tier` FROM `market_history` WHERE `player_id` = " << playerId << " AND `sale` = " << action;
+	DBStatement statement("SELECT `itemtype`, `amount`, `price`, `expires_at`, `state`, `tier` FROM `market_history` WHERE `player_id` = ? AND `sale` = ?");
+	statement.bind(playerId).bind(action);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
+	DBResult_ptr result = Database::getInstance().storeQuery(statement);
 	if (!result) {
 		return offerList;
 	}
@@ -115,22 +227,29 @@ HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t p
 	return offerList;
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
+void IOMarket::processExpiredOffers()
 {
-	if (!result) {
-		return;
+	const time_t lastExpireDate = getTimeNow() - g_configManager().getNumber(MARKET_OFFER_DURATION);
+
+	IOMarket &market = getInstance();
+	std::vector<MarketOrder> expiredOffers;
+	for (const auto &[created, offerId] : market.expirations) {
+		if (created > lastExpireDate) {
+			break;
+		}
+		expiredOffers.push_back(market.offers.at(offerId));
 	}
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
+	for (const MarketOrder &offer : expiredOffers) {
+		if (!IOMarket::moveOfferToHistory(offer.id, OFFERSTATE_EXPIRED)) {
 			continue;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		auto tier = getTierFromDatabaseTable(result->getString("tier"));
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
+		const uint32_t playerId = offer.playerId;
+		const uint16_t amount = offer.amount;
+		auto tier = offer.tier;
+		if (offer.type == MARKETACTION_SELL) {
+			const ItemType& itemType = Item::items[offer.itemId];
 			if (itemType.id == 0) {
 				continue;
 			}
@@ -188,7 +307,7 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
 				delete player;
 			}
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+			uint64_t totalPrice = offer.price * amount;
 
 			Player* player = g_game().getPlayerByGUID(playerId);
 			if (player) {
@@ -197,16 +316,12 @@ void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
 				IOLoginData::increaseBankBalance(playerId, totalPrice);
 			}
 		}
-	} while (result->next());
+	}
 }
 
 void IOMarket::checkExpiredOffers()
 {
-	const time_t lastExpireDate = getTimeNow() - g_configManager().getNumber(MARKET_OFFER_DURATION);
-
-	std::ostringstream query;
-	query << "SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale`, `tier` FROM `market_offers` WHERE `created` <= " << lastExpireDate;
-	g_databaseTasks().addTask(query.str(), IOMarket::processExpiredOffers, true);
+	processExpiredOffers();
 
 	int32_t checkExpiredMarketOffersEachMinutes = g_configManager().getNumber(CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
 	if (checkExpiredMarketOffersEachMinutes <= 0) {
@@ -218,14 +333,12 @@ void IOMarket::checkExpiredOffers()
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId)
 {
-	std::ostringstream query;
-	query << "SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = " << playerId;
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	const IOMarket &market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return static_cast<uint32_t>(it->second.size());
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
@@ -234,93 +347,135 @@ MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 
 	const int32_t created = timestamp - g_configManager().getNumber(MARKET_OFFER_DURATION);
 
-	std::ostringstream query;
-	query << "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, `tier`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = " << created << " AND (`id` & 65535) = " << counter << " LIMIT 1";
-
-	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
-	if (!result) {
+	const IOMarket &market = getInstance();
+	auto it = market.counters.find(getCounterKey(created, counter));
+	if (it == market.counters.end()) {
 		offer.id = 0;
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint64_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	offer.tier = getTierFromDatabaseTable(result->getString("tier"));
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
+	const MarketOrder &order = market.offers.at(it->second);
+	offer.id = order.id;
+	offer.type = order.type;
+	offer.amount = order.amount;
+	offer.counter = order.id & 0xFFFF;
+	offer.timestamp = static_cast<uint32_t>(order.created);
+	offer.price = order.price;
+	offer.itemId = order.itemId;
+	offer.playerId = order.playerId;
+	offer.tier = order.tier;
+	if (!order.anonymous) {
+		offer.playerName = order.playerName;
 	} else {
 		offer.playerName = "Anonymous";
 	}
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous)
+void IOMarket::createOffer(uint32_t playerId, const std::string &playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous)
 {
-	std::ostringstream query;
-	query << "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `tier`) VALUES (" << playerId << ',' << action << ',' << itemId << ',' << amount << ',' << getTimeNow() << ',' << anonymous << ',' << price << ',' << std::to_string(tier) << ')';
-	Database::getInstance().executeQuery(query.str());
+	IOMarket &market = getInstance();
+
+	MarketOrder offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = playerId;
+	offer.type = action;
+	offer.itemId = static_cast<uint16_t>(itemId);
+	offer.amount = amount;
+	offer.created = getTimeNow();
+	offer.anonymous = anonymous;
+	offer.price = price;
+	offer.tier = tier;
+	offer.playerName = playerName;
+
+	std::ostringstream row;
+	row << offer.id << ',' << playerId << ',' << action << ',' << itemId << ',' << amount << ','
+		<< offer.created << ',' << anonymous << ',' << price << ',' << std::to_string(tier);
+	g_databaseTasks().addRow("INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `tier`) VALUES ", row.str());
+
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	std::ostringstream query;
-	query << "UPDATE `market_offers` SET `amount` = `amount` - " << amount << " WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+	auto it = getInstance().offers.find(offerId);
+	if (it == getInstance().offers.end()) {
+		return;
+	}
+
+	MarketOrder &offer = it->second;
+	offer.amount -= std::min(amount, offer.amount);
+	g_databaseTasks().addTask(fmt::format("UPDATE `market_offers` SET `amount` = {} WHERE `id` = {}", offer.amount, offerId));
 }
 
 void IOMarket::deleteOffer(uint32_t offerId)
 {
-	std::ostringstream query;
-	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	Database::getInstance().executeQuery(query.str());
+	getInstance().removeOffer(offerId);
+	g_databaseTasks().addTask(fmt::format("DELETE FROM `market_offers` WHERE `id` = {}", offerId));
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint64_t price, time_t timestamp, uint8_t tier, MarketOfferState_t state)
 {
-	std::ostringstream query;
-	query << "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`, `tier`) VALUES ("
-		<< playerId << ',' << type << ',' << itemId << ',' << amount << ',' << price << ','
-		<< timestamp << ',' << getTimeNow() << ',' << state << ',' << std::to_string(tier) << ')';
-	g_databaseTasks().addTask(query.str());
+	std::ostringstream row;
+	row << playerId << ',' << type << ',' << itemId << ',' << amount << ',' << price << ','
+		<< timestamp << ',' << getTimeNow() << ',' << state << ',' << std::to_string(tier);
+	g_databaseTasks().addRow("INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`, `tier`) VALUES ", row.str());
+
+	if (state == OFFERSTATE_ACCEPTED) {
+		getInstance().addTransaction(type, itemId, tier, price);
+	}
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 {
-	Database& db = Database::getInstance();
+	auto it = getInstance().offers.find(offerId);
+	if (it == getInstance().offers.end()) {
+		return false;
+	}
 
-	std::ostringstream query;
-	query << "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `tier` FROM `market_offers` WHERE `id` = " << offerId;
+	const MarketOrder offer = it->second;
+	deleteOffer(offerId);
 
-	DBResult_ptr result = db.storeQuery(query.str());
-	if (!result) {
-		return false;
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price, getTimeNow(), offer.tier, state);
+	return true;
+}
+
+void IOMarket::addTransaction(MarketAction_t type, uint16_t itemId, uint8_t tier, uint64_t price)
+{
+	MarketStatistics* statistics = nullptr;
+	if (type == MARKETACTION_BUY) {
+		statistics = &purchaseStatistics[itemId][tier];
+	} else {
+		statistics = &saleStatistics[itemId][tier];
 	}
 
-	query.str(std::string());
-	query << "DELETE FROM `market_offers` WHERE `id` = " << offerId;
-	if (!db.executeQuery(query.str())) {
-		return false;
+	if (statistics->numTransactions == 0 || price < statistics->lowestPrice) {
+		statistics->lowestPrice = price;
 	}
+	statistics->highestPrice = std::max(statistics->highestPrice, price);
+	statistics->totalPrice += price;
+	statistics->numTransactions++;
+}
 
-	appendHistory(
-		result->getNumber<uint32_t>("player_id"),
-		static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")),
-		result->getNumber<uint16_t>("itemtype"),
-		result->getNumber<uint16_t>("amount"),
-		result->getNumber<uint64_t>("price"),
-		getTimeNow(),
-		getTierFromDatabaseTable(result->getString("tier")), state);
-	return true;
+MarketStatistics IOMarket::getStatistics(const StatisticsMap &statistics, uint16_t itemId, uint8_t tier)
+{
+	auto itemIt = statistics.find(itemId);
+	if (itemIt == statistics.end()) {
+		return MarketStatistics();
+	}
+
+	auto tierIt = itemIt->second.find(tier);
+	if (tierIt == itemIt->second.end()) {
+		return MarketStatistics();
+	}
+	return tierIt->second;
 }
 
 void IOMarket::updateStatistics()
 {
+	purchaseStatistics.clear();
+	saleStatistics.clear();
+
 	std::ostringstream query;
 	query << "SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum`, `tier` AS `tier` FROM `market_history` WHERE `state` = " << OFFERSTATE_ACCEPTED << " GROUP BY `itemtype`, `sale`, `tier`";
 	DBResult_ptr result = Database::getInstance().storeQuery(query.str());
@@ -13,6 +13,31 @@
 #include "database/database.h"
 #include "declarations.hpp"
 
+// An offer of the order book, as stored in market_offers
+struct MarketOrder {
+	uint32_t id;
+	uint32_t playerId;
+	uint64_t price;
+	time_t created;
+	uint16_t amount;
+	uint16_t itemId;
+	MarketAction_t type;
+	uint8_t tier;
+	bool anonymous;
+	std::string playerName;
+};
+
+// Offers of one item and tier, by price and then id
+struct MarketBook {
+	std::set<std::pair<uint64_t, uint32_t>> buyOffers;
+	std::set<std::pair<uint64_t, uint32_t>> sellOffers;
+};
+
+/**
+ * The market keeps every active offer in memory once loadOffers ran at
+ * startup: browsing, accepting and cancelling never query the database and
+ * changes are written behind through the database tasks.
+ */
 class IOMarket
 {
 	using StatisticsMap = std::map<uint16_t, std::map<uint8_t, MarketStatistics>>;
@@ -22,17 +47,19 @@ class IOMarket
 			return instance;
 		}
 
+		bool loadOffers();
+
 		static MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId, uint8_t tier);
 		static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
 		static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-		static void processExpiredOffers(DBResult_ptr result, bool);
+		static void processExpiredOffers();
 		static void checkExpiredOffers();
 
 		static uint32_t getPlayerOfferCount(uint32_t playerId);
 		static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-		static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous);
+		static void createOffer(uint32_t playerId, const std::string &playerName, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price, uint8_t tier, bool anonymous);
 		static void acceptOffer(uint32_t offerId, uint16_t amount);
 		static void deleteOffer(uint32_t offerId);
 
@@ -41,11 +68,15 @@ class IOMarket
 
 		void updateStatistics();
 
-		StatisticsMap getPurchaseStatistics() const {
-			return purchaseStatistics;
+		const phmap::flat_hash_map<uint32_t, MarketOrder> &getOffers() const {
+			return offers;
 		}
-		StatisticsMap getSaleStatistics() const {
-			return saleStatistics;
+
+		MarketStatistics getPurchaseStatistics(uint16_t itemId, uint8_t tier) const {
+			return getStatistics(purchaseStatistics, itemId, tier);
+		}
+		MarketStatistics getSaleStatistics(uint16_t itemId, uint8_t tier) const {
+			return getStatistics(saleStatistics, itemId, tier);
 		}
 
 		static uint8_t getTierFromDatabaseTable(const std::string &string);
@@ -53,6 +84,28 @@ class IOMarket
 	private:
 		IOMarket() = default;
 
+		static MarketStatistics getStatistics(const StatisticsMap &statistics, uint16_t itemId, uint8_t tier);
+		static uint32_t getBookKey(uint16_t itemId, uint8_t tier) {
+			return (static_cast<uint32_t>(itemId) << 8) | tier;
+		}
+		static uint64_t getCounterKey(time_t created, uint16_t counter) {
+			return (static_cast<uint64_t>(created) << 16) | counter;
+		}
+
+		void addOffer(MarketOrder &&offer);
+		void removeOffer(uint32_t offerId);
+		void addTransaction(MarketAction_t type, uint16_t itemId, uint8_t tier, uint64_t price);
+
+		phmap::flat_hash_map<uint32_t, MarketOrder> offers;
+		// By getBookKey
+		phmap::flat_hash_map<uint32_t, MarketBook> books;
+		phmap::flat_hash_map<uint32_t, phmap::flat_hash_set<uint32_t>> playerOffers;
+		// By getCounterKey, as the client names offers by timestamp and counter
+		phmap::flat_hash_map<uint64_t, uint32_t> counters;
+		// By creation time, for the expiration check
+		std::set<std::pair<time_t, uint32_t>> expirations;
+		uint32_t nextOfferId = 1;
+
 		// [uint16_t = item id, [uint8_t = item tier, MarketStatistics = structure of the statistics]]
 		StatisticsMap purchaseStatistics;
 		StatisticsMap saleStatistics;
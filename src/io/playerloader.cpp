@@ -0,0 +1,58 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "pch.hpp"
+
+#include "io/playerloader.h"
+#include "config/configmanager.h"
+
+void PlayerLoader::start()
+{
+	auto threads = static_cast<size_t>(std::max<int32_t>(1, g_configManager().getNumber(LOGIN_LOADER_THREADS)));
+	pool = std::make_unique<asio::thread_pool>(threads);
+}
+
+void PlayerLoader::shutdown()
+{
+	if (pool) {
+		pool->join();
+	}
+}
+
+void PlayerLoader::addTask(std::function<void()> task)
+{
+	asio::post(*pool, std::move(task));
+}
+
+void PlayerLoader::addLoginTime(std::chrono::microseconds time)
+{
+	loginTimes[logins++ % LOGIN_SAMPLES] = static_cast<uint32_t>(std::min<int64_t>(time.count(), std::numeric_limits<uint32_t>::max()));
+}
+
+LoginStats PlayerLoader::getLoginStats() const
+{
+	LoginStats stats;
+	stats.logins = logins;
+
+	size_t count = std::min<uint64_t>(logins, LOGIN_SAMPLES);
+	if (count == 0) {
+		return stats;
+	}
+
+	std::vector<uint32_t> times(loginTimes.begin(), loginTimes.begin() + count);
+	std::sort(times.begin(), times.end());
+	auto percentile = [&times](size_t percent) {
+		return times[(times.size() - 1) * percent / 100];
+	};
+	stats.p50 = percentile(50);
+	stats.p90 = percentile(90);
+	stats.p99 = percentile(99);
+	stats.max = times.back();
+	return stats;
+}
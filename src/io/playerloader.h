@@ -0,0 +1,63 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_IO_PLAYERLOADER_H_
+#define SRC_IO_PLAYERLOADER_H_
+
+// Login times in microseconds, over the last LOGIN_SAMPLES logins
+struct LoginStats {
+	uint64_t logins = 0;
+	uint64_t p50 = 0;
+	uint64_t p90 = 0;
+	uint64_t p99 = 0;
+	uint64_t max = 0;
+};
+
+/**
+ * Threads fetching the players that log in, so the dispatcher only builds
+ * and places them. Each thread gets its own pooled database connection.
+ */
+class PlayerLoader
+{
+	public:
+		static constexpr size_t LOGIN_SAMPLES = 1024;
+
+		PlayerLoader() = default;
+
+		// non-copyable
+		PlayerLoader(const PlayerLoader&) = delete;
+		PlayerLoader& operator=(const PlayerLoader&) = delete;
+
+		static PlayerLoader& getInstance() {
+			// Guaranteed to be destroyed
+			static PlayerLoader instance;
+			// Instantiated on first use
+			return instance;
+		}
+
+		void start();
+		// Waits for the fetches in progress, their results are dropped by the closed dispatcher
+		void shutdown();
+
+		void addTask(std::function<void()> task);
+
+		// dispatcher thread
+		void addLoginTime(std::chrono::microseconds time);
+		LoginStats getLoginStats() const;
+
+	private:
+		std::unique_ptr<asio::thread_pool> pool;
+
+		std::array<uint32_t, LOGIN_SAMPLES> loginTimes;
+		uint64_t logins = 0;
+};
+
+constexpr auto g_playerLoader = &PlayerLoader::getInstance;
+
+#endif  // SRC_IO_PLAYERLOADER_H_
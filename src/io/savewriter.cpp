@@ -0,0 +1,39 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "pch.hpp"
+
+#include "io/savewriter.h"
+
+void SaveWriter::start()
+{
+	pool = std::make_unique<asio::thread_pool>(1);
+}
+
+void SaveWriter::shutdown()
+{
+	if (pool) {
+		pool->join();
+	}
+}
+
+void SaveWriter::addTask(std::function<void()> task)
+{
+	asio::post(*pool, std::move(task));
+}
+
+void SaveWriter::flush()
+{
+	std::promise<void> written;
+	std::future<void> done = written.get_future();
+	addTask([&written]() {
+		written.set_value();
+	});
+	done.wait();
+}
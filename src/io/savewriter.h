@@ -0,0 +1,47 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_IO_SAVEWRITER_H_
+#define SRC_IO_SAVEWRITER_H_
+
+/**
+ * Thread writing the saves serialized by the dispatcher, one at a time and in
+ * the order they were added, so a later save of something never lands first.
+ */
+class SaveWriter
+{
+	public:
+		SaveWriter() = default;
+
+		// non-copyable
+		SaveWriter(const SaveWriter&) = delete;
+		SaveWriter& operator=(const SaveWriter&) = delete;
+
+		static SaveWriter& getInstance() {
+			// Guaranteed to be destroyed
+			static SaveWriter instance;
+			// Instantiated on first use
+			return instance;
+		}
+
+		void start();
+		// Writes the saves left, their callbacks are dropped by the closed dispatcher
+		void shutdown();
+
+		void addTask(std::function<void()> task);
+		// Blocks until every save added so far is written
+		void flush();
+
+	private:
+		std::unique_ptr<asio::thread_pool> pool;
+};
+
+constexpr auto g_saveWriter = &SaveWriter::getInstance;
+
+#endif  // SRC_IO_SAVEWRITER_H_
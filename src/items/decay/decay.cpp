@@ -36,66 +36,33 @@ void Decay::startDecay(Item* item)
 	}
 
 	if (duration > 0) {
-		if (item->hasAttribute(ItemAttribute_t::DURATION_TIMESTAMP)) {
+		if (item->hasAttribute(ItemAttribute_t::DURATION_TIMESTAMP) || item->decayIndex != Item::DECAY_NOT_SCHEDULED) {
 			stopDecay(item);
 		}
 
 		int64_t timestamp = OTSYS_TIME() + duration;
-		if (decayMap.empty()) {
-			eventId = g_scheduler().addEvent(createSchedulerTask(std::max<int32_t>(SCHEDULER_MINTICKS, duration), std::bind(&Decay::checkDecay, this)));
-		} else {
-			if (timestamp < decayMap.begin()->first) {
-				g_scheduler().stopEvent(eventId);
-				eventId = g_scheduler().addEvent(createSchedulerTask(std::max<int32_t>(SCHEDULER_MINTICKS, duration), std::bind(&Decay::checkDecay, this)));
-			}
-		}
-
 		item->incrementReferenceCounter();
 		item->setDecaying(DECAYING_TRUE);
 		item->setAttribute(ItemAttribute_t::DURATION_TIMESTAMP, timestamp);
-		decayMap[timestamp].push_back(item);
+		addItem(item, timestamp);
 	}
 }
 
 void Decay::stopDecay(Item* item)
 {
+	if (item->decayIndex != Item::DECAY_NOT_SCHEDULED) {
+		removeItem(item);
+		if (item->hasAttribute(ItemAttribute_t::DURATION)) {
+			//Incase we removed duration attribute don't assign new duration
+			item->setDuration(item->getDuration());
+		}
+		item->removeAttribute(ItemAttribute_t::DECAYSTATE);
+		g_game().ReleaseItem(item);
+		return;
+	}
+
 	if (item->hasAttribute(ItemAttribute_t::DECAYSTATE)) {
-		auto timestamp = item->getAttribute<int64_t>(ItemAttribute_t::DURATION_TIMESTAMP);
 		if (item->hasAttribute(ItemAttribute_t::DURATION_TIMESTAMP)) {
-			auto it = decayMap.find(timestamp);
-			if (it != decayMap.end()) {
-				std::vector<Item*>& decayItems = it->second;
-
-				size_t i = 0, end = decayItems.size();
-				if (end == 1) {
-					if (item == decayItems[i]) {
-						if (item->hasAttribute(ItemAttribute_t::DURATION)) {
-							//Incase we removed duration attribute don't assign new duration
-							item->setDuration(item->getDuration());
-						}
-						item->removeAttribute(ItemAttribute_t::DECAYSTATE);
-						g_game().ReleaseItem(item);
-
-						decayMap.erase(it);
-					}
-					return;
-				}
-				while (i < end) {
-					if (item == decayItems[i]) {
-						if (item->hasAttribute(ItemAttribute_t::DURATION)) {
-							//Incase we removed duration attribute don't assign new duration
-							item->setDuration(item->getDuration());
-						}
-						item->removeAttribute(ItemAttribute_t::DECAYSTATE);
-						g_game().ReleaseItem(item);
-
-						decayItems[i] = decayItems.back();
-						decayItems.pop_back();
-						return;
-					}
-					++i;
-				}
-			}
 			item->removeAttribute(ItemAttribute_t::DURATION_TIMESTAMP);
 		} else {
 			item->removeAttribute(ItemAttribute_t::DECAYSTATE);
@@ -103,24 +70,71 @@ void Decay::stopDecay(Item* item)
 	}
 }
 
+void Decay::addItem(Item* item, int64_t timestamp)
+{
+	if (decayingItems == 0) {
+		nextTick = OTSYS_TIME() / TICK + 1;
+	}
+
+	// First tick at or after the timestamp, never one already handled
+	const int64_t tick = std::max<int64_t>(nextTick, (timestamp + TICK - 1) / TICK);
+	auto &slot = wheel[tick % WHEEL_SLOTS];
+	item->decaySlot = static_cast<uint16_t>(tick % WHEEL_SLOTS);
+	item->decayIndex = static_cast<uint32_t>(slot.size());
+	slot.push_back(item);
+
+	++decayingItems;
+	if (eventId == 0) {
+		scheduleCheck();
+	}
+}
+
+void Decay::removeItem(Item* item)
+{
+	auto &slot = wheel[item->decaySlot];
+	Item* last = slot.back();
+	slot[item->decayIndex] = last;
+	last->decayIndex = item->decayIndex;
+	slot.pop_back();
+
+	item->decayIndex = Item::DECAY_NOT_SCHEDULED;
+	--decayingItems;
+}
+
+void Decay::scheduleCheck()
+{
+	const int64_t delay = nextTick * TICK - OTSYS_TIME();
+	eventId = g_scheduler().addEvent(createSchedulerTask(static_cast<uint32_t>(std::max<int64_t>(SCHEDULER_MINTICKS, delay)), std::bind(&Decay::checkDecay, this)));
+}
+
 void Decay::checkDecay()
 {
+	const auto start = std::chrono::steady_clock::now();
+	eventId = 0;
 	int64_t timestamp = OTSYS_TIME();
+	const int64_t currentTick = timestamp / TICK;
 
 	std::vector<Item*> tempItems;
 	tempItems.reserve(32);// Small preallocation
 
-	auto it = decayMap.begin(), end = decayMap.end();
-	while (it != end) {
-		if (it->first > timestamp) {
-			break;
-		}
+	// After a long stall every slot is visited once
+	const int64_t lastTick = std::min<int64_t>(currentTick, nextTick + WHEEL_SLOTS - 1);
+	for (int64_t tick = nextTick; tick <= lastTick; ++tick) {
+		auto &slot = wheel[tick % WHEEL_SLOTS];
+		for (size_t i = 0; i < slot.size();) {
+			Item* item = slot[i];
+			if (item->getAttribute<int64_t>(ItemAttribute_t::DURATION_TIMESTAMP) > timestamp) {
+				// Due in a later turn of the wheel
+				++i;
+				continue;
+			}
 
-		// Iterating here is unsafe so let's copy our items into temporary vector
-		std::vector<Item*>& decayItems = it->second;
-		tempItems.insert(tempItems.end(), decayItems.begin(), decayItems.end());
-		it = decayMap.erase(it);
+			// Handled after the wheel is updated, decaying may start or stop other items
+			tempItems.push_back(item);
+			removeItem(item);
+		}
 	}
+	nextTick = std::max(nextTick, currentTick + 1);
 
 	for (Item* item : tempItems) {
 		if (!item->canDecay()) {
@@ -134,9 +148,15 @@ void Decay::checkDecay()
 		g_game().ReleaseItem(item);
 	}
 
-	if (it != end) {
-		eventId = g_scheduler().addEvent(createSchedulerTask(std::max<int32_t>(SCHEDULER_MINTICKS, static_cast<int32_t>(it->first - timestamp)), std::bind(&Decay::checkDecay, this)));
+	if (decayingItems != 0 && eventId == 0) {
+		scheduleCheck();
 	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	stats.decayedItems += tempItems.size();
+	stats.ticks++;
+	stats.lastTick = static_cast<uint64_t>(elapsed);
+	stats.maxTick = std::max(stats.maxTick, stats.lastTick);
 }
 
 void Decay::internalDecayItem(Item* item)
@@ -12,6 +12,23 @@
 
 #include "items/item.h"
 
+struct DecayStats {
+	uint64_t decayingItems = 0;
+	uint64_t decayedItems = 0;
+	uint64_t ticks = 0;
+	// Microseconds spent in the last and in the slowest tick
+	uint64_t lastTick = 0;
+	uint64_t maxTick = 0;
+};
+
+/**
+ * Decaying items are kept in a timing wheel of WHEEL_SLOTS slots, one per
+ * TICK milliseconds; an item goes to the slot of the first tick at or after
+ * its DURATION_TIMESTAMP and remembers its slot and index there, so starting
+ * and stopping decay is constant time. A single event runs every tick while
+ * items are decaying and handles the expired items of the slot as a batch.
+ * Items due more than one turn ahead wait in their slot for later turns.
+ */
 class Decay
 {
 	public:
@@ -25,17 +42,34 @@ class Decay
 			return instance;
 		}
 
+		static constexpr int64_t TICK = 100;
+		static constexpr size_t WHEEL_SLOTS = 4096;
+
 		void startDecay(Item* item);
 		void stopDecay(Item* item);
 
+		DecayStats getStats() const {
+			DecayStats result = stats;
+			result.decayingItems = decayingItems;
+			return result;
+		}
+
 	private:
 		Decay() = default;
 
+		void addItem(Item* item, int64_t timestamp);
+		void removeItem(Item* item);
+		void scheduleCheck();
+
 		void checkDecay();
 		void internalDecayItem(Item* item);
 
 		uint32_t eventId {0};
-		std::map<int64_t, std::vector<Item*>> decayMap;
+		// First tick not handled yet
+		int64_t nextTick = 0;
+		size_t decayingItems = 0;
+		std::array<std::vector<Item*>, WHEEL_SLOTS> wheel;
+		DecayStats stats;
 };
 
 constexpr auto g_decay = &Decay::getInstance;
@@ -11,6 +11,33 @@
 
 #include "items/functions/item/attribute.hpp"
 
+/*
+=============================
+* AttributeStrings methods
+=============================
+*/
+AttributeStrings::Entry* AttributeStrings::acquire(const std::string &value)
+{
+	auto &entries = getEntries();
+	auto it = entries.find(std::string_view(value));
+	if (it == entries.end()) {
+		auto entry = std::make_unique<Entry>();
+		entry->value = value;
+		it = entries.emplace(std::string_view(entry->value), std::move(entry)).first;
+	}
+
+	Entry* entry = it->second.get();
+	++entry->references;
+	return entry;
+}
+
+void AttributeStrings::release(Entry* entry)
+{
+	if (--entry->references == 0) {
+		getEntries().erase(std::string_view(entry->value));
+	}
+}
+
 /*
 =============================
 * ItemAttribute class (Attributes methods)
@@ -27,7 +54,7 @@ const std::string& ItemAttribute::getAttributeString(ItemAttribute_t type) const
 		return emptyString;
 	}
 
-	return *attribute->getString().get();
+	return attribute->getString();
 }
 
 const int64_t& ItemAttribute::getAttributeValue(ItemAttribute_t type) const
@@ -47,29 +74,29 @@ const int64_t& ItemAttribute::getAttributeValue(ItemAttribute_t type) const
 
 const Attributes* ItemAttribute::getAttribute(ItemAttribute_t type) const
 {
-	if (hasAttribute(type)) {
-		for (const Attributes& attribute : attributeVector) {
-			if (attribute.getAttributeType() == type) {
-				return &attribute;
-			}
-		}
+	if (!hasAttribute(type)) {
+		return nullptr;
 	}
-	return nullptr;
+	return &attributes[getIndex(type)];
 }
 
 Attributes& ItemAttribute::getAttributesByType(ItemAttribute_t type)
 {
+	const size_t index = getIndex(type);
 	if (hasAttribute(type)) {
-		for (Attributes& attribute : attributeVector) {
-			if (attribute.getAttributeType() == type) {
-				return attribute;
-			}
-		}
+		return attributes[index];
 	}
 
+	// Grown one entry at a time, most items have one or two attributes
+	const auto size = static_cast<size_t>(std::popcount(attributeBits));
+	auto newAttributes = std::make_unique<Attributes[]>(size + 1);
+	std::move(attributes.get(), attributes.get() + index, newAttributes.get());
+	std::move(attributes.get() + index, attributes.get() + size, newAttributes.get() + index + 1);
+	newAttributes[index] = Attributes(type);
+
+	attributes = std::move(newAttributes);
 	attributeBits |= type;
-	attributeVector.emplace_back(type);
-	return attributeVector.back();
+	return attributes[index];
 }
 
 void ItemAttribute::setAttribute(ItemAttribute_t type, int64_t value) {
@@ -98,15 +125,11 @@ bool ItemAttribute::removeAttribute(ItemAttribute_t type)
 		return false;
 	}
 
-	std::ranges::for_each(attributeVector, [this, type](auto &it) {
-		if (it.getAttributeType() == type) {
-			it = std::move(attributeVector.back());
-			attributeVector.pop_back();
-			return false;
-		}
-
-		return true;
-	});
+	// The array keeps its size until the next attribute is added
+	const size_t index = getIndex(type);
+	const auto size = static_cast<size_t>(std::popcount(attributeBits));
+	std::move(attributes.get() + index + 1, attributes.get() + size, attributes.get() + index);
+	attributes[size - 1] = Attributes();
 
 	attributeBits &= ~type;
 	return true;
@@ -117,9 +140,13 @@ bool ItemAttribute::removeAttribute(ItemAttribute_t type)
 * CustomAttribute map methods
 =============================
 */
-const std::map<std::string, CustomAttribute, std::less<>>& ItemAttribute::getCustomAttributeMap() const
+const CustomAttributeMap& ItemAttribute::getCustomAttributeMap() const
 {
-	return customAttributeMap;
+	static CustomAttributeMap emptyMap;
+	if (!customAttributeMap) {
+		return emptyMap;
+	}
+	return *customAttributeMap;
 }
 
 /*
@@ -127,47 +154,73 @@ const std::map<std::string, CustomAttribute, std::less<>>& ItemAttribute::getCus
 * CustomAttribute object methods
 =============================
 */
+namespace {
+	auto findCustomAttribute(CustomAttributeMap &map, const std::string &lowerKey) {
+		return std::ranges::lower_bound(map, lowerKey, std::less<>(), &CustomAttributeMap::value_type::first);
+	}
+}
+
 const CustomAttribute* ItemAttribute::getCustomAttribute(const std::string& attributeName) const
 {
-	if (customAttributeMap.contains(asLowerCaseString(attributeName)))
-	{
-		return &customAttributeMap.at(asLowerCaseString(attributeName));
+	if (!customAttributeMap) {
+		return nullptr;
+	}
+
+	const std::string key = asLowerCaseString(attributeName);
+	auto it = findCustomAttribute(*customAttributeMap, key);
+	if (it == customAttributeMap->end() || it->first != key) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+void ItemAttribute::storeCustomAttribute(const std::string &key, CustomAttribute &&customAttribute) {
+	if (!customAttributeMap) {
+		customAttributeMap = std::make_unique<CustomAttributeMap>();
+	}
+
+	std::string lowerKey = asLowerCaseString(key);
+	auto it = findCustomAttribute(*customAttributeMap, lowerKey);
+	if (it != customAttributeMap->end() && it->first == lowerKey) {
+		it->second = std::move(customAttribute);
+	} else {
+		customAttributeMap->emplace(it, std::move(lowerKey), std::move(customAttribute));
 	}
-	return nullptr;
 }
 
 void ItemAttribute::setCustomAttribute(const std::string &key, const int64_t value) {
-	CustomAttribute attribute(key, value);
-	customAttributeMap[asLowerCaseString(key)] = attribute;
+	storeCustomAttribute(key, CustomAttribute(key, value));
 }
 
 void ItemAttribute::setCustomAttribute(const std::string &key, const std::string &value) {
-	CustomAttribute attribute(key, value);
-	customAttributeMap[asLowerCaseString(key)] = attribute;
+	storeCustomAttribute(key, CustomAttribute(key, value));
 }
 
 void ItemAttribute::setCustomAttribute(const std::string &key, const double value) {
-	CustomAttribute attribute(key, value);
-	customAttributeMap[asLowerCaseString(key)] = attribute;
+	storeCustomAttribute(key, CustomAttribute(key, value));
 }
 
 void ItemAttribute::setCustomAttribute(const std::string &key, const bool value) {
-	CustomAttribute attribute(key, value);
-	customAttributeMap[asLowerCaseString(key)] = attribute;
+	storeCustomAttribute(key, CustomAttribute(key, value));
 }
 
 void ItemAttribute::addCustomAttribute(const std::string &key, const CustomAttribute &customAttribute)
 {
-	customAttributeMap[asLowerCaseString(key)] = customAttribute;
+	storeCustomAttribute(key, CustomAttribute(customAttribute));
 }
 
 bool ItemAttribute::removeCustomAttribute(const std::string& attributeName)
 {
-	auto it = customAttributeMap.find(asLowerCaseString(attributeName));
-	if (it == customAttributeMap.end()) {
+	if (!customAttributeMap) {
+		return false;
+	}
+
+	const std::string key = asLowerCaseString(attributeName);
+	auto it = findCustomAttribute(*customAttributeMap, key);
+	if (it == customAttributeMap->end() || it->first != key) {
 		return false;
 	}
 
-	customAttributeMap.erase(it);
+	customAttributeMap->erase(it);
 	return true;
 }
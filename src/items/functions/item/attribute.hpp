@@ -59,73 +59,131 @@ public:
 	}
 };
 
+/**
+ * Strings of item attributes, each stored once however many items use it
+ * and freed with the last one. Like item reference counts, only used from
+ * the dispatcher thread.
+ */
+class AttributeStrings
+{
+public:
+	struct Entry {
+		std::string value;
+		uint32_t references = 0;
+	};
+
+	static Entry* acquire(const std::string &value);
+	static void retain(Entry* entry) {
+		++entry->references;
+	}
+	static void release(Entry* entry);
+
+	static size_t size() {
+		return getEntries().size();
+	}
+
+private:
+	static phmap::flat_hash_map<std::string_view, std::unique_ptr<Entry>>& getEntries() {
+		// Never destroyed: items released during shutdown still drop their references
+		static auto &entries = *new phmap::flat_hash_map<std::string_view, std::unique_ptr<Entry>>();
+		return entries;
+	}
+};
+
 class Attributes : public ItemAttributeHelper
 {
 public:
-	explicit Attributes(ItemAttribute_t type) : type(type), value(getDefaultValueForType(type)) {}
-	~Attributes() = default;
+	Attributes() = default;
+	explicit Attributes(ItemAttribute_t type) : type(type) {}
+	~Attributes() {
+		releaseString();
+	}
 
-	Attributes(const Attributes& i) : type(i.type), value(i.value) {}
-	Attributes(Attributes&& attribute) noexcept : type(attribute.type), value(std::move(attribute.value)) {}
+	Attributes(const Attributes& i) : type(i.type), value(i.value) {
+		if (isString() && value.string) {
+			AttributeStrings::retain(value.string);
+		}
+	}
+	Attributes(Attributes&& attribute) noexcept : type(attribute.type), value(attribute.value) {
+		attribute.value.integer = 0;
+	}
 
 	Attributes& operator=(Attributes&& other) noexcept {
-		type = other.type;
-		value = std::move(other.value);
+		if (this != &other) {
+			releaseString();
+			type = other.type;
+			value = other.value;
+			other.value.integer = 0;
+		}
 		return *this;
 	}
 
-	const ItemAttribute_t &getAttributeType() const {
+	ItemAttribute_t getAttributeType() const {
 		return type;
 	}
 
-	std::variant<int64_t, std::shared_ptr<std::string>> getDefaultValueForType(ItemAttribute_t attributeType) const {
-		if (isAttributeInteger(attributeType)) {
-			return 0;
-		} else if (isAttributeString(attributeType)) {
-			return std::make_shared<std::string>();
-		} else {
-			return {};
-		}
-	}
-
 	void setValue(int64_t newValue) {
-		if (std::holds_alternative<int64_t>(value)) {
-			value = newValue;
+		if (isAttributeInteger(type)) {
+			value.integer = newValue;
 		}
 	}
 	void setValue(const std::string& newValue) {
-		if (std::holds_alternative<std::shared_ptr<std::string>>(value)) {
-			value = std::make_shared<std::string>(newValue);
+		if (isString()) {
+			AttributeStrings::Entry* entry = AttributeStrings::acquire(newValue);
+			releaseString();
+			value.string = entry;
 		}
 	}
 	const int64_t& getInteger() const {
-		if (std::holds_alternative<int64_t>(value)) {
-			return std::get<int64_t>(value);
+		if (isAttributeInteger(type)) {
+			return value.integer;
 		}
 		static int64_t emptyValue;
 		return emptyValue;
 	}
 
-	const std::shared_ptr<std::string>& getString() const {
-		if (std::holds_alternative<std::shared_ptr<std::string>>(value)) {
-			return std::get<std::shared_ptr<std::string>>(value);
+	const std::string& getString() const {
+		if (isString() && value.string) {
+			return value.string->value;
 		}
-		static std::shared_ptr<std::string> emptyPtr;
-		return emptyPtr;
+		static std::string emptyString;
+		return emptyString;
 	}
 
 private:
-	ItemAttribute_t type;
-	std::variant<int64_t, std::shared_ptr<std::string>> value;
+	bool isString() const {
+		return isAttributeString(type);
+	}
+	void releaseString() {
+		if (isString() && value.string) {
+			AttributeStrings::release(value.string);
+			value.string = nullptr;
+		}
+	}
+
+	ItemAttribute_t type = ItemAttribute_t::NONE;
+	// Which member is used follows from type
+	union {
+		int64_t integer = 0;
+		AttributeStrings::Entry* string;
+	} value;
 };
 
+// Kept sorted by lower case key
+using CustomAttributeMap = std::vector<std::pair<std::string, CustomAttribute>>;
+
+/**
+ * Attributes set on an item, in one array ordered by type: the position of
+ * a type is the number of lower types in attributeBits, so lookups need no
+ * search. Custom attributes are allocated only for items having any.
+ */
 class ItemAttribute : public ItemAttributeHelper
 {
 public:
 	ItemAttribute() = default;
 
 	// CustomAttribute map methods
-	const std::map<std::string, CustomAttribute, std::less<>>& getCustomAttributeMap() const;
+	const CustomAttributeMap& getCustomAttributeMap() const;
 	// CustomAttribute object methods
 	const CustomAttribute* getCustomAttribute(const std::string& attributeName) const;
 	
@@ -147,8 +205,8 @@ public:
 	const std::underlying_type_t<ItemAttribute_t>& getAttributeBits() const {
 		return attributeBits;
 	}
-	const std::vector<Attributes>& getAttributeVector() const {
-		return attributeVector;
+	std::span<const Attributes> getAttributeVector() const {
+		return { attributes.get(), static_cast<size_t>(std::popcount(attributeBits)) };
 	}
 
 	bool hasAttribute(ItemAttribute_t type) const {
@@ -164,9 +222,17 @@ private:
 	ItemAttribute(const ItemAttribute&) = delete;
 	ItemAttribute& operator=(const ItemAttribute&) = delete;
 
-	std::map<std::string, CustomAttribute, std::less<>> customAttributeMap;
+	size_t getIndex(ItemAttribute_t type) const {
+		const auto lowerBits = static_cast<std::underlying_type_t<ItemAttribute_t>>(type) - 1;
+		return static_cast<size_t>(std::popcount(attributeBits & lowerBits));
+	}
+
+	void storeCustomAttribute(const std::string &key, CustomAttribute &&customAttribute);
+
 	std::underlying_type_t<ItemAttribute_t> attributeBits = 0;
-	std::vector<Attributes> attributeVector;
+	// One entry per bit of attributeBits
+	std::unique_ptr<Attributes[]> attributes;
+	std::unique_ptr<CustomAttributeMap> customAttributeMap;
 };
 
 #endif //  SRC_ITEMS_FUNCTIONS_ITEM_ATTRIBUTE_HPP
@@ -29,7 +29,7 @@
 
 Items Item::items;
 
-Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
+Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/, Arena* arena /*= nullptr*/)
 {
 	Item* newItem = nullptr;
 
@@ -59,10 +59,11 @@ Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 			newItem = new BedItem(type);
 		} else {
 			auto itemMap = ItemTransformationMap.find(static_cast<ItemID_t>(it.id));
-			if (itemMap != ItemTransformationMap.end()) {
-				newItem = new Item(itemMap->second, count);
+			const uint16_t itemId = itemMap != ItemTransformationMap.end() ? static_cast<uint16_t>(itemMap->second) : type;
+			if (arena && it.isGroundTile()) {
+				newItem = arena->create<Item>(itemId, count);
 			} else {
-				newItem = new Item(type, count);
+				newItem = new Item(itemId, count);
 			}
 		}
 
@@ -152,7 +153,14 @@ Container* Item::CreateItemAsContainer(const uint16_t type, uint16_t size)
 	return newItem;
 }
 
-Item* Item::CreateItem(PropStream& propStream)
+void Item::operator delete(void* ptr)
+{
+	if (!g_game().map.arena.owns(ptr)) {
+		::operator delete(ptr);
+	}
+}
+
+Item* Item::CreateItem(PropStream& propStream, Arena* arena /*= nullptr*/)
 {
 	uint16_t id;
 	if (!propStream.read<uint16_t>(id)) {
@@ -192,7 +200,7 @@ Item* Item::CreateItem(PropStream& propStream)
 			break;
 	}
 
-	return Item::CreateItem(id, 0);
+	return Item::CreateItem(id, 0, arena);
 }
 
 Item::Item(const uint16_t itemId, uint16_t itemCount /*= 0*/) :
@@ -360,6 +368,29 @@ const Cylinder* Item::getTopParent() const
 	return aux;
 }
 
+void Item::markHouseDirty()
+{
+	Cylinder* topParent = getTopParent();
+	if (topParent && topParent->getCreature()) {
+		return;
+	}
+
+	if (Tile* tile = getTile()) {
+		if (House* house = tile->getHouse()) {
+			house->setDirty(true);
+		}
+	}
+}
+
+void Item::markTileChanged()
+{
+	// Items in containers are not part of the tile description
+	Tile* tile = getTile();
+	if (tile && getParent() == tile) {
+		tile->markItemsChanged();
+	}
+}
+
 Tile* Item::getTile()
 {
 	Cylinder* cylinder = getTopParent();
@@ -968,7 +999,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 	// Serialize custom attributes, only serialize if the map not is empty
 	if (hasCustomAttribute())
 	{
-		auto customAttributeMap = getCustomAttributeMap();
+		const auto &customAttributeMap = getCustomAttributeMap();
 		propWriteStream.write<uint8_t>(ATTR_CUSTOM);
 		propWriteStream.write<uint64_t>(customAttributeMap.size());
 		for (const auto &[attributeKey, customAttribute] : customAttributeMap)
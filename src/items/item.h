@@ -16,6 +16,7 @@
 #include "items/items.h"
 #include "items/functions/item/attribute.hpp"
 #include "lua/scripts/luascript.h"
+#include "utils/arena.hpp"
 #include "utils/tools.h"
 #include "io/fileloader.h"
 
@@ -31,7 +32,7 @@ class MagicField;
 class BedItem;
 class Imbuement;
 
-// This class ItemProperties that serves as an interface to access and modify attributes of an item. The item's attributes are stored in an instance of ItemAttribute. The class ItemProperties has methods to get and set integer and string attributes, check if an attribute exists, remove an attribute, get the underlying attribute bits, and get a vector of attributes. It also has methods to get and set custom attributes, which are stored in a std::map<std::string, CustomAttribute, std::less<>>. The class has a data member attributePtr of type std::unique_ptr<ItemAttribute> that stores a pointer to the item's attributes methods.
+// This class ItemProperties that serves as an interface to access and modify attributes of an item. The item's attributes are stored in an instance of ItemAttribute. The class ItemProperties has methods to get and set integer and string attributes, check if an attribute exists, remove an attribute, get the underlying attribute bits, and get a vector of attributes. It also has methods to get and set custom attributes, which are stored in a CustomAttributeMap sorted by key. The class has a data member attributePtr of type std::unique_ptr<ItemAttribute> that stores a pointer to the item's attributes methods.
 class ItemProperties {
 public:
 	template<typename T>
@@ -75,8 +76,8 @@ public:
 	}
 
 	// Custom Attributes
-	const std::map<std::string, CustomAttribute, std::less<>>& getCustomAttributeMap() const {
-		static std::map<std::string, CustomAttribute, std::less<>> map = {};
+	const CustomAttributeMap& getCustomAttributeMap() const {
+		static CustomAttributeMap map = {};
 		if (!attributePtr) {
 			return map;
 		}
@@ -172,10 +173,9 @@ protected:
 
 		return attributePtr->getAttributeBits();
 	}
-	const std::vector<Attributes>& getAttributeVector() const {
-		static std::vector<Attributes> emptyVector = {};
+	std::span<const Attributes> getAttributeVector() const {
 		if (!attributePtr) {
-			return emptyVector;
+			return {};
 		}
 
 		return attributePtr->getAttributeVector();
@@ -214,11 +214,15 @@ class Item : virtual public Thing, public ItemProperties
 {
 	public:
 		//Factory member to create item of right type based on type
-		static Item* CreateItem(const uint16_t type, uint16_t count = 0);
+		// Grounds are placed in arena when given, see Map::arena
+		static Item* CreateItem(const uint16_t type, uint16_t count = 0, Arena* arena = nullptr);
 		static Container* CreateItemAsContainer(const uint16_t type, uint16_t size);
-		static Item* CreateItem(PropStream& propStream);
+		static Item* CreateItem(PropStream& propStream, Arena* arena = nullptr);
 		static Items items;
 
+		// Leaves the memory of items placed in the map arena
+		static void operator delete(void* ptr);
+
 		// Constructor for items
 		Item(const uint16_t type, uint16_t count = 0);
 		Item(const Item& i);
@@ -536,6 +540,10 @@ class Item : virtual public Thing, public ItemProperties
 		const Cylinder* getTopParent() const;
 		Tile* getTile() override;
 		const Tile* getTile() const override;
+		// Makes the next save write the house the item lies in, if any
+		void markHouseDirty();
+		// Invalidates the cached description of the tile the item lies on, if any
+		void markTileChanged();
 		bool isRemoved() const override {
 			return !parent || parent->isRemoved();
 		}
@@ -643,6 +651,11 @@ class Item : virtual public Thing, public ItemProperties
 
 		bool loadedFromMap = false;
 		bool isLootTrackeable = false;
+
+		// Position in the decay wheel, see Decay
+		static constexpr uint32_t DECAY_NOT_SCHEDULED = std::numeric_limits<uint32_t>::max();
+		uint16_t decaySlot = 0;
+		uint32_t decayIndex = DECAY_NOT_SCHEDULED;
 	private:
 		void setImbuement(uint8_t slot, uint16_t imbuementId, uint32_t duration);
 		//Don't add variables here, use the ItemAttribute class.
@@ -14,6 +14,7 @@
 #include "declarations.hpp"
 #include "items/item.h"
 #include "utils/tools.h"
+#include "map/spectators.hpp"
 
 class Creature;
 class Teleport;
@@ -22,10 +23,10 @@ class Mailbox;
 class MagicField;
 class QTreeLeafNode;
 class BedItem;
+class House;
 
 using CreatureVector = std::vector<Creature*>;
 using ItemVector = std::vector<Item*>;
-using SpectatorHashSet = phmap::flat_hash_set<Creature*>;
 
 class TileItemVector : private ItemVector
 {
@@ -101,6 +102,31 @@ class TileItemVector : private ItemVector
 		uint32_t downItemCount = 0;
 };
 
+/**
+ * Wire encoding of a tile's items for map descriptions, shared by every
+ * viewer: ground and top items, then down items, each up to the 10 things
+ * a tile description holds. It is rebuilt when the tile's items version
+ * no longer matches, see ProtocolGame::GetTileDescription.
+ */
+struct TileItemsEncoding {
+	uint32_t version = 0;
+	// False when an item's encoding depends on time, then nothing is cached
+	bool cacheable = false;
+	uint8_t topEntries = 0;
+	uint8_t downEntries = 0;
+	// End offset of each entry, followed by the entries
+	std::vector<uint8_t> data;
+
+	size_t getEnd(size_t entry) const {
+		uint16_t end;
+		std::memcpy(&end, data.data() + entry * sizeof(uint16_t), sizeof(uint16_t));
+		return end;
+	}
+	const uint8_t* getEntries() const {
+		return data.data() + (topEntries + downEntries) * sizeof(uint16_t);
+	}
+};
+
 class Tile : public Cylinder
 {
 	public:
@@ -114,6 +140,9 @@ class Tile : public Cylinder
 		Tile(const Tile&) = delete;
 		Tile& operator=(const Tile&) = delete;
 
+		// Leaves the memory of tiles placed in the map arena
+		static void operator delete(void* ptr);
+
 		virtual TileItemVector* getItemList() = 0;
 		virtual const TileItemVector* getItemList() const = 0;
 		virtual TileItemVector* makeItemList() = 0;
@@ -122,6 +151,10 @@ class Tile : public Cylinder
 		virtual const CreatureVector* getCreatures() const = 0;
 		virtual CreatureVector* makeCreatures() = 0;
 
+		virtual House* getHouse() {
+			return nullptr;
+		}
+
 		int32_t getThrowRange() const override final {
 			return 0;
 		}
@@ -239,13 +272,32 @@ class Tile : public Cylinder
 		}
 		void setGround(Item* item) {
 			ground = item;
+			++itemsVersion;
+		}
+
+		// Bumped whenever the items change
+		uint32_t getItemsVersion() const {
+			return itemsVersion;
+		}
+		// For changes made to an item in place, e.g. its attributes
+		void markItemsChanged() {
+			++itemsVersion;
+		}
+		const TileItemsEncoding* getItemsEncoding() const {
+			return itemsEncoding.get();
+		}
+		TileItemsEncoding &makeItemsEncoding() const {
+			if (!itemsEncoding) {
+				itemsEncoding = std::make_unique<TileItemsEncoding>();
+			}
+			return *itemsEncoding;
 		}
 
 	private:
 		void onAddTileItem(Item* item);
 		void onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newItem, const ItemType& newType);
-		void onRemoveTileItem(const SpectatorHashSet& spectators, const std::vector<int32_t>& oldStackPosVector, Item* item);
-		void onUpdateTile(const SpectatorHashSet& spectators);
+		void onRemoveTileItem(const SpectatorVec& spectators, const std::vector<int32_t>& oldStackPosVector, Item* item);
+		void onUpdateTile(const SpectatorVec& spectators);
 
 		void setTileFlags(const Item* item);
 		void resetTileFlags(const Item* item);
@@ -255,6 +307,9 @@ class Tile : public Cylinder
 		Item* ground = nullptr;
 		Position tilePos;
 		uint32_t flags = 0;
+		uint32_t itemsVersion = 0;
+		// Built on the first description of the tile
+		mutable std::unique_ptr<TileItemsEncoding> itemsEncoding;
 
 };
 
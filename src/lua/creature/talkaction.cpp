@@ -18,6 +18,7 @@ TalkActions::~TalkActions() = default;
 
 void TalkActions::clear() {
 	talkActions.clear();
+	talkActionWords.clear();
 }
 
 bool TalkActions::registerLuaEvent(TalkAction* event) {
@@ -25,10 +26,15 @@ bool TalkActions::registerLuaEvent(TalkAction* event) {
 	std::vector<std::string> words = talkAction->getWordsMap();
 
 	for (size_t i = 0; i < words.size(); i++) {
+		std::pair<TalkActionMap::iterator, bool> result;
 		if (i == words.size() - 1) {
-			talkActions.emplace(words[i], std::move(*talkAction));
+			result = talkActions.emplace(words[i], std::move(*talkAction));
 		} else {
-			talkActions.emplace(words[i], *talkAction);
+			result = talkActions.emplace(words[i], *talkAction);
+		}
+
+		if (result.second) {
+			talkActionWords.insert(words[i], result.first);
 		}
 	}
 
@@ -36,20 +42,25 @@ bool TalkActions::registerLuaEvent(TalkAction* event) {
 }
 
 TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type, const std::string& words) const {
+	// Every talkaction whose words start the text, tried in map order as before
+	std::vector<TalkActionMap::const_iterator> candidates;
+	talkActionWords.forEachPrefix(words, [&candidates](TalkActionMap::const_iterator it) {
+		candidates.push_back(it);
+	});
+	if (candidates.size() > 1) {
+		std::sort(candidates.begin(), candidates.end(), [](TalkActionMap::const_iterator lhs, TalkActionMap::const_iterator rhs) {
+			return lhs->first < rhs->first;
+		});
+	}
+
 	size_t wordsLength = words.length();
-	for (auto it = talkActions.begin(); it != talkActions.end(); ) {
-		const std::string& talkactionWords = it->first;
-		size_t talkactionLength = talkactionWords.length();
-		if (wordsLength < talkactionLength || strncasecmp(words.c_str(), talkactionWords.c_str(), talkactionLength) != 0) {
-			++it;
-			continue;
-		}
+	for (auto it : candidates) {
+		size_t talkactionLength = it->first.length();
 
 		std::string param;
 		if (wordsLength != talkactionLength) {
 			param = words.substr(talkactionLength);
 			if (param.front() != ' ') {
-				++it;
 				continue;
 			}
 			trim_left(param, ' ');
@@ -58,7 +69,6 @@ TalkActionResult_t TalkActions::playerSaySpell(Player* player, SpeakClasses type
 			if (separator != " ") {
 				if (!param.empty()) {
 					if (param != separator) {
-						++it;
 						continue;
 					} else {
 						param.erase(param.begin());
@@ -15,6 +15,7 @@
 #include "declarations.hpp"
 #include "lua/scripts/luascript.h"
 #include "lua/scripts/scripts.h"
+#include "utils/prefix_tree.hpp"
 
 class TalkAction;
 using TalkAction_ptr = std::unique_ptr<TalkAction>;
@@ -76,7 +77,11 @@ class TalkActions final : public Scripts {
 		void clear();
 
 	private:
-		std::map<std::string, TalkAction> talkActions;
+		using TalkActionMap = std::map<std::string, TalkAction>;
+
+		TalkActionMap talkActions;
+		// Words of talkActions, rebuilt as they are registered
+		PrefixTree<TalkActionMap::const_iterator> talkActionWords;
 };
 
 constexpr auto g_talkActions = &TalkActions::getInstance;
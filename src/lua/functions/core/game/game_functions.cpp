@@ -11,16 +11,23 @@
 
 #include "core.hpp"
 #include "creatures/monsters/monster.h"
+#include "database/databasetasks.h"
 #include "game/functions/game_reload.hpp"
 #include "game/game.h"
 #include "items/item.h"
 #include "io/iobestiary.h"
+#include "items/decay/decay.h"
 #include "io/iologindata.h"
+#include "io/playerloader.h"
 #include "lua/functions/core/game/game_functions.hpp"
+#include "game/scheduling/scheduler.h"
 #include "game/scheduling/tasks.h"
 #include "lua/functions/creatures/npc/npc_type_functions.hpp"
 #include "lua/scripts/lua_environment.hpp"
 #include "lua/scripts/scripts.h"
+#include "server/network/message/networkmessage.h"
+#include "server/network/protocol/protocol.h"
+#include "utils/block_pool.hpp"
 
 // Game
 int GameFunctions::luaGameCreateMonsterType(lua_State* L) {
@@ -59,7 +66,7 @@ int GameFunctions::luaGameGetSpectators(lua_State* L) {
 	int32_t minRangeY = getNumber<int32_t>(L, 6, 0);
 	int32_t maxRangeY = getNumber<int32_t>(L, 7, 0);
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	g_game().map.getSpectators(spectators, position, multifloor, onlyPlayers, minRangeX, maxRangeX, minRangeY, maxRangeY);
 
 	lua_createtable(L, spectators.size(), 0);
@@ -664,3 +671,132 @@ int GameFunctions::luaGameGetFiendishMonsters(lua_State *L) {
 
 	return 1;
 }
+
+int GameFunctions::luaGameGetDispatcherStats(lua_State* L) {
+	// Game.getDispatcherStats()
+	const DispatcherStats stats = g_dispatcher().getStats();
+	lua_createtable(L, 0, 4);
+	setField(L, "queueDepth", stats.queueDepth);
+	setField(L, "executedTasks", stats.executedTasks);
+	setField(L, "averageLatency", stats.averageLatency);
+	setField(L, "maxLatency", stats.maxLatency);
+	return 1;
+}
+
+int GameFunctions::luaGameGetSchedulerStats(lua_State* L) {
+	// Game.getSchedulerStats()
+	const SchedulerStats stats = g_scheduler().getStats();
+	lua_createtable(L, 0, 4);
+
+	lua_createtable(L, static_cast<int>(stats.pendingEvents.size()), 0);
+	int index = 0;
+	for (uint64_t pending : stats.pendingEvents) {
+		lua_pushnumber(L, static_cast<lua_Number>(pending));
+		lua_rawseti(L, -2, ++index);
+	}
+	lua_setfield(L, -2, "pendingEvents");
+
+	setField(L, "executedEvents", stats.executedEvents);
+	setField(L, "cancelledEvents", stats.cancelledEvents);
+	setField(L, "dispatchedBatches", stats.dispatchedBatches);
+	return 1;
+}
+
+int GameFunctions::luaGameGetMessageBufferStats(lua_State* L) {
+	// Game.getMessageBufferStats()
+	const auto stats = NetworkMessage::getBufferStats();
+	lua_createtable(L, static_cast<int>(stats.size()), 0);
+	for (size_t i = 0; i < stats.size(); ++i) {
+		const BlockPoolStats &poolStats = stats[i];
+		lua_createtable(L, 0, 4);
+		setField(L, "size", NetworkMessage::BUFFER_SIZE_CLASSES[i]);
+		setField(L, "requests", poolStats.requests);
+		setField(L, "hitRate", poolStats.requests != 0 ? static_cast<double>(poolStats.hits) / poolStats.requests : 1.0);
+		setField(L, "residentBytes", poolStats.residentBlocks * NetworkMessage::BUFFER_SIZE_CLASSES[i]);
+		lua_rawseti(L, -2, static_cast<int>(i + 1));
+	}
+	return 1;
+}
+
+int GameFunctions::luaGameGetCompressionStats(lua_State* L) {
+	// Game.getCompressionStats()
+	const CompressionStats stats = Protocol::getCompressionStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "compressedMessages", stats.compressedMessages);
+	setField(L, "skippedMessages", stats.skippedMessages);
+	setField(L, "bytesIn", stats.bytesIn);
+	setField(L, "bytesOut", stats.bytesOut);
+	setField(L, "bytesSaved", stats.bytesIn - stats.bytesOut);
+	setField(L, "microseconds", stats.microseconds);
+	return 1;
+}
+
+int GameFunctions::luaGameGetLoginStats(lua_State* L) {
+	// Game.getLoginStats()
+	const LoginStats stats = g_playerLoader().getLoginStats();
+	lua_createtable(L, 0, 5);
+	setField(L, "logins", stats.logins);
+	setField(L, "p50", stats.p50);
+	setField(L, "p90", stats.p90);
+	setField(L, "p99", stats.p99);
+	setField(L, "max", stats.max);
+	return 1;
+}
+
+int GameFunctions::luaGameGetPlayerSaveStats(lua_State* L) {
+	// Game.getPlayerSaveStats()
+	const PlayerSaveStats stats = IOLoginData::getSaveStats();
+	lua_createtable(L, 0, 3);
+	setField(L, "saves", stats.saves);
+	setField(L, "rows", stats.rows);
+	setField(L, "lastRows", stats.lastRows);
+	return 1;
+}
+
+int GameFunctions::luaGameGetServerSaveStats(lua_State* L) {
+	// Game.getServerSaveStats()
+	const ServerSaveStats &stats = g_game().getServerSaveStats();
+	lua_createtable(L, 0, 3);
+	setField(L, "saves", stats.saves);
+	setField(L, "pause", stats.pause);
+	setField(L, "duration", stats.duration);
+	return 1;
+}
+
+int GameFunctions::luaGameGetDatabaseTaskStats(lua_State* L) {
+	// Game.getDatabaseTaskStats()
+	const DatabaseTaskStats stats = g_databaseTasks().getStats();
+	lua_createtable(L, 0, 7);
+	setField(L, "tasks", stats.tasks);
+	setField(L, "rows", stats.rows);
+	setField(L, "statements", stats.statements);
+	setField(L, "queued", stats.queued);
+	setField(L, "p50", stats.p50);
+	setField(L, "p99", stats.p99);
+	setField(L, "max", stats.max);
+	return 1;
+}
+
+int GameFunctions::luaGameGetDecayStats(lua_State* L) {
+	// Game.getDecayStats()
+	const DecayStats stats = g_decay().getStats();
+	lua_createtable(L, 0, 5);
+	setField(L, "decayingItems", stats.decayingItems);
+	setField(L, "decayedItems", stats.decayedItems);
+	setField(L, "ticks", stats.ticks);
+	setField(L, "lastTick", stats.lastTick);
+	setField(L, "maxTick", stats.maxTick);
+	return 1;
+}
+
+int GameFunctions::luaGameGetCreatureActivityStats(lua_State* L) {
+	// Game.getCreatureActivityStats()
+	const CreatureActivityStats stats = g_game().getCreatureActivityStats();
+	lua_createtable(L, 0, 5);
+	setField(L, "activeCreatures", stats.activeCreatures);
+	setField(L, "sleepingCreatures", stats.sleepingCreatures);
+	setField(L, "wokenCreatures", stats.wokenCreatures);
+	setField(L, "lastThink", stats.lastThink);
+	setField(L, "maxThink", stats.maxThink);
+	return 1;
+}
@@ -73,6 +73,17 @@ class GameFunctions final : LuaScriptInterface {
 				registerMethod(L, "Game", "makeFiendishMonster", GameFunctions::luaGameMakeFiendishMonster);
 				registerMethod(L, "Game", "removeFiendishMonster", GameFunctions::luaGameRemoveFiendishMonster);
 				registerMethod(L, "Game", "getFiendishMonsters", GameFunctions::luaGameGetFiendishMonsters);
+
+				registerMethod(L, "Game", "getDispatcherStats", GameFunctions::luaGameGetDispatcherStats);
+				registerMethod(L, "Game", "getSchedulerStats", GameFunctions::luaGameGetSchedulerStats);
+				registerMethod(L, "Game", "getMessageBufferStats", GameFunctions::luaGameGetMessageBufferStats);
+				registerMethod(L, "Game", "getCompressionStats", GameFunctions::luaGameGetCompressionStats);
+				registerMethod(L, "Game", "getLoginStats", GameFunctions::luaGameGetLoginStats);
+				registerMethod(L, "Game", "getPlayerSaveStats", GameFunctions::luaGameGetPlayerSaveStats);
+				registerMethod(L, "Game", "getServerSaveStats", GameFunctions::luaGameGetServerSaveStats);
+				registerMethod(L, "Game", "getDatabaseTaskStats", GameFunctions::luaGameGetDatabaseTaskStats);
+				registerMethod(L, "Game", "getDecayStats", GameFunctions::luaGameGetDecayStats);
+				registerMethod(L, "Game", "getCreatureActivityStats", GameFunctions::luaGameGetCreatureActivityStats);
 			}
 
 	private:
@@ -132,6 +143,17 @@ class GameFunctions final : LuaScriptInterface {
 			static int luaGameMakeFiendishMonster(lua_State *L);
 			static int luaGameRemoveFiendishMonster(lua_State *L);
 			static int luaGameGetFiendishMonsters(lua_State *L);
+
+			static int luaGameGetDispatcherStats(lua_State* L);
+			static int luaGameGetSchedulerStats(lua_State* L);
+			static int luaGameGetMessageBufferStats(lua_State* L);
+			static int luaGameGetCompressionStats(lua_State* L);
+			static int luaGameGetLoginStats(lua_State* L);
+			static int luaGameGetPlayerSaveStats(lua_State* L);
+			static int luaGameGetServerSaveStats(lua_State* L);
+			static int luaGameGetDatabaseTaskStats(lua_State* L);
+			static int luaGameGetDecayStats(lua_State* L);
+			static int luaGameGetCreatureActivityStats(lua_State* L);
 };
 
 #endif  // SRC_LUA_FUNCTIONS_CORE_GAME_GAME_FUNCTIONS_HPP_
@@ -190,7 +190,7 @@ int NpcFunctions::luaNpcSay(lua_State* L) {
 		return 1;
 	}
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	if (target) {
 		spectators.insert(target);
 	}
@@ -198,6 +198,8 @@ int ItemFunctions::luaItemSetActionId(lua_State* L) {
 	Item* item = getUserdata<Item>(L, 1);
 	if (item) {
 		item->setAttribute(ItemAttribute_t::ACTIONID, actionId);
+		item->markHouseDirty();
+		item->markTileChanged();
 		pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -383,6 +385,10 @@ int ItemFunctions::luaItemSetAttribute(lua_State* L) {
 		return 1;
 	}
 
+	// House items and tile descriptions are only refreshed when marked, attributes are not tracked otherwise
+	item->markHouseDirty();
+	item->markTileChanged();
+
 	ItemAttribute_t attribute;
 	if (isNumber(L, 2)) {
 		attribute = getNumber<ItemAttribute_t>(L, 2);
@@ -457,6 +463,8 @@ int ItemFunctions::luaItemRemoveAttribute(lua_State* L) {
 			auto noConstItem = std::bit_cast<Item*>(item);
 			if (noConstItem) {
 				noConstItem->removeAttribute(attribute);
+				noConstItem->markHouseDirty();
+				noConstItem->markTileChanged();
 			}
 		} else {
 			reportErrorFunc("Attempt to erase protected key \"duration timestamp\"");
@@ -502,6 +510,9 @@ int ItemFunctions::luaItemSetCustomAttribute(lua_State* L) {
 		return 1;
 	}
 
+	item->markHouseDirty();
+	item->markTileChanged();
+
 	std::string key;
 	if (isNumber(L, 2)) {
 		key = std::to_string(getNumber<int64_t>(L, 2));
@@ -543,6 +554,9 @@ int ItemFunctions::luaItemRemoveCustomAttribute(lua_State* L) {
 		return 1;
 	}
 
+	item->markHouseDirty();
+	item->markTileChanged();
+
 	if (isNumber(L, 2)) {
 		pushBoolean(L, item->removeCustomAttribute(std::to_string(getNumber<int64_t>(L, 2))));
 	} else if (isString(L, 2)) {
@@ -829,6 +843,8 @@ int ItemFunctions::luaItemSetDuration(lua_State* L) {
 	it.showDuration = showDuration;
 	it.decayTo = itemid;
 	item->startDecaying();
+	item->markHouseDirty();
+	item->markTileChanged();
 	pushBoolean(L, true);
 	return 1;
 }
@@ -869,6 +885,8 @@ int ItemFunctions::luaItemSetTier(lua_State* L) {
 	}
 
 	item->setTier(getNumber<uint8_t>(L, 2));
+	item->markHouseDirty();
+	item->markTileChanged();
 	pushBoolean(L, true);
 	return 1;
 }
@@ -13,6 +13,7 @@
 #include "game/game.h"
 #include "game/movement/position.h"
 #include "io/iologindata.h"
+#include "io/iomapserialize.h"
 #include "lua/functions/map/house_functions.hpp"
 #include "map/house/house.h"
 
@@ -248,6 +249,8 @@ int HouseFunctions::luaHouseGetTiles(lua_State* L) {
 		return 1;
 	}
 
+	IOMapSerialize::loadHouseItems(house);
+
 	const auto& tiles = house->getTiles();
 	lua_newtable(L);
 
@@ -268,6 +271,8 @@ int HouseFunctions::luaHouseGetItems(lua_State* L) {
 		return 1;
 	}
 
+	IOMapSerialize::loadHouseItems(house);
+
 	const auto& tiles = house->getTiles();
 	lua_newtable(L);
 
@@ -12,6 +12,7 @@
 #include "utils/pugicast.h"
 #include "map/house/house.h"
 #include "io/iologindata.h"
+#include "io/iomapserialize.h"
 #include "game/game.h"
 #include "items/bed.h"
 
@@ -40,6 +41,8 @@ void House::setOwner(uint32_t guid, bool updateDatabase/* = true*/, Player* play
 	isLoaded = true;
 
 	if (owner != 0) {
+		IOMapSerialize::loadHouseItems(this);
+
 		// Send items to depot
 		if (player) {
 			transferToDepot(player);
@@ -767,3 +770,37 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 		IOLoginData::savePlayer(&player);
 	}
 }
+
+void Houses::addPendingHouse(House* house)
+{
+	phmap::flat_hash_set<uint32_t> cells;
+	for (const HouseTile* tile : house->getTiles()) {
+		const Position& pos = tile->getPosition();
+		cells.insert(getCellKey(pos.x >> PENDING_CELL_SHIFT, pos.y >> PENDING_CELL_SHIFT));
+	}
+
+	for (uint32_t cell : cells) {
+		pendingCells[cell].push_back(house);
+	}
+}
+
+void Houses::loadPendingHouses(const Position& pos)
+{
+	const uint32_t cellX = pos.x >> PENDING_CELL_SHIFT;
+	const uint32_t cellY = pos.y >> PENDING_CELL_SHIFT;
+	for (uint32_t x = std::max<uint32_t>(cellX, 1) - 1; x <= cellX + 1; ++x) {
+		for (uint32_t y = std::max<uint32_t>(cellY, 1) - 1; y <= cellY + 1; ++y) {
+			auto it = pendingCells.find(getCellKey(x, y));
+			if (it == pendingCells.end()) {
+				continue;
+			}
+
+			// A house spanning several cells is loaded by the first one, the others find nothing left
+			std::vector<House*> houses = std::move(it->second);
+			pendingCells.erase(it);
+			for (House* house : houses) {
+				IOMapSerialize::loadHouseItems(house);
+			}
+		}
+	}
+}
@@ -199,6 +199,25 @@ class House
 			return static_cast<uint32_t>(std::ceil(bedsList.size() / 2.)); //each bed takes 2 sqms of space, ceil is just for bad maps
 		}
 
+		// Set whenever an item on the house tiles changes, the next save only writes dirty houses
+		void setDirty(bool value) {
+			dirty = value;
+		}
+		bool isDirty() const {
+			return dirty;
+		}
+
+		// Stored tiles that are not loaded yet, see lazyLoadHouseItems
+		void addPendingItems(std::string data) {
+			pendingItems.emplace_back(std::move(data));
+		}
+		bool hasPendingItems() const {
+			return !pendingItems.empty();
+		}
+		std::vector<std::string> takePendingItems() {
+			return std::exchange(pendingItems, {});
+		}
+
 	private:
 		bool transferToDepot() const;
 		bool transferToDepot(Player* player) const;
@@ -211,6 +230,7 @@ class House
 		HouseTileList houseTiles;
 		std::list<Door*> doorList;
 		HouseBedItemList bedsList;
+		std::vector<std::string> pendingItems;
 
 		std::string houseName;
 		std::string ownerName;
@@ -229,6 +249,7 @@ class House
 		Position posEntry = {};
 
 		bool isLoaded = false;
+		bool dirty = false;
 };
 
 using HouseMap = std::map<uint32_t, House*>;
@@ -272,12 +293,26 @@ class Houses
 
 		void payHouses(RentPeriod_t rentPeriod) const;
 
+		void addPendingHouse(House* house);
+		void loadPendingHouses(const Position& pos);
+		bool hasPendingHouses() const {
+			return !pendingCells.empty();
+		}
+
 		const HouseMap& getHouses() const {
 			return houseMap;
 		}
 
 	private:
+		static uint32_t getCellKey(uint32_t cellX, uint32_t cellY) {
+			return (cellX << 16) | cellY;
+		}
+
+		// Houses are loaded once a player gets within one cell of them, which is more than the client sees
+		static constexpr uint16_t PENDING_CELL_SHIFT = 5;
+
 		HouseMap houseMap;
+		phmap::flat_hash_map<uint32_t, std::vector<House*>> pendingCells;
 };
 
 #endif  // SRC_MAP_HOUSE_HOUSE_H_
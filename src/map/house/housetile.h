@@ -31,7 +31,7 @@ class HouseTile final : public DynamicTile
 		void addThing(int32_t index, Thing* thing) override;
 		void virtual internalAddThing(uint32_t index, Thing* thing) override;
 
-		House* getHouse() {
+		House* getHouse() override {
 			return house;
 		}
 
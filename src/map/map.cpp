@@ -16,6 +16,9 @@
 #include "game/game.h"
 #include "creatures/monsters/monster.h"
 
+static_assert(SpectatorGrid::CACHE_REACH >= std::max(Map::maxViewportX, Map::maxViewportY) + MAP_INIT_SURFACE_LAYER,
+	"Cached spectators would not be cleared for every creature they can see");
+
 bool Map::load(const std::string& identifier, const Position& pos, bool unload) {
 	try {
 		IOMap loader;
@@ -228,6 +231,10 @@ void Map::setTile(uint16_t x, uint16_t y, uint8_t z, Tile* newTile)
 
 bool Map::placeCreature(const Position& centerPos, Creature* creature, bool extendedPos/* = false*/, bool forceLogin/* = false*/)
 {
+	if (creature->getPlayer() && houses.hasPendingHouses()) {
+		houses.loadPendingHouses(centerPos);
+	}
+
 	Monster* monster = creature->getMonster();
 	if (monster) {
 		monster->ignoreFieldDamage = true;
@@ -309,8 +316,10 @@ bool Map::placeCreature(const Position& centerPos, Creature* creature, bool exte
 	Cylinder* toCylinder = tile->queryDestination(index, *creature, &toItem, flags);
 	toCylinder->internalAddThing(creature);
 
-	const Position& dest = toCylinder->getPosition();
-	getQTNode(dest.x, dest.y)->addCreature(creature);
+	spectatorGrid.addCreature(creature, toCylinder->getPosition());
+	if (creature->getPlayer()) {
+		g_game().wakeCreatures(toCylinder->getPosition());
+	}
 	return true;
 }
 
@@ -321,9 +330,14 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	Position oldPos = oldTile.getPosition();
 	Position newPos = newTile.getPosition();
 
+	// The houses around have to be there before the player is shown the new area
+	if (creature.getPlayer() && houses.hasPendingHouses()) {
+		houses.loadPendingHouses(newPos);
+	}
+
 	bool teleport = forceTeleport || !newTile.getGround() || !Position::areInRange<1, 1, 0>(oldPos, newPos);
 
-	SpectatorHashSet spectators;
+	SpectatorVec spectators;
 	getSpectators(spectators, oldPos, true);
 	getSpectators(spectators, newPos, true);
 
@@ -338,16 +352,17 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 		}
 	}
 
+	// Sleeping creatures are found by the sector they fell asleep in
+	if (creature.isSleeping()) {
+		g_game().wakeCreature(&creature);
+	}
+
 	//remove the creature
 	oldTile.removeThing(&creature, 0);
 
-	QTreeLeafNode* leaf = getQTNode(oldPos.x, oldPos.y);
-	QTreeLeafNode* new_leaf = getQTNode(newPos.x, newPos.y);
-
-	// Switch the node ownership
-	if (leaf != new_leaf) {
-		leaf->removeCreature(&creature);
-		new_leaf->addCreature(&creature);
+	spectatorGrid.moveCreature(&creature, oldPos, newPos);
+	if (creature.getPlayer() && !SpectatorGrid::isSameReach(oldPos, newPos)) {
+		g_game().wakeCreatures(newPos);
 	}
 
 	//add the creature
@@ -388,69 +403,12 @@ void Map::moveCreature(Creature& creature, Tile& newTile, bool forceTeleport/* =
 	newTile.postAddNotification(&creature, &oldTile, 0);
 }
 
-void Map::getSpectatorsInternal(SpectatorHashSet& spectators, const Position& centerPos, int32_t minRangeX, int32_t maxRangeX, int32_t minRangeY, int32_t maxRangeY, int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const
-{
-	int_fast32_t min_y = centerPos.y + minRangeY;
-	int_fast32_t min_x = centerPos.x + minRangeX;
-	int_fast32_t max_y = centerPos.y + maxRangeY;
-	int_fast32_t max_x = centerPos.x + maxRangeX;
-
-	int32_t minoffset = centerPos.getZ() - maxRangeZ;
-	uint16_t x1 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_x + minoffset)));
-	uint16_t y1 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (min_y + minoffset)));
-
-	int32_t maxoffset = centerPos.getZ() - minRangeZ;
-	uint16_t x2 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_x + maxoffset)));
-	uint16_t y2 = std::min<uint32_t>(0xFFFF, std::max<int32_t>(0, (max_y + maxoffset)));
-
-	int32_t startx1 = x1 - (x1 % FLOOR_SIZE);
-	int32_t starty1 = y1 - (y1 % FLOOR_SIZE);
-	int32_t endx2 = x2 - (x2 % FLOOR_SIZE);
-	int32_t endy2 = y2 - (y2 % FLOOR_SIZE);
-
-	const QTreeLeafNode* startLeaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, starty1);
-	const QTreeLeafNode* leafS = startLeaf;
-	const QTreeLeafNode* leafE;
-
-	for (int_fast32_t ny = starty1; ny <= endy2; ny += FLOOR_SIZE) {
-		leafE = leafS;
-		for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
-			if (leafE) {
-				const CreatureVector& node_list = (onlyPlayers ? leafE->player_list : leafE->creature_list);
-				for (Creature* creature : node_list) {
-					const Position& cpos = creature->getPosition();
-					if (minRangeZ > cpos.z || maxRangeZ < cpos.z) {
-						continue;
-					}
-
-					int_fast16_t offsetZ = Position::getOffsetZ(centerPos, cpos);
-					if ((min_y + offsetZ) > cpos.y || (max_y + offsetZ) < cpos.y || (min_x + offsetZ) > cpos.x || (max_x + offsetZ) < cpos.x) {
-						continue;
-					}
-
-					spectators.insert(creature);
-				}
-				leafE = leafE->leafE;
-			} else {
-				leafE = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, nx + FLOOR_SIZE, ny);
-			}
-		}
-
-		if (leafS) {
-			leafS = leafS->leafS;
-		} else {
-			leafS = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, startx1, ny + FLOOR_SIZE);
-		}
-	}
-}
-
-void Map::getSpectators(SpectatorHashSet& spectators, const Position& centerPos, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/)
+void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor /*= false*/, bool onlyPlayers /*= false*/, int32_t minRangeX /*= 0*/, int32_t maxRangeX /*= 0*/, int32_t minRangeY /*= 0*/, int32_t maxRangeY /*= 0*/)
 {
 	if (centerPos.z >= MAP_MAX_LAYERS) {
 		return;
 	}
 
-	bool foundCache = false;
 	bool cacheResult = false;
 
 	minRangeX = (minRangeX == 0 ? -maxViewportX : -minRangeX);
@@ -459,88 +417,68 @@ void Map::getSpectators(SpectatorHashSet& spectators, const Position& centerPos,
 	maxRangeY = (maxRangeY == 0 ? maxViewportY : maxRangeY);
 
 	if (minRangeX == -maxViewportX && maxRangeX == maxViewportX && minRangeY == -maxViewportY && maxRangeY == maxViewportY && multifloor) {
-		if (onlyPlayers) {
-			auto it = playersSpectatorCache.find(centerPos);
-			if (it != playersSpectatorCache.end()) {
-				if (!spectators.empty()) {
-					const SpectatorHashSet& cachedSpectators = it->second;
-					spectators.insert(cachedSpectators.begin(), cachedSpectators.end());
-				} else {
-					spectators = it->second;
-				}
-
-				foundCache = true;
-			}
+		if (const SpectatorVec* cachedSpectators = spectatorGrid.getCachedSpectators(centerPos, onlyPlayers)) {
+			spectators.mergeSpectators(*cachedSpectators);
+			return;
 		}
 
-		if (!foundCache) {
-			auto it = spectatorCache.find(centerPos);
-			if (it != spectatorCache.end()) {
-				if (!onlyPlayers) {
-					if (!spectators.empty()) {
-						const SpectatorHashSet& cachedSpectators = it->second;
-						spectators.insert(cachedSpectators.begin(), cachedSpectators.end());
-					} else {
-						spectators = it->second;
-					}
-				} else {
-					const SpectatorHashSet& cachedSpectators = it->second;
-					for (Creature* spectator : cachedSpectators) {
-						if (spectator->getPlayer()) {
-							spectators.insert(spectator);
-						}
+		if (onlyPlayers) {
+			// Players are a subset of the cached creatures
+			if (const SpectatorVec* cachedSpectators = spectatorGrid.getCachedSpectators(centerPos, false)) {
+				size_t previousCount = spectators.size();
+				for (Creature* spectator : *cachedSpectators) {
+					if (spectator->getPlayer()) {
+						spectators.push_back(spectator);
 					}
 				}
-
-				foundCache = true;
-			} else {
-				cacheResult = true;
+				spectators.removeDuplicates(previousCount);
+				return;
 			}
 		}
+
+		cacheResult = true;
 	}
 
-	if (!foundCache) {
-		int32_t minRangeZ;
-		int32_t maxRangeZ;
+	int32_t minRangeZ;
+	int32_t maxRangeZ;
 
-		if (multifloor) {
-			if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
-				//underground
+	if (multifloor) {
+		if (centerPos.z > MAP_INIT_SURFACE_LAYER) {
+			//underground
 
-				//8->15
-				minRangeZ = std::max<int32_t>(centerPos.getZ() - MAP_LAYER_VIEW_LIMIT, 0);
-				maxRangeZ = std::min<int32_t>(centerPos.getZ() + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
-				minRangeZ = 0;
-				maxRangeZ = (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT;
-			} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
-				minRangeZ = 0;
-				maxRangeZ = MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = MAP_INIT_SURFACE_LAYER;
-			}
+			//8->15
+			minRangeZ = std::max<int32_t>(centerPos.getZ() - MAP_LAYER_VIEW_LIMIT, 0);
+			maxRangeZ = std::min<int32_t>(centerPos.getZ() + MAP_LAYER_VIEW_LIMIT, MAP_MAX_LAYERS - 1);
+		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER - 1) {
+			minRangeZ = 0;
+			maxRangeZ = (MAP_INIT_SURFACE_LAYER - 1) + MAP_LAYER_VIEW_LIMIT;
+		} else if (centerPos.z == MAP_INIT_SURFACE_LAYER) {
+			minRangeZ = 0;
+			maxRangeZ = MAP_INIT_SURFACE_LAYER + MAP_LAYER_VIEW_LIMIT;
 		} else {
-			minRangeZ = centerPos.z;
-			maxRangeZ = centerPos.z;
+			minRangeZ = 0;
+			maxRangeZ = MAP_INIT_SURFACE_LAYER;
 		}
+	} else {
+		minRangeZ = centerPos.z;
+		maxRangeZ = centerPos.z;
+	}
 
-		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
-
-		if (cacheResult) {
-			if (onlyPlayers) {
-				playersSpectatorCache[centerPos] = spectators;
-			} else {
-				spectatorCache[centerPos] = spectators;
-			}
-		}
+	if (!cacheResult) {
+		spectatorGrid.getSpectators(spectators, centerPos, centerPos.x + minRangeX, centerPos.x + maxRangeX, centerPos.y + minRangeY, centerPos.y + maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		return;
 	}
-}
 
-void Map::clearSpectatorCache()
-{
-	spectatorCache.clear();
-	playersSpectatorCache.clear();
+	// The cache must only hold this query, not what the caller had before
+	if (spectators.empty()) {
+		spectatorGrid.getSpectators(spectators, centerPos, centerPos.x + minRangeX, centerPos.x + maxRangeX, centerPos.y + minRangeY, centerPos.y + maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		spectatorGrid.setCachedSpectators(centerPos, onlyPlayers, spectators);
+	} else {
+		SpectatorVec found;
+		spectatorGrid.getSpectators(found, centerPos, centerPos.x + minRangeX, centerPos.x + maxRangeX, centerPos.y + minRangeY, centerPos.y + maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+		spectatorGrid.setCachedSpectators(centerPos, onlyPlayers, found);
+		spectators.mergeSpectators(found);
+	}
 }
 
 bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight /*= true*/,
@@ -1019,19 +957,121 @@ bool Map::getPathMatching(const Position& start, std::forward_list<Direction>& d
 
 // AStarNodes
 
+namespace {
+
+// Nodes are looked up by position in a grid centered on the start of the
+// search. The grid is shared by the searches of a thread and never cleared:
+// a cell only counts if it was written during the current search.
+constexpr int32_t NODE_GRID_BITS = 8;
+constexpr int32_t NODE_GRID_SIZE = 1 << NODE_GRID_BITS;
+constexpr uint32_t NODE_INDEX_BITS = 10;
+static_assert(MAX_NODES <= (1 << NODE_INDEX_BITS));
+
+struct NodeGrid {
+	// Search generation in the high bits, node index in the low ones
+	std::vector<uint32_t> cells = std::vector<uint32_t>(NODE_GRID_SIZE * NODE_GRID_SIZE, 0);
+	uint32_t generation = 0;
+
+	void nextSearch() {
+		if (++generation == (1U << (32 - NODE_INDEX_BITS))) {
+			std::fill(cells.begin(), cells.end(), 0);
+			generation = 1;
+		}
+	}
+
+	// nullptr if the position is outside the grid
+	uint32_t* getCell(uint32_t startX, uint32_t startY, uint32_t x, uint32_t y) {
+		uint32_t gridX = x - startX + NODE_GRID_SIZE / 2;
+		uint32_t gridY = y - startY + NODE_GRID_SIZE / 2;
+		if (gridX >= NODE_GRID_SIZE || gridY >= NODE_GRID_SIZE) {
+			return nullptr;
+		}
+		return &cells[(gridY << NODE_GRID_BITS) | gridX];
+	}
+};
+
+NodeGrid &getNodeGrid()
+{
+	thread_local NodeGrid grid;
+	return grid;
+}
+
+}  // namespace
+
 AStarNodes::AStarNodes(uint32_t x, uint32_t y)
-	: nodes(), openNodes()
+	: startX(x), startY(y)
 {
-	curNode = 1;
+	getNodeGrid().nextSearch();
+
+	curNode = 0;
 	closedNodes = 0;
-	openNodes[0] = true;
-
-	AStarNode& startNode = nodes[0];
-	startNode.parent = nullptr;
-	startNode.x = x;
-	startNode.y = y;
-	startNode.f = 0;
-	nodeTable[(x << 16) | y] = nodes;
+	createOpenNode(nullptr, x, y, 0);
+}
+
+bool AStarNodes::isBetterNode(uint16_t a, uint16_t b) const
+{
+	return nodes[a].f < nodes[b].f || (nodes[a].f == nodes[b].f && a < b);
+}
+
+void AStarNodes::siftUp(size_t position)
+{
+	uint16_t index = openHeap[position];
+	while (position > 0) {
+		size_t parent = (position - 1) / 2;
+		if (!isBetterNode(index, openHeap[parent])) {
+			break;
+		}
+		openHeap[position] = openHeap[parent];
+		heapPositions[openHeap[position]] = static_cast<int16_t>(position);
+		position = parent;
+	}
+	openHeap[position] = index;
+	heapPositions[index] = static_cast<int16_t>(position);
+}
+
+void AStarNodes::siftDown(size_t position)
+{
+	uint16_t index = openHeap[position];
+	while (true) {
+		size_t child = position * 2 + 1;
+		if (child >= openCount) {
+			break;
+		}
+		if (child + 1 < openCount && isBetterNode(openHeap[child + 1], openHeap[child])) {
+			++child;
+		}
+		if (!isBetterNode(openHeap[child], index)) {
+			break;
+		}
+		openHeap[position] = openHeap[child];
+		heapPositions[openHeap[position]] = static_cast<int16_t>(position);
+		position = child;
+	}
+	openHeap[position] = index;
+	heapPositions[index] = static_cast<int16_t>(position);
+}
+
+void AStarNodes::pushOpenNode(uint16_t index)
+{
+	openHeap[openCount] = index;
+	siftUp(openCount++);
+}
+
+void AStarNodes::removeOpenNode(uint16_t index)
+{
+	auto position = static_cast<size_t>(heapPositions[index]);
+	heapPositions[index] = -1;
+	if (position == --openCount) {
+		return;
+	}
+
+	// Fill the hole with the last node, which can belong either above or below it
+	openHeap[position] = openHeap[openCount];
+	if (position > 0 && isBetterNode(openHeap[position], openHeap[(position - 1) / 2])) {
+		siftUp(position);
+	} else {
+		siftDown(position);
+	}
 }
 
 AStarNode* AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y, int_fast32_t f)
@@ -1040,44 +1080,36 @@ AStarNode* AStarNodes::createOpenNode(AStarNode* parent, uint32_t x, uint32_t y,
 		return nullptr;
 	}
 
-	size_t retNode = curNode++;
-	openNodes[retNode] = true;
-
+	auto retNode = static_cast<uint16_t>(curNode++);
 	AStarNode* node = nodes + retNode;
-	nodeTable[(x << 16) | y] = node;
 	node->parent = parent;
 	node->x = x;
 	node->y = y;
 	node->f = f;
+	pushOpenNode(retNode);
+
+	NodeGrid &grid = getNodeGrid();
+	if (uint32_t* cell = grid.getCell(startX, startY, x, y)) {
+		*cell = (grid.generation << NODE_INDEX_BITS) | retNode;
+	}
 	return node;
 }
 
 AStarNode* AStarNodes::getBestNode()
 {
-	if (curNode == 0) {
+	if (openCount == 0) {
 		return nullptr;
 	}
-
-	int32_t best_node_f = std::numeric_limits<int32_t>::max();
-	int32_t best_node = -1;
-	for (size_t i = 0; i < curNode; i++) {
-		if (openNodes[i] && nodes[i].f < best_node_f) {
-			best_node_f = nodes[i].f;
-			best_node = i;
-		}
-	}
-
-	if (best_node >= 0) {
-		return nodes + best_node;
-	}
-	return nullptr;
+	return nodes + openHeap[0];
 }
 
 void AStarNodes::closeNode(AStarNode* node)
 {
 	size_t index = node - nodes;
 	assert(index < MAX_NODES);
-	openNodes[index] = false;
+	if (heapPositions[index] >= 0) {
+		removeOpenNode(static_cast<uint16_t>(index));
+	}
 	++closedNodes;
 }
 
@@ -1085,9 +1117,12 @@ void AStarNodes::openNode(AStarNode* node)
 {
 	size_t index = node - nodes;
 	assert(index < MAX_NODES);
-	if (!openNodes[index]) {
-		openNodes[index] = true;
+	if (heapPositions[index] < 0) {
+		pushOpenNode(static_cast<uint16_t>(index));
 		--closedNodes;
+	} else {
+		// Its f only decreases
+		siftUp(static_cast<size_t>(heapPositions[index]));
 	}
 }
 
@@ -1098,11 +1133,21 @@ int_fast32_t AStarNodes::getClosedNodes() const
 
 AStarNode* AStarNodes::getNodeByPosition(uint32_t x, uint32_t y)
 {
-	auto it = nodeTable.find((x << 16) | y);
-	if (it == nodeTable.end()) {
-		return nullptr;
+	NodeGrid &grid = getNodeGrid();
+	if (const uint32_t* cell = grid.getCell(startX, startY, x, y)) {
+		if ((*cell >> NODE_INDEX_BITS) != grid.generation) {
+			return nullptr;
+		}
+		return nodes + (*cell & ((1U << NODE_INDEX_BITS) - 1));
 	}
-	return it->second;
+
+	// Far away from the start, only long corridors get here
+	for (size_t i = 0; i < curNode; ++i) {
+		if (nodes[i].x == x && nodes[i].y == y) {
+			return nodes + i;
+		}
+	}
+	return nullptr;
 }
 
 int_fast32_t AStarNodes::getMapWalkCost(AStarNode* node, const Position& neighborPos, bool preferDiagonal)
@@ -1201,30 +1246,6 @@ Floor* QTreeLeafNode::createFloor(uint32_t z)
 	return array[z];
 }
 
-void QTreeLeafNode::addCreature(Creature* c)
-{
-	creature_list.push_back(c);
-
-	if (c->getPlayer()) {
-		player_list.push_back(c);
-	}
-}
-
-void QTreeLeafNode::removeCreature(Creature* c)
-{
-	auto iter = std::find(creature_list.begin(), creature_list.end(), c);
-	assert(iter != creature_list.end());
-	*iter = creature_list.back();
-	creature_list.pop_back();
-
-	if (c->getPlayer()) {
-		iter = std::find(player_list.begin(), player_list.end(), c);
-		assert(iter != player_list.end());
-		*iter = player_list.back();
-		player_list.pop_back();
-	}
-}
-
 uint32_t Map::clean() const
 {
 	uint64_t start = OTSYS_TIME();
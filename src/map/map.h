@@ -14,6 +14,7 @@
 #include "items/item.h"
 #include "items/tile.h"
 #include "map/town.h"
+#include "map/spectator_grid.h"
 #include "map/house/house.h"
 #include "creatures/monsters/spawns/spawn_monster.h"
 #include "creatures/npcs/spawns/spawn_npc.h"
@@ -57,15 +58,24 @@ class AStarNodes
 		static int_fast32_t getTileWalkCost(const Creature& creature, const Tile* tile);
 
 	private:
+		bool isBetterNode(uint16_t a, uint16_t b) const;
+		void pushOpenNode(uint16_t index);
+		void removeOpenNode(uint16_t index);
+		void siftUp(size_t position);
+		void siftDown(size_t position);
+
 		AStarNode nodes[MAX_NODES];
-		bool openNodes[MAX_NODES];
-		phmap::flat_hash_map<uint32_t, AStarNode*> nodeTable;
+		// Open nodes as a binary heap, ordered by f and then by creation like a linear scan would
+		uint16_t openHeap[MAX_NODES];
+		// Position of every node in openHeap, -1 once closed
+		int16_t heapPositions[MAX_NODES];
+		size_t openCount = 0;
 		size_t curNode;
 		int_fast32_t closedNodes;
+		uint32_t startX;
+		uint32_t startY;
 };
 
-using SpectatorCache = std::map<Position, SpectatorHashSet>;
-
 static constexpr int32_t FLOOR_BITS = 3;
 static constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
 static constexpr int32_t FLOOR_MASK = (FLOOR_SIZE - 1);
@@ -140,16 +150,11 @@ class QTreeLeafNode final : public QTreeNode
 			return array[z];
 		}
 
-		void addCreature(Creature* c);
-		void removeCreature(Creature* c);
-
 	private:
 		static bool newLeaf;
 		QTreeLeafNode* leafS = nullptr;
 		QTreeLeafNode* leafE = nullptr;
 		Floor* array[MAP_MAX_LAYERS] = {};
-		CreatureVector creature_list;
-		CreatureVector player_list;
 
 		friend class Map;
 		friend class QTreeNode;
@@ -229,11 +234,13 @@ class Map
 
 		void moveCreature(Creature& creature, Tile& newTile, bool forceTeleport = false);
 
-		void getSpectators(SpectatorHashSet& spectators, const Position& centerPos, bool multifloor = false, bool onlyPlayers = false,
+		void getSpectators(SpectatorVec& spectators, const Position& centerPos, bool multifloor = false, bool onlyPlayers = false,
                            int32_t minRangeX = 0, int32_t maxRangeX = 0,
                            int32_t minRangeY = 0, int32_t maxRangeY = 0);
 
-		void clearSpectatorCache();
+		SpectatorGrid &getSpectatorGrid() {
+			return spectatorGrid;
+		}
 
 		/**
          * Checks if you can throw an object to that position
@@ -282,9 +289,12 @@ class Map
 		SpawnsMonster spawnsMonsterCustom;
 		SpawnsNpc spawnsNpcCustom;
 		Houses housesCustom;
+
+		// Tiles and grounds loaded from map files, in load order. Declared
+		// before root so it outlives the tiles.
+		Arena arena;
 	private:
-		SpectatorCache spectatorCache;
-		SpectatorCache playersSpectatorCache;
+		SpectatorGrid spectatorGrid;
 
 		QTreeNode root;
 
@@ -295,13 +305,6 @@ class Map
 		uint32_t width = 0;
 		uint32_t height = 0;
 
-		// Actually scans the map for spectators
-		void getSpectatorsInternal(SpectatorHashSet& spectators, const Position& centerPos,
-                                   int32_t minRangeX, int32_t maxRangeX,
-                                   int32_t minRangeY, int32_t maxRangeY,
-                                   int32_t minRangeZ, int32_t maxRangeZ,
-                                   bool onlyPlayers) const;
-
 		friend class Game;
 		friend class IOMap;
 };
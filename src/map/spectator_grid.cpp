@@ -0,0 +1,271 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "pch.hpp"
+
+#include "map/spectator_grid.h"
+#include "creatures/creature.h"
+
+namespace {
+
+// Cached queries kept per sector, a sector whose creatures never change
+// would otherwise keep every position ever queried in it
+constexpr size_t MAX_CACHED_QUERIES = 64;
+
+int32_t toSector(int32_t coordinate)
+{
+	return std::clamp<int32_t>(coordinate, 0, 0xFFFF) >> SpectatorGrid::SECTOR_BITS;
+}
+
+}  // namespace
+
+const SpectatorGrid::Sector* SpectatorGrid::getSector(int32_t sectorX, int32_t sectorY) const
+{
+	const SectorRow* row = grid[sectorY].get();
+	if (!row) {
+		return nullptr;
+	}
+
+	uint32_t index = (*row)[sectorX];
+	return index != 0 ? &sectors[index - 1] : nullptr;
+}
+
+SpectatorGrid::Sector &SpectatorGrid::getOrCreateSector(const Position& pos)
+{
+	std::unique_ptr<SectorRow> &row = grid[pos.y >> SECTOR_BITS];
+	if (!row) {
+		row = std::make_unique<SectorRow>();
+		row->fill(0);
+	}
+
+	uint32_t &index = (*row)[pos.x >> SECTOR_BITS];
+	if (index == 0) {
+		sectors.emplace_back();
+		index = static_cast<uint32_t>(sectors.size());
+	}
+	return sectors[index - 1];
+}
+
+size_t SpectatorGrid::findCreature(const Sector &sector, const Creature* creature)
+{
+	auto it = std::find(sector.creatures.begin(), sector.creatures.end(), creature);
+	assert(it != sector.creatures.end());
+	return static_cast<size_t>(it - sector.creatures.begin());
+}
+
+void SpectatorGrid::addCreature(Creature* creature, const Position& pos)
+{
+	clearCache(pos);
+
+	Sector &sector = getOrCreateSector(pos);
+	sector.creatures.push_back(creature);
+	sector.positions.push_back(pos);
+
+	if (creature->getPlayer()) {
+		// Swap with the first non player
+		size_t last = sector.creatures.size() - 1;
+		std::swap(sector.creatures[sector.playerCount], sector.creatures[last]);
+		std::swap(sector.positions[sector.playerCount], sector.positions[last]);
+		++sector.playerCount;
+	}
+}
+
+void SpectatorGrid::removeCreature(Creature* creature, const Position& pos)
+{
+	clearCache(pos);
+
+	Sector &sector = getOrCreateSector(pos);
+	size_t index = findCreature(sector, creature);
+	if (index < sector.playerCount) {
+		// Move the hole to the end of the players first
+		size_t lastPlayer = --sector.playerCount;
+		sector.creatures[index] = sector.creatures[lastPlayer];
+		sector.positions[index] = sector.positions[lastPlayer];
+		index = lastPlayer;
+	}
+
+	sector.creatures[index] = sector.creatures.back();
+	sector.positions[index] = sector.positions.back();
+	sector.creatures.pop_back();
+	sector.positions.pop_back();
+}
+
+void SpectatorGrid::moveCreature(Creature* creature, const Position& oldPos, const Position& newPos)
+{
+	if ((oldPos.x >> SECTOR_BITS) != (newPos.x >> SECTOR_BITS) || (oldPos.y >> SECTOR_BITS) != (newPos.y >> SECTOR_BITS)) {
+		removeCreature(creature, oldPos);
+		addCreature(creature, newPos);
+		return;
+	}
+
+	clearCache(oldPos);
+	clearCache(newPos);
+
+	Sector &sector = getOrCreateSector(oldPos);
+	sector.positions[findCreature(sector, creature)] = newPos;
+}
+
+void SpectatorGrid::getSpectators(SpectatorVec& spectators, const Position& centerPos,
+                                  int32_t minX, int32_t maxX, int32_t minY, int32_t maxY,
+                                  int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const
+{
+	// Creatures on lower floors are seen shifted to the top left and vice versa
+	int32_t minOffset = centerPos.getZ() - maxRangeZ;
+	int32_t maxOffset = centerPos.getZ() - minRangeZ;
+	int32_t startSectorX = toSector(minX + minOffset);
+	int32_t startSectorY = toSector(minY + minOffset);
+	int32_t endSectorX = toSector(maxX + maxOffset);
+	int32_t endSectorY = toSector(maxY + maxOffset);
+
+	size_t previousCount = spectators.size();
+	for (int32_t sectorY = startSectorY; sectorY <= endSectorY; ++sectorY) {
+		for (int32_t sectorX = startSectorX; sectorX <= endSectorX; ++sectorX) {
+			const Sector* sector = getSector(sectorX, sectorY);
+			if (!sector) {
+				continue;
+			}
+
+			size_t count = onlyPlayers ? sector->playerCount : sector->creatures.size();
+			for (size_t i = 0; i < count; ++i) {
+				const Position& pos = sector->positions[i];
+				if (minRangeZ > pos.z || maxRangeZ < pos.z) {
+					continue;
+				}
+
+				int_fast16_t offsetZ = Position::getOffsetZ(centerPos, pos);
+				if ((minY + offsetZ) > pos.y || (maxY + offsetZ) < pos.y || (minX + offsetZ) > pos.x || (maxX + offsetZ) < pos.x) {
+					continue;
+				}
+
+				spectators.push_back(sector->creatures[i]);
+			}
+		}
+	}
+
+	// Every creature is in a single sector, only the previous content can repeat
+	spectators.removeDuplicates(previousCount);
+}
+
+const SpectatorVec* SpectatorGrid::getCachedSpectators(const Position& centerPos, bool onlyPlayers) const
+{
+	const Sector* sector = getSector(centerPos.x >> SECTOR_BITS, centerPos.y >> SECTOR_BITS);
+	if (!sector) {
+		return nullptr;
+	}
+
+	const SpectatorCache &cache = onlyPlayers ? sector->playersCache : sector->cache;
+	auto it = cache.find(centerPos);
+	return it != cache.end() ? &it->second : nullptr;
+}
+
+void SpectatorGrid::setCachedSpectators(const Position& centerPos, bool onlyPlayers, const SpectatorVec& spectators)
+{
+	Sector &sector = getOrCreateSector(centerPos);
+	SpectatorCache &cache = onlyPlayers ? sector.playersCache : sector.cache;
+	if (cache.size() >= MAX_CACHED_QUERIES) {
+		cache.clear();
+	}
+	cache[centerPos] = spectators;
+}
+
+void SpectatorGrid::clearCache(const Position& pos)
+{
+	int32_t startSectorX = toSector(pos.x - CACHE_REACH);
+	int32_t startSectorY = toSector(pos.y - CACHE_REACH);
+	int32_t endSectorX = toSector(pos.x + CACHE_REACH);
+	int32_t endSectorY = toSector(pos.y + CACHE_REACH);
+	for (int32_t sectorY = startSectorY; sectorY <= endSectorY; ++sectorY) {
+		const SectorRow* row = grid[sectorY].get();
+		if (!row) {
+			continue;
+		}
+
+		for (int32_t sectorX = startSectorX; sectorX <= endSectorX; ++sectorX) {
+			if (uint32_t index = (*row)[sectorX];
+			index != 0) {
+				sectors[index - 1].cache.clear();
+				sectors[index - 1].playersCache.clear();
+			}
+		}
+	}
+}
+
+void SpectatorGrid::clearCache()
+{
+	for (Sector &sector : sectors) {
+		sector.cache.clear();
+		sector.playersCache.clear();
+	}
+}
+
+bool SpectatorGrid::hasPlayersNear(const Position& pos) const
+{
+	// From the whole sector: a player that has the sector in reach is found,
+	// so it could not get near the creature without a sector change
+	const int32_t sectorX = pos.x & ~(SECTOR_SIZE - 1);
+	const int32_t sectorY = pos.y & ~(SECTOR_SIZE - 1);
+	int32_t startSectorX = toSector(sectorX - WAKE_REACH);
+	int32_t startSectorY = toSector(sectorY - WAKE_REACH);
+	int32_t endSectorX = toSector(sectorX + SECTOR_SIZE - 1 + WAKE_REACH);
+	int32_t endSectorY = toSector(sectorY + SECTOR_SIZE - 1 + WAKE_REACH);
+	for (int32_t sectorY = startSectorY; sectorY <= endSectorY; ++sectorY) {
+		for (int32_t sectorX = startSectorX; sectorX <= endSectorX; ++sectorX) {
+			const Sector* sector = getSector(sectorX, sectorY);
+			if (sector && sector->playerCount != 0) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool SpectatorGrid::isSameReach(const Position& pos, const Position& otherPos)
+{
+	return toSector(pos.x - WAKE_REACH) == toSector(otherPos.x - WAKE_REACH)
+		&& toSector(pos.x + WAKE_REACH) == toSector(otherPos.x + WAKE_REACH)
+		&& toSector(pos.y - WAKE_REACH) == toSector(otherPos.y - WAKE_REACH)
+		&& toSector(pos.y + WAKE_REACH) == toSector(otherPos.y + WAKE_REACH);
+}
+
+void SpectatorGrid::addSleeper(Creature* creature, const Position& pos)
+{
+	getOrCreateSector(pos).sleepers.push_back(creature);
+}
+
+void SpectatorGrid::removeSleeper(Creature* creature, const Position& pos)
+{
+	std::vector<Creature*> &sleepers = getOrCreateSector(pos).sleepers;
+	auto it = std::find(sleepers.begin(), sleepers.end(), creature);
+	assert(it != sleepers.end());
+	*it = sleepers.back();
+	sleepers.pop_back();
+}
+
+void SpectatorGrid::takeSleepers(std::vector<Creature*>& sleepers, const Position& pos)
+{
+	int32_t startSectorX = toSector(pos.x - WAKE_REACH);
+	int32_t startSectorY = toSector(pos.y - WAKE_REACH);
+	int32_t endSectorX = toSector(pos.x + WAKE_REACH);
+	int32_t endSectorY = toSector(pos.y + WAKE_REACH);
+	for (int32_t sectorY = startSectorY; sectorY <= endSectorY; ++sectorY) {
+		const SectorRow* row = grid[sectorY].get();
+		if (!row) {
+			continue;
+		}
+
+		for (int32_t sectorX = startSectorX; sectorX <= endSectorX; ++sectorX) {
+			if (uint32_t index = (*row)[sectorX];
+			index != 0 && !sectors[index - 1].sleepers.empty()) {
+				std::vector<Creature*> &sectorSleepers = sectors[index - 1].sleepers;
+				sleepers.insert(sleepers.end(), sectorSleepers.begin(), sectorSleepers.end());
+				sectorSleepers.clear();
+			}
+		}
+	}
+}
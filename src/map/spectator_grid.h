@@ -0,0 +1,104 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_MAP_SPECTATOR_GRID_H_
+#define SRC_MAP_SPECTATOR_GRID_H_
+
+#include "game/movement/position.h"
+#include "map/spectators.hpp"
+
+using SpectatorCache = std::map<Position, SpectatorVec>;
+
+/**
+ * Index of the creatures on the map, used to answer spectators queries.
+ *
+ * The map is split in sectors of SECTOR_SIZE x SECTOR_SIZE tiles (all the
+ * floors together) kept in a flat grid. Each sector stores its creatures
+ * next to a copy of their positions, players first, so a query only reads
+ * a few contiguous arrays and never touches the creatures themselves.
+ *
+ * Results of default viewport queries are cached in the sector of their
+ * center and dropped only for the sectors near a creature that changed.
+ *
+ * Sectors also hold the sleeping creatures, left out of the creature checks
+ * while no sector within WAKE_REACH of them has a player, and given back
+ * when a player gets that close (see Game::checkCreatures).
+ */
+class SpectatorGrid
+{
+	public:
+		static constexpr int32_t SECTOR_BITS = 5;
+		static constexpr int32_t SECTOR_SIZE = 1 << SECTOR_BITS;
+		static constexpr int32_t SECTORS_PER_AXIS = 0x10000 >> SECTOR_BITS;
+		// How far from its center a cached query can see, a whole viewport plus the multifloor offset
+		static constexpr int32_t CACHE_REACH = 11 + 7;
+		// How far a creature can notice a player, as far as a viewport query sees
+		static constexpr int32_t WAKE_REACH = CACHE_REACH;
+
+		SpectatorGrid() = default;
+
+		// non-copyable
+		SpectatorGrid(const SpectatorGrid&) = delete;
+		SpectatorGrid& operator=(const SpectatorGrid&) = delete;
+
+		void addCreature(Creature* creature, const Position& pos);
+		void removeCreature(Creature* creature, const Position& pos);
+		void moveCreature(Creature* creature, const Position& oldPos, const Position& newPos);
+
+		/**
+		 * Adds to spectators the creatures at z in [minRangeZ, maxRangeZ] whose
+		 * position, shifted by their floor difference to centerPos, falls in
+		 * [minX, maxX] x [minY, maxY].
+		 */
+		void getSpectators(SpectatorVec& spectators, const Position& centerPos,
+                           int32_t minX, int32_t maxX, int32_t minY, int32_t maxY,
+                           int32_t minRangeZ, int32_t maxRangeZ, bool onlyPlayers) const;
+
+		const SpectatorVec* getCachedSpectators(const Position& centerPos, bool onlyPlayers) const;
+		void setCachedSpectators(const Position& centerPos, bool onlyPlayers, const SpectatorVec& spectators);
+
+		// Drops the cached queries that could see pos
+		void clearCache(const Position& pos);
+		void clearCache();
+
+		// Whether a player is within WAKE_REACH of any position of the sector of pos
+		bool hasPlayersNear(const Position& pos) const;
+		// Whether the sectors within WAKE_REACH are the same for both positions
+		static bool isSameReach(const Position& pos, const Position& otherPos);
+
+		void addSleeper(Creature* creature, const Position& pos);
+		void removeSleeper(Creature* creature, const Position& pos);
+		// Moves into sleepers the sleeping creatures within WAKE_REACH of pos
+		void takeSleepers(std::vector<Creature*>& sleepers, const Position& pos);
+
+	private:
+		struct Sector {
+			// Players are kept in [0, playerCount)
+			std::vector<Creature*> creatures;
+			std::vector<Position> positions;
+			uint32_t playerCount = 0;
+
+			std::vector<Creature*> sleepers;
+
+			SpectatorCache cache;
+			SpectatorCache playersCache;
+		};
+
+		using SectorRow = std::array<uint32_t, SECTORS_PER_AXIS>;
+
+		const Sector* getSector(int32_t sectorX, int32_t sectorY) const;
+		Sector &getOrCreateSector(const Position& pos);
+		static size_t findCreature(const Sector &sector, const Creature* creature);
+
+		// Index + 1 in sectors of every existing sector, rows are allocated on first use
+		std::array<std::unique_ptr<SectorRow>, SECTORS_PER_AXIS> grid;
+		std::vector<Sector> sectors;
+};
+
+#endif  // SRC_MAP_SPECTATOR_GRID_H_
@@ -0,0 +1,181 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_MAP_SPECTATORS_HPP_
+#define SRC_MAP_SPECTATORS_HPP_
+
+class Creature;
+
+/**
+ * Result of a spectators query: a set of creatures without any order.
+ *
+ * Small results, by far the most common, live inside the object so a query
+ * does not allocate; clear() keeps the storage for the next query.
+ */
+class SpectatorVec
+{
+	public:
+		using value_type = Creature*;
+		using iterator = Creature**;
+		using const_iterator = Creature* const*;
+
+		SpectatorVec() = default;
+		~SpectatorVec() = default;
+
+		SpectatorVec(const SpectatorVec& other) {
+			assign(other);
+		}
+		SpectatorVec& operator=(const SpectatorVec& other) {
+			if (this != &other) {
+				count = 0;
+				assign(other);
+			}
+			return *this;
+		}
+
+		SpectatorVec(SpectatorVec&& other) noexcept {
+			steal(other);
+		}
+		SpectatorVec& operator=(SpectatorVec&& other) noexcept {
+			if (this != &other) {
+				steal(other);
+			}
+			return *this;
+		}
+
+		iterator begin() {
+			return data();
+		}
+		iterator end() {
+			return data() + count;
+		}
+		const_iterator begin() const {
+			return data();
+		}
+		const_iterator end() const {
+			return data() + count;
+		}
+
+		size_t size() const {
+			return count;
+		}
+		bool empty() const {
+			return count == 0;
+		}
+		void clear() {
+			count = 0;
+		}
+
+		bool contains(const Creature* creature) const {
+			return std::find(begin(), end(), creature) != end();
+		}
+
+		void insert(Creature* creature) {
+			if (!contains(creature)) {
+				push_back(creature);
+			}
+		}
+
+		void erase(const Creature* creature) {
+			auto it = std::find(begin(), end(), creature);
+			if (it != end()) {
+				*it = data()[--count];
+			}
+		}
+
+		// Adds without checking for duplicates
+		void push_back(Creature* creature) {
+			if (count == capacity) {
+				reserve(capacity * 2);
+			}
+			data()[count++] = creature;
+		}
+
+		// Adds the creatures of other that are not already in this set
+		void mergeSpectators(const SpectatorVec& other) {
+			size_t previousCount = count;
+			reserve(count + other.count);
+			for (Creature* creature : other) {
+				data()[count++] = creature;
+			}
+			removeDuplicates(previousCount);
+		}
+
+		/**
+		 * Removes the creatures added after the first previousCount ones that
+		 * were already present. The first previousCount creatures must be
+		 * unique, as must the ones added after them.
+		 */
+		void removeDuplicates(size_t previousCount) {
+			if (previousCount == 0 || previousCount == count) {
+				return;
+			}
+
+			Creature** first = data();
+			if (previousCount * (count - previousCount) <= 1024) {
+				size_t newCount = previousCount;
+				for (size_t i = previousCount; i < count; ++i) {
+					if (std::find(first, first + previousCount, first[i]) == first + previousCount) {
+						first[newCount++] = first[i];
+					}
+				}
+				count = newCount;
+			} else {
+				std::sort(first, first + count);
+				count = std::unique(first, first + count) - first;
+			}
+		}
+
+		void reserve(size_t newCapacity) {
+			if (newCapacity <= capacity) {
+				return;
+			}
+
+			auto newData = std::make_unique<Creature*[]>(newCapacity);
+			std::copy(begin(), end(), newData.get());
+			heapData = std::move(newData);
+			capacity = newCapacity;
+		}
+
+	private:
+		static constexpr size_t INLINE_CAPACITY = 32;
+
+		Creature** data() {
+			return heapData ? heapData.get() : inlineData.data();
+		}
+		Creature* const* data() const {
+			return heapData ? heapData.get() : inlineData.data();
+		}
+
+		void assign(const SpectatorVec& other) {
+			reserve(other.count);
+			std::copy(other.begin(), other.end(), data());
+			count = other.count;
+		}
+
+		void steal(SpectatorVec& other) {
+			if (other.heapData) {
+				heapData = std::move(other.heapData);
+				capacity = other.capacity;
+				count = other.count;
+				other.capacity = INLINE_CAPACITY;
+			} else {
+				count = 0;
+				assign(other);
+			}
+			other.count = 0;
+		}
+
+		std::array<Creature*, INLINE_CAPACITY> inlineData;
+		std::unique_ptr<Creature*[]> heapData;
+		size_t count = 0;
+		size_t capacity = INLINE_CAPACITY;
+};
+
+#endif  // SRC_MAP_SPECTATORS_HPP_
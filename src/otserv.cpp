@@ -22,6 +22,8 @@
 #include "game/scheduling/scheduler.h"
 #include "game/scheduling/events_scheduler.hpp"
 #include "io/iomarket.h"
+#include "io/playerloader.h"
+#include "io/savewriter.h"
 #include "lua/creature/events.h"
 #include "lua/modules/modules.h"
 #include "lua/scripts/lua_environment.hpp"
@@ -143,6 +145,8 @@ void loadModules() {
 	}
 
 	g_databaseTasks().start();
+	g_playerLoader().start();
+	g_saveWriter().start();
 	DatabaseManager::updateDatabase();
 
 	if (g_configManager().getBoolean(OPTIMIZE_DATABASE)
@@ -237,6 +241,7 @@ int main(int argc, char* argv[]) {
 	g_scheduler().join();
 	g_databaseTasks().join();
 	g_dispatcher().join();
+	g_webhook().join();
 	return 0;
 }
 #endif
@@ -340,6 +345,12 @@ void mainLoader(int, char*[], ServiceManager* services) {
 		}
 	}
 
+	SPDLOG_INFO("Loading market...");
+	if (!IOMarket::getInstance().loadOffers()) {
+		SPDLOG_ERROR("Failed to load market offers");
+		startupErrorMessage();
+	}
+
 	SPDLOG_INFO("Initializing gamestate...");
 	g_game().setGameState(GAME_STATE_INIT);
 
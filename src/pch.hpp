@@ -14,17 +14,21 @@
 #include "utils/definitions.h"
 #include "utils/simd.hpp"
 
+#include <bit>
 #include <bitset>
 #include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <forward_list>
+#include <future>
 #include <list>
 #include <map>
+#include <optional>
 #include <random>
 #include <ranges>
 #include <regex>
 #include <set>
+#include <span>
 #include <queue>
 #include <vector>
 #include <variant>
@@ -0,0 +1,268 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "pch.hpp"
+
+#include "security/xtea.h"
+
+// SSE2 is part of x86-64, AVX2 is only used when the running CPU reports it
+#if defined(SIMD_X86_DISPATCH)
+#define XTEA_SSE2 1
+#define XTEA_AVX2 1
+#endif
+
+#if (defined(__NEON__) || defined(__aarch64__)) && !defined(__DISABLE_VECTORIZATION__)
+#define XTEA_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace xtea {
+
+namespace {
+
+constexpr uint32_t DELTA = 0x61C88647;
+
+size_t encryptScalar(uint8_t* data, size_t length, const round_keys &keys)
+{
+	for (size_t pos = 0; pos < length; pos += BLOCK_SIZE) {
+		std::array<uint32_t, 2> vData;
+		memcpy(vData.data(), data + pos, BLOCK_SIZE);
+		for (size_t i = 0; i < ROUNDS; ++i) {
+			vData[0] += ((vData[1] << 4 ^ vData[1] >> 5) + vData[1]) ^ keys[i * 2];
+			vData[1] += ((vData[0] << 4 ^ vData[0] >> 5) + vData[0]) ^ keys[i * 2 + 1];
+		}
+		memcpy(data + pos, vData.data(), BLOCK_SIZE);
+	}
+	return length;
+}
+
+size_t decryptScalar(uint8_t* data, size_t length, const round_keys &keys)
+{
+	for (size_t pos = 0; pos < length; pos += BLOCK_SIZE) {
+		std::array<uint32_t, 2> vData;
+		memcpy(vData.data(), data + pos, BLOCK_SIZE);
+		for (size_t i = ROUNDS; i-- > 0;) {
+			vData[1] -= ((vData[0] << 4 ^ vData[0] >> 5) + vData[0]) ^ keys[i * 2 + 1];
+			vData[0] -= ((vData[1] << 4 ^ vData[1] >> 5) + vData[1]) ^ keys[i * 2];
+		}
+		memcpy(data + pos, vData.data(), BLOCK_SIZE);
+	}
+	return length;
+}
+
+#if defined(XTEA_SSE2)
+// 4 blocks per iteration: one register holds the first word of each block,
+// another one the second word
+size_t encryptSSE2(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 4 * BLOCK_SIZE <= length; pos += 4 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<__m128i*>(data + pos);
+		__m128i low = _mm_shuffle_epi32(_mm_loadu_si128(ptr), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i high = _mm_shuffle_epi32(_mm_loadu_si128(ptr + 1), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i v0 = _mm_unpacklo_epi64(low, high);
+		__m128i v1 = _mm_unpackhi_epi64(low, high);
+		for (size_t i = 0; i < ROUNDS; ++i) {
+			__m128i mix = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+			v0 = _mm_add_epi32(v0, _mm_xor_si128(mix, _mm_set1_epi32(static_cast<int32_t>(keys[i * 2]))));
+			mix = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+			v1 = _mm_add_epi32(v1, _mm_xor_si128(mix, _mm_set1_epi32(static_cast<int32_t>(keys[i * 2 + 1]))));
+		}
+		_mm_storeu_si128(ptr, _mm_unpacklo_epi32(v0, v1));
+		_mm_storeu_si128(ptr + 1, _mm_unpackhi_epi32(v0, v1));
+	}
+	return pos;
+}
+
+size_t decryptSSE2(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 4 * BLOCK_SIZE <= length; pos += 4 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<__m128i*>(data + pos);
+		__m128i low = _mm_shuffle_epi32(_mm_loadu_si128(ptr), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i high = _mm_shuffle_epi32(_mm_loadu_si128(ptr + 1), _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i v0 = _mm_unpacklo_epi64(low, high);
+		__m128i v1 = _mm_unpackhi_epi64(low, high);
+		for (size_t i = ROUNDS; i-- > 0;) {
+			__m128i mix = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v0, 4), _mm_srli_epi32(v0, 5)), v0);
+			v1 = _mm_sub_epi32(v1, _mm_xor_si128(mix, _mm_set1_epi32(static_cast<int32_t>(keys[i * 2 + 1]))));
+			mix = _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v1, 4), _mm_srli_epi32(v1, 5)), v1);
+			v0 = _mm_sub_epi32(v0, _mm_xor_si128(mix, _mm_set1_epi32(static_cast<int32_t>(keys[i * 2]))));
+		}
+		_mm_storeu_si128(ptr, _mm_unpacklo_epi32(v0, v1));
+		_mm_storeu_si128(ptr + 1, _mm_unpackhi_epi32(v0, v1));
+	}
+	return pos;
+}
+#endif
+
+#if defined(XTEA_AVX2)
+// Same layout as SSE2 with 8 blocks per iteration, the shuffles work inside
+// each 128 bits lane and the stores undo the resulting block order
+SIMD_TARGET("avx2") size_t encryptAVX2(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 8 * BLOCK_SIZE <= length; pos += 8 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<__m256i*>(data + pos);
+		__m256i low = _mm256_shuffle_epi32(_mm256_loadu_si256(ptr), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i high = _mm256_shuffle_epi32(_mm256_loadu_si256(ptr + 1), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i v0 = _mm256_unpacklo_epi64(low, high);
+		__m256i v1 = _mm256_unpackhi_epi64(low, high);
+		for (size_t i = 0; i < ROUNDS; ++i) {
+			__m256i mix = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+			v0 = _mm256_add_epi32(v0, _mm256_xor_si256(mix, _mm256_set1_epi32(static_cast<int32_t>(keys[i * 2]))));
+			mix = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+			v1 = _mm256_add_epi32(v1, _mm256_xor_si256(mix, _mm256_set1_epi32(static_cast<int32_t>(keys[i * 2 + 1]))));
+		}
+		_mm256_storeu_si256(ptr, _mm256_unpacklo_epi32(v0, v1));
+		_mm256_storeu_si256(ptr + 1, _mm256_unpackhi_epi32(v0, v1));
+	}
+	return pos;
+}
+
+SIMD_TARGET("avx2") size_t decryptAVX2(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 8 * BLOCK_SIZE <= length; pos += 8 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<__m256i*>(data + pos);
+		__m256i low = _mm256_shuffle_epi32(_mm256_loadu_si256(ptr), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i high = _mm256_shuffle_epi32(_mm256_loadu_si256(ptr + 1), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i v0 = _mm256_unpacklo_epi64(low, high);
+		__m256i v1 = _mm256_unpackhi_epi64(low, high);
+		for (size_t i = ROUNDS; i-- > 0;) {
+			__m256i mix = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v0, 4), _mm256_srli_epi32(v0, 5)), v0);
+			v1 = _mm256_sub_epi32(v1, _mm256_xor_si256(mix, _mm256_set1_epi32(static_cast<int32_t>(keys[i * 2 + 1]))));
+			mix = _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v1, 4), _mm256_srli_epi32(v1, 5)), v1);
+			v0 = _mm256_sub_epi32(v0, _mm256_xor_si256(mix, _mm256_set1_epi32(static_cast<int32_t>(keys[i * 2]))));
+		}
+		_mm256_storeu_si256(ptr, _mm256_unpacklo_epi32(v0, v1));
+		_mm256_storeu_si256(ptr + 1, _mm256_unpackhi_epi32(v0, v1));
+	}
+	return pos;
+}
+#endif
+
+#if defined(XTEA_NEON)
+// vld2q/vst2q split and merge the two words of 4 blocks for free
+size_t encryptNEON(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 4 * BLOCK_SIZE <= length; pos += 4 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<uint32_t*>(data + pos);
+		uint32x4x2_t v = vld2q_u32(ptr);
+		for (size_t i = 0; i < ROUNDS; ++i) {
+			uint32x4_t mix = vaddq_u32(veorq_u32(vshlq_n_u32(v.val[1], 4), vshrq_n_u32(v.val[1], 5)), v.val[1]);
+			v.val[0] = vaddq_u32(v.val[0], veorq_u32(mix, vdupq_n_u32(keys[i * 2])));
+			mix = vaddq_u32(veorq_u32(vshlq_n_u32(v.val[0], 4), vshrq_n_u32(v.val[0], 5)), v.val[0]);
+			v.val[1] = vaddq_u32(v.val[1], veorq_u32(mix, vdupq_n_u32(keys[i * 2 + 1])));
+		}
+		vst2q_u32(ptr, v);
+	}
+	return pos;
+}
+
+size_t decryptNEON(uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t pos = 0;
+	for (; pos + 4 * BLOCK_SIZE <= length; pos += 4 * BLOCK_SIZE) {
+		auto ptr = reinterpret_cast<uint32_t*>(data + pos);
+		uint32x4x2_t v = vld2q_u32(ptr);
+		for (size_t i = ROUNDS; i-- > 0;) {
+			uint32x4_t mix = vaddq_u32(veorq_u32(vshlq_n_u32(v.val[0], 4), vshrq_n_u32(v.val[0], 5)), v.val[0]);
+			v.val[1] = vsubq_u32(v.val[1], veorq_u32(mix, vdupq_n_u32(keys[i * 2 + 1])));
+			mix = vaddq_u32(veorq_u32(vshlq_n_u32(v.val[1], 4), vshrq_n_u32(v.val[1], 5)), v.val[1]);
+			v.val[0] = vsubq_u32(v.val[0], veorq_u32(mix, vdupq_n_u32(keys[i * 2])));
+		}
+		vst2q_u32(ptr, v);
+	}
+	return pos;
+}
+#endif
+
+Kernels selectKernels()
+{
+#if defined(XTEA_AVX2)
+	if (cpuSupportsAVX2()) {
+		return {encryptAVX2, decryptAVX2, "AVX2"};
+	}
+#endif
+#if defined(XTEA_SSE2)
+	return {encryptSSE2, decryptSSE2, "SSE2"};
+#elif defined(XTEA_NEON)
+	return {encryptNEON, decryptNEON, "NEON"};
+#else
+	return {encryptScalar, decryptScalar, "scalar"};
+#endif
+}
+
+const Kernels &getKernels()
+{
+	static const Kernels kernels = selectKernels();
+	return kernels;
+}
+
+}  // namespace
+
+round_keys expandKey(const std::array<uint32_t, 4> &key)
+{
+	round_keys keys;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < ROUNDS; ++i) {
+		keys[i * 2] = sum + key[sum & 3];
+		sum -= DELTA;
+		keys[i * 2 + 1] = sum + key[(sum >> 11) & 3];
+	}
+	return keys;
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys &keys)
+{
+	encrypt(getKernels(), data, length, keys);
+}
+
+void decrypt(uint8_t* data, size_t length, const round_keys &keys)
+{
+	decrypt(getKernels(), data, length, keys);
+}
+
+const char* getKernelName()
+{
+	return getKernels().name;
+}
+
+std::vector<Kernels> getSupportedKernels()
+{
+	std::vector<Kernels> kernels = {{encryptScalar, decryptScalar, "scalar"}};
+#if defined(XTEA_SSE2)
+	kernels.push_back({encryptSSE2, decryptSSE2, "SSE2"});
+#endif
+#if defined(XTEA_AVX2)
+	if (cpuSupportsAVX2()) {
+		kernels.push_back({encryptAVX2, decryptAVX2, "AVX2"});
+	}
+#endif
+#if defined(XTEA_NEON)
+	kernels.push_back({encryptNEON, decryptNEON, "NEON"});
+#endif
+	return kernels;
+}
+
+void encrypt(const Kernels &kernels, uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t done = kernels.encrypt(data, length, keys);
+	encryptScalar(data + done, length - done, keys);
+}
+
+void decrypt(const Kernels &kernels, uint8_t* data, size_t length, const round_keys &keys)
+{
+	size_t done = kernels.decrypt(data, length, keys);
+	decryptScalar(data + done, length - done, keys);
+}
+
+}  // namespace xtea
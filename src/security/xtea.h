@@ -0,0 +1,59 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_SECURITY_XTEA_H_
+#define SRC_SECURITY_XTEA_H_
+
+namespace xtea {
+
+constexpr size_t BLOCK_SIZE = 8;
+constexpr size_t ROUNDS = 32;
+
+/**
+ * Key schedule expanded once per key: entry 2 * i is added to the first
+ * word on round i, entry 2 * i + 1 to the second word. Decryption walks
+ * the same table backwards.
+ */
+using round_keys = std::array<uint32_t, ROUNDS * 2>;
+
+round_keys expandKey(const std::array<uint32_t, 4> &key);
+
+/**
+ * Encrypts/decrypts length bytes in place, length must be a multiple of
+ * BLOCK_SIZE. Blocks are independent, so the widest kernel supported by
+ * the CPU (AVX2, SSE2 or NEON) processes several of them at once.
+ */
+void encrypt(uint8_t* data, size_t length, const round_keys &keys);
+void decrypt(uint8_t* data, size_t length, const round_keys &keys);
+
+// Name of the kernel selected for this CPU
+const char* getKernelName();
+
+/**
+ * Kernels process as many whole groups of blocks as they can and return the
+ * amount of bytes done, the remaining blocks are left to the scalar code.
+ */
+using Kernel = size_t (*)(uint8_t* data, size_t length, const round_keys &keys);
+
+struct Kernels {
+	Kernel encrypt;
+	Kernel decrypt;
+	const char* name;
+};
+
+// Every kernel compiled in that this CPU can run, the scalar one first
+std::vector<Kernels> getSupportedKernels();
+
+// Same as above, with the given kernels instead of the selected ones
+void encrypt(const Kernels &kernels, uint8_t* data, size_t length, const round_keys &keys);
+void decrypt(const Kernels &kernels, uint8_t* data, size_t length, const round_keys &keys);
+
+}  // namespace xtea
+
+#endif  // SRC_SECURITY_XTEA_H_
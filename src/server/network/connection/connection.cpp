@@ -37,12 +37,14 @@ void ConnectionManager::closeAll()
 	std::lock_guard<std::mutex> lockClass(connectionManagerLock);
 
 	for (const auto& connection : connections) {
-		try {
-			std::error_code error;
-			connection->socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
-		} catch (const std::system_error& systemError) {
-			SPDLOG_ERROR("[ConnectionManager::closeAll] - Failed to close connection, system error code {}", systemError.what());
-		}
+		asio::post(connection->strand, [connection]() {
+			try {
+				std::error_code error;
+				connection->socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
+			} catch (const std::system_error& systemError) {
+				SPDLOG_ERROR("[ConnectionManager::closeAll] - Failed to close connection, system error code {}", systemError.what());
+			}
+		});
 	}
 	connections.clear();
 }
@@ -50,10 +52,11 @@ void ConnectionManager::closeAll()
 // Connection
 // Constructor
 Connection::Connection(asio::io_service& initIoService, ConstServicePort_ptr initservicePort) :
-	readTimer(initIoService),
-	writeTimer(initIoService),
+	strand(asio::make_strand(initIoService)),
+	readTimer(strand),
+	writeTimer(strand),
 	service_port(std::move(initservicePort)),
-	socket(initIoService)
+	socket(strand)
 {
 	timeConnected = time(nullptr);
 }
@@ -64,7 +67,11 @@ void Connection::close(bool force)
 	//any thread
 	ConnectionManager::getInstance().releaseConnection(shared_from_this());
 
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
+	asio::dispatch(strand, std::bind(&Connection::internalClose, shared_from_this(), force));
+}
+
+void Connection::internalClose(bool force)
+{
 	if (connectionState == CONNECTION_STATE_CLOSED) {
 		return;
 	}
@@ -99,16 +106,26 @@ void Connection::closeSocket()
 
 void Connection::accept(Protocol_ptr protocolPtr)
 {
-	this->connectionState = CONNECTION_STATE_IDENTIFYING;
-	this->protocol = protocolPtr;
-	g_dispatcher().addTask(createSchedulerTask(1000, std::bind_front(&Protocol::onConnect, protocolPtr)));
-
-	// Call second accept for not duplicate code
-	accept(false);
+	asio::dispatch(strand, [self = shared_from_this(), protocolPtr]() {
+		self->connectionState = CONNECTION_STATE_IDENTIFYING;
+		self->protocol = protocolPtr;
+		g_dispatcher().addTask(createSchedulerTask(1000, std::bind_front(&Protocol::onConnect, protocolPtr)));
+
+		// Call second accept for not duplicate code
+		self->accept(false);
+	});
 }
 
 void Connection::accept(bool toggleParseHeader /* = true */)
 {
+	// Accept is called by the acceptor, the socket is only used from the strand
+	if (!strand.running_in_this_thread()) {
+		asio::post(strand, [self = shared_from_this(), toggleParseHeader]() {
+			self->accept(toggleParseHeader);
+		});
+		return;
+	}
+
 	try {
 		readTimer.expires_from_now(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		readTimer.async_wait(std::bind(&Connection::handleTimeout, std::weak_ptr<Connection>(shared_from_this()), std::placeholders::_1));
@@ -116,13 +133,12 @@ void Connection::accept(bool toggleParseHeader /* = true */)
 		// If toggleParseHeader is true, execute the parseHeader, if not, execute parseProxyIdentification
 		if (toggleParseHeader) {
 			// Read size of the first packet
-			asio::async_read(socket,
-									asio::buffer(msg.getBuffer(), HEADER_LENGTH),
-									std::bind(&Connection::parseHeader, shared_from_this(), std::placeholders::_1));
+			readHeader();
 		} else {
+			msg = NetworkMessage::getInputMessage(HEADER_LENGTH);
 			// Read header bytes to identify if it is proxy identification
 			asio::async_read(socket,
-									asio::buffer(msg.getBuffer(), HEADER_LENGTH),
+									asio::buffer(msg->getBuffer(), HEADER_LENGTH),
 									std::bind(&Connection::parseProxyIdentification, shared_from_this(), std::placeholders::_1));
 		}
 	} catch (const std::system_error& e) {
@@ -133,7 +149,6 @@ void Connection::accept(bool toggleParseHeader /* = true */)
 
 void Connection::parseProxyIdentification(const std::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -143,7 +158,7 @@ void Connection::parseProxyIdentification(const std::error_code& error)
 		return;
 	}
 
-	uint8_t* msgBuffer = msg.getBuffer();
+	uint8_t* msgBuffer = msg->getBuffer();
 	auto charData = static_cast<char*>(static_cast<void*>(msgBuffer));
 	std::string serverName = g_configManager().getString(SERVER_NAME) + "\n";
 	if (connectionState == CONNECTION_STATE_IDENTIFYING) {
@@ -154,7 +169,11 @@ void Connection::parseProxyIdentification(const std::error_code& error)
 			return;
 		} else {
 			size_t remainder = serverName.length()-2;
-			if (remainder > 0) {
+			if (remainder > msg->getCapacity()) {
+				SPDLOG_ERROR("Connection::parseProxyIdentification] Server name is too long for proxy identification");
+				close(FORCE_CLOSE);
+				return;
+			} else if (remainder > 0) {
 				connectionState = CONNECTION_STATE_READINGS;
 				try {
 					readTimer.expires_from_now(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
@@ -162,7 +181,7 @@ void Connection::parseProxyIdentification(const std::error_code& error)
 
 					// Read the remainder of proxy identification
 					asio::async_read(socket,
-											asio::buffer(msg.getBuffer(), remainder),
+											asio::buffer(msg->getBuffer(), remainder),
 											std::bind(&Connection::parseProxyIdentification, shared_from_this(), std::placeholders::_1));
 				}
 				catch (const std::system_error& e) {
@@ -190,7 +209,6 @@ void Connection::parseProxyIdentification(const std::error_code& error)
 
 void Connection::parseHeader(const std::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -212,20 +230,27 @@ void Connection::parseHeader(const std::error_code& error)
 		packetsSent = 0;
 	}
 
-	uint16_t size = msg.getLengthHeader();
+	uint16_t size = msg->getLengthHeader();
 	if (size == 0 || size > INPUTMESSAGE_MAXSIZE) {
 		close(FORCE_CLOSE);
 		return;
 	}
 
+	if (msg->getCapacity() < size + HEADER_LENGTH) {
+		// Move to a buffer of the packet size class, body is read directly into it
+		InputMessage_ptr packet = NetworkMessage::getInputMessage(size + HEADER_LENGTH);
+		memcpy(packet->getBuffer(), msg->getBuffer(), HEADER_LENGTH);
+		msg = std::move(packet);
+	}
+
 	try {
 		readTimer.expires_from_now(std::chrono::seconds(CONNECTION_READ_TIMEOUT));
 		readTimer.async_wait(std::bind(&Connection::handleTimeout, std::weak_ptr<Connection>(shared_from_this()), std::placeholders::_1));
 
 		// Read packet content
-		msg.setLength(size + HEADER_LENGTH);
+		msg->setLength(size + HEADER_LENGTH);
 		asio::async_read(socket,
-								asio::buffer(msg.getBodyBuffer(), size),
+								asio::buffer(msg->getBodyBuffer(), size),
 		                        std::bind(&Connection::parsePacket, shared_from_this(), std::placeholders::_1));
 	} catch (const std::system_error& e) {
 		SPDLOG_ERROR("[Connection::parseHeader] - error: {}", e.what());
@@ -235,7 +260,6 @@ void Connection::parseHeader(const std::error_code& error)
 
 void Connection::parsePacket(const std::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	readTimer.cancel();
 
 	if (error) {
@@ -253,22 +277,22 @@ void Connection::parsePacket(const std::error_code& error)
 		if (!protocol) {
 			//Check packet checksum
 			uint32_t checksum;
-			if (int32_t len = msg.getLength() - msg.getBufferPosition() - CHECKSUM_LENGTH;
+			if (int32_t len = msg->getLength() - msg->getBufferPosition() - CHECKSUM_LENGTH;
 			len > 0)
 			{
-				checksum = adlerChecksum(msg.getBuffer() + msg.getBufferPosition() + CHECKSUM_LENGTH, len);
+				checksum = adlerChecksum(msg->getBuffer() + msg->getBufferPosition() + CHECKSUM_LENGTH, len);
 			} else {
 				checksum = 0;
 			}
 
-			uint32_t recvChecksum = msg.get<uint32_t>();
+			uint32_t recvChecksum = msg->get<uint32_t>();
 			if (recvChecksum != checksum) {
 				// it might not have been the checksum, step back
-				msg.skipBytes(-CHECKSUM_LENGTH);
+				msg->skipBytes(-CHECKSUM_LENGTH);
 			}
 
 			// Game protocol has already been created at this point
-			protocol = service_port->make_protocol(recvChecksum == checksum, msg, shared_from_this());
+			protocol = service_port->make_protocol(recvChecksum == checksum, *msg, shared_from_this());
 			if (!protocol) {
 				close(FORCE_CLOSE);
 				return;
@@ -276,12 +300,12 @@ void Connection::parsePacket(const std::error_code& error)
 		} else {
 			// It is rather hard to detect if we have checksum or sequence method here so let's skip checksum check
 			// it doesn't generate any problem because olders protocol don't use 'server sends first' feature
-			msg.get<uint32_t>();
+			msg->get<uint32_t>();
 			// Skip protocol ID
-			msg.skipBytes(1);
+			msg->skipBytes(1);
 		}
 
-		protocol->onRecvFirstMessage(msg);
+		protocol->onRecvFirstMessage(*msg);
 	} else {
 		// Send the packet to the current protocol
 		skipReadingNextPacket = protocol->onRecvMessage(msg);
@@ -293,7 +317,7 @@ void Connection::parsePacket(const std::error_code& error)
 
 		if (!skipReadingNextPacket) {
 			// Wait to the next packet
-			asio::async_read(socket, asio::buffer(msg.getBuffer(), HEADER_LENGTH), std::bind(&Connection::parseHeader, shared_from_this(), std::placeholders::_1));
+			readHeader();
 		}
 	} catch (const std::system_error& e) {
 		SPDLOG_ERROR("[Connection::parsePacket] - error: {}", e.what());
@@ -303,46 +327,55 @@ void Connection::parsePacket(const std::error_code& error)
 
 void Connection::resumeWork()
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
+	asio::post(strand, [self = shared_from_this()]() {
+		try {
+			// Wait to the next packet
+			self->readHeader();
+		} catch (const std::system_error& e) {
+			SPDLOG_ERROR("[Connection::resumeWork] - error: {}", e.what());
+			self->close(FORCE_CLOSE);
+		}
+	});
+}
 
-	try {
-		// Wait to the next packet
-		asio::async_read(socket, asio::buffer(msg.getBuffer(), HEADER_LENGTH), std::bind(&Connection::parseHeader, shared_from_this(), std::placeholders::_1));
-	} catch (const std::system_error& e) {
-		SPDLOG_ERROR("[Connection::resumeWork] - error: {}", e.what());
-		close(FORCE_CLOSE);
+void Connection::readHeader()
+{
+	// The previous packet may still be owned by a dispatcher task
+	if (!msg || msg.use_count() > 1) {
+		msg = NetworkMessage::getInputMessage(HEADER_LENGTH);
+	} else {
+		msg->reset();
 	}
+
+	asio::async_read(socket, asio::buffer(msg->getBuffer(), HEADER_LENGTH), std::bind(&Connection::parseHeader, shared_from_this(), std::placeholders::_1));
 }
 
 void Connection::send(const OutputMessage_ptr& outputMessage)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-	if (connectionState == CONNECTION_STATE_CLOSED) {
-		return;
-	}
+	// Make the I/O threads handle xtea encryption instead of dispatcher
+	try {
+		asio::post(strand, [self = shared_from_this(), outputMessage]() {
+			if (self->connectionState == CONNECTION_STATE_CLOSED) {
+				return;
+			}
 
-	bool noPendingWrite = messageQueue.empty();
-	messageQueue.emplace_back(outputMessage);
-	if (noPendingWrite) {
-		// Make asio thread handle xtea encryption instead of dispatcher
-		try {
-			asio::post(socket.get_executor(), std::bind(&Connection::internalWorker, shared_from_this()));
-		} catch (const std::system_error& e) {
-			SPDLOG_ERROR("[Connection::send] - error: {}", e.what());
-			messageQueue.clear();
-			close(FORCE_CLOSE);
-		}
+			bool noPendingWrite = self->messageQueue.empty();
+			self->messageQueue.emplace_back(outputMessage);
+			if (noPendingWrite) {
+				self->internalWorker();
+			}
+		});
+	} catch (const std::system_error& e) {
+		SPDLOG_ERROR("[Connection::send] - error: {}", e.what());
+		close(FORCE_CLOSE);
 	}
 }
 
 void Connection::internalWorker()
 {
-	std::unique_lock<std::recursive_mutex> lockClass(connectionLock);
 	if (!messageQueue.empty()) {
 		const OutputMessage_ptr& outputMessage = messageQueue.front();
-		lockClass.unlock();
 		protocol->onSendMessage(outputMessage);
-		lockClass.lock();
 		internalSend(outputMessage);
 	} else if (connectionState == CONNECTION_STATE_CLOSED) {
 		closeSocket();
@@ -351,7 +384,11 @@ void Connection::internalWorker()
 
 uint32_t Connection::getIP()
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
+	// Resolved once by ServicePort::onAccept, before the socket is used by the strand
+	uint32_t cachedIp = ip.load(std::memory_order_acquire);
+	if (cachedIp != 0) {
+		return cachedIp;
+	}
 
 	// IP-address is expressed in network byte order
 	std::error_code error;
@@ -360,7 +397,9 @@ uint32_t Connection::getIP()
 		return 0;
 	}
 
-	return htonl(endpoint.address().to_v4().to_ulong());
+	uint32_t remoteIp = htonl(endpoint.address().to_v4().to_ulong());
+	ip.store(remoteIp, std::memory_order_release);
+	return remoteIp;
 }
 
 void Connection::internalSend(const OutputMessage_ptr& outputMessage)
@@ -379,8 +418,8 @@ void Connection::internalSend(const OutputMessage_ptr& outputMessage)
 
 void Connection::onWriteOperation(const std::error_code& error)
 {
-	std::unique_lock<std::recursive_mutex> lockClass(connectionLock);
 	writeTimer.cancel();
+	// Last reference to the message, its buffer goes back to the pool
 	messageQueue.pop_front();
 
 	if (error) {
@@ -391,9 +430,7 @@ void Connection::onWriteOperation(const std::error_code& error)
 
 	if (!messageQueue.empty()) {
 		const OutputMessage_ptr& outputMessage = messageQueue.front();
-		lockClass.unlock();
 		protocol->onSendMessage(outputMessage);
-		lockClass.lock();
 		internalSend(outputMessage);
 	} else if (connectionState == CONNECTION_STATE_CLOSED) {
 		closeSocket();
@@ -48,6 +48,11 @@ class ConnectionManager
 		std::mutex connectionManagerLock;
 };
 
+/**
+ * Every connection is bound to its own strand: all of its handlers run
+ * serialized, on whichever I/O thread is free, so packets of different
+ * clients are read, encrypted and compressed in parallel.
+ */
 class Connection : public std::enable_shared_from_this<Connection>
 {
 	public:
@@ -82,7 +87,9 @@ class Connection : public std::enable_shared_from_this<Connection>
 
 		static void handleTimeout(ConnectionWeak_ptr connectionWeak, const std::error_code& error);
 
+		void internalClose(bool force);
 		void closeSocket();
+		void readHeader();
 		void internalWorker();
 		void internalSend(const OutputMessage_ptr& outputMessage);
 
@@ -90,13 +97,14 @@ class Connection : public std::enable_shared_from_this<Connection>
 			return socket;
 		}
 
-		NetworkMessage msg;
+		asio::strand<asio::io_service::executor_type> strand;
+
+		// Packet being read, replaced whenever a dispatcher task still holds it
+		InputMessage_ptr msg;
 
 		asio::high_resolution_timer readTimer;
 		asio::high_resolution_timer writeTimer;
 
-		std::recursive_mutex connectionLock;
-
 		std::list<OutputMessage_ptr> messageQueue;
 
 		ConstServicePort_ptr service_port;
@@ -106,6 +114,7 @@ class Connection : public std::enable_shared_from_this<Connection>
 
 		time_t timeConnected;
 		uint32_t packetsSent = 0;
+		std::atomic<uint32_t> ip {0};
 
 		std::underlying_type_t<ConnectionState_t> connectionState = CONNECTION_STATE_OPEN;
 		bool receivedFirst = false;
@@ -12,6 +12,102 @@
 #include "server/network/message/networkmessage.h"
 #include "items/containers/container.h"
 #include "creatures/creature.h"
+#include "utils/block_pool.hpp"
+
+namespace {
+	using SmallBufferPool = BlockPool<NetworkMessage::BUFFER_SIZE_CLASSES[0], 64>;
+	using MediumBufferPool = BlockPool<NetworkMessage::BUFFER_SIZE_CLASSES[1], 16>;
+	using LargeBufferPool = BlockPool<NetworkMessage::BUFFER_SIZE_CLASSES[2], 4>;
+}
+
+uint8_t* NetworkMessage::allocateBuffer(size_t size, uint32_t &capacity)
+{
+	if (size <= BUFFER_SIZE_CLASSES[0]) {
+		capacity = BUFFER_SIZE_CLASSES[0];
+		return static_cast<uint8_t*>(SmallBufferPool::allocate());
+	} else if (size <= BUFFER_SIZE_CLASSES[1]) {
+		capacity = BUFFER_SIZE_CLASSES[1];
+		return static_cast<uint8_t*>(MediumBufferPool::allocate());
+	} else if (size <= BUFFER_SIZE_CLASSES[2]) {
+		capacity = BUFFER_SIZE_CLASSES[2];
+		return static_cast<uint8_t*>(LargeBufferPool::allocate());
+	}
+
+	capacity = static_cast<uint32_t>(size);
+	return static_cast<uint8_t*>(::operator new(size));
+}
+
+void NetworkMessage::releaseBuffer(uint8_t* buffer, uint32_t capacity)
+{
+	if (capacity == BUFFER_SIZE_CLASSES[0]) {
+		SmallBufferPool::deallocate(buffer);
+	} else if (capacity == BUFFER_SIZE_CLASSES[1]) {
+		MediumBufferPool::deallocate(buffer);
+	} else if (capacity == BUFFER_SIZE_CLASSES[2]) {
+		LargeBufferPool::deallocate(buffer);
+	} else {
+		::operator delete(buffer);
+	}
+}
+
+std::array<BlockPoolStats, NetworkMessage::BUFFER_SIZE_CLASSES.size()> NetworkMessage::getBufferStats()
+{
+	return { SmallBufferPool::getStats(), MediumBufferPool::getStats(), LargeBufferPool::getStats() };
+}
+
+void NetworkMessage::grow(size_t size)
+{
+	uint32_t newCapacity;
+	uint8_t* newBuffer = allocateBuffer(size, newCapacity);
+	memcpy(newBuffer, buffer, capacity);
+	releaseBuffer(buffer, capacity);
+	buffer = newBuffer;
+	capacity = newCapacity;
+}
+
+NetworkMessage::NetworkMessage(const NetworkMessage& other) :
+	info(other.info), buffer(allocateBuffer(other.capacity, capacity))
+{
+	memcpy(buffer, other.buffer, capacity);
+}
+
+NetworkMessage& NetworkMessage::operator=(const NetworkMessage& other)
+{
+	if (this != &other) {
+		if (capacity != other.capacity) {
+			releaseBuffer(buffer, capacity);
+			buffer = allocateBuffer(other.capacity, capacity);
+		}
+		info = other.info;
+		memcpy(buffer, other.buffer, capacity);
+	}
+	return *this;
+}
+
+NetworkMessage::NetworkMessage(NetworkMessage&& other) noexcept :
+	info(other.info), capacity(other.capacity), buffer(other.buffer)
+{
+	other.info = {};
+	other.capacity = 0;
+	other.buffer = nullptr;
+}
+
+NetworkMessage& NetworkMessage::operator=(NetworkMessage&& other) noexcept
+{
+	if (this != &other) {
+		std::swap(info, other.info);
+		std::swap(capacity, other.capacity);
+		std::swap(buffer, other.buffer);
+	}
+	return *this;
+}
+
+NetworkMessage::~NetworkMessage()
+{
+	if (buffer) {
+		releaseBuffer(buffer, capacity);
+	}
+}
 
 int32_t NetworkMessage::decodeHeader()
 {
@@ -93,11 +189,10 @@ void NetworkMessage::addBytes(const char* bytes, size_t size)
 
 void NetworkMessage::addPaddingBytes(size_t n)
 {
-	#define canAdd(size) ((size + info.position) < NETWORKMESSAGE_MAXSIZE)
-	if (!canAdd(n)) {
+	if ((n + info.position) >= NETWORKMESSAGE_MAXSIZE) {
 		return;
 	}
-	#undef canAdd
+	reserve(n + info.position + 1);
 
 	memset(buffer + info.position, 0x33, n);
 	info.length += n;
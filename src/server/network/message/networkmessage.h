@@ -18,6 +18,9 @@ class Creature;
 class Player;
 struct Position;
 class RSA;
+struct BlockPoolStats;
+class NetworkMessage;
+using InputMessage_ptr = std::shared_ptr<NetworkMessage>;
 
 class NetworkMessage
 {
@@ -28,8 +31,39 @@ class NetworkMessage
 		// 4 bytes for checksum
 		// 2 bytes for encrypted message size
 		static constexpr MsgSize_t INITIAL_BUFFER_POSITION = 8;
+		// Buffers are recycled in these size classes
+		static constexpr std::array<uint32_t, 3> BUFFER_SIZE_CLASSES = { 1024, 8192, 65536 };
 
-		NetworkMessage() = default;
+		// Starts in the smallest size class and grows as bytes are added
+		NetworkMessage() : NetworkMessage(BUFFER_SIZE_CLASSES[0]) {}
+		// The buffer can hold at least size bytes, rounded up to a size class
+		explicit NetworkMessage(size_t size) : buffer(allocateBuffer(size, capacity)) {}
+
+		NetworkMessage(const NetworkMessage& other);
+		NetworkMessage& operator=(const NetworkMessage& other);
+		NetworkMessage(NetworkMessage&& other) noexcept;
+		NetworkMessage& operator=(NetworkMessage&& other) noexcept;
+
+		~NetworkMessage();
+
+		/**
+		 * Inbound packets are read straight into a pooled message sized for
+		 * the packet, which is then shared with the dispatcher tasks that
+		 * parse it instead of being copied.
+		 */
+		static InputMessage_ptr getInputMessage(size_t size) {
+			return std::make_shared<NetworkMessage>(size);
+		}
+
+		// Usage of each buffer size class
+		static std::array<BlockPoolStats, BUFFER_SIZE_CLASSES.size()> getBufferStats();
+
+		// Moves the content to a bigger size class if size bytes do not fit
+		void reserve(size_t size) {
+			if (size > capacity) {
+				grow(size);
+			}
+		}
 
 		void reset() {
 			info = {};
@@ -133,18 +167,33 @@ class NetworkMessage
 			return buffer;
 		}
 
+		uint32_t getCapacity() const {
+			return capacity;
+		}
+
 		uint8_t* getBodyBuffer() {
 			info.position = 2;
 			return buffer + HEADER_LENGTH;
 		}
 
 	protected:
-		bool canAdd(size_t size) const {
-			return (size + info.position) < MAX_BODY_LENGTH;
+		static uint8_t* allocateBuffer(size_t size, uint32_t &capacity);
+		static void releaseBuffer(uint8_t* buffer, uint32_t capacity);
+
+		void grow(size_t size);
+
+		bool canAdd(size_t size) {
+			const size_t required = size + info.position;
+			if (required >= MAX_BODY_LENGTH) {
+				return false;
+			}
+
+			reserve(required + 1);
+			return true;
 		}
 
 		bool canRead(int32_t size) {
-			if ((info.position + size) > (info.length + 8) || size >= (NETWORKMESSAGE_MAXSIZE - info.position)) {
+			if ((info.position + size) > (info.length + 8) || size >= (static_cast<int32_t>(capacity) - info.position)) {
 				info.overrun = true;
 				return false;
 			}
@@ -158,7 +207,8 @@ class NetworkMessage
 		};
 
 		NetworkMessageInfo info;
-		uint8_t buffer[NETWORKMESSAGE_MAXSIZE];
+		uint32_t capacity = 0;
+		uint8_t* buffer;
 };
 
 #endif // SRC_SERVER_NETWORK_MESSAGE_NETWORKMESSAGE_H_
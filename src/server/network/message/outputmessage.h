@@ -43,6 +43,7 @@ class OutputMessage : public NetworkMessage
 
 		void append(const NetworkMessage& msg) {
 			auto msgLen = msg.getLength();
+			reserve(info.position + msgLen);
 			memcpy(buffer + info.position, msg.getBuffer() + INITIAL_BUFFER_POSITION, msgLen);
 			info.length += msgLen;
 			info.position += msgLen;
@@ -50,6 +51,7 @@ class OutputMessage : public NetworkMessage
 
 		void append(const OutputMessage_ptr& msg) {
 			auto msgLen = msg->getLength();
+			reserve(info.position + msgLen);
 			memcpy(buffer + info.position, msg->getBuffer() + INITIAL_BUFFER_POSITION, msgLen);
 			info.length += msgLen;
 			info.position += msgLen;
@@ -83,6 +85,10 @@ class OutputMessagePool
 		void sendAll();
 		void scheduleSendAll();
 
+		/**
+		 * Messages start in the smallest buffer size class and grow in place,
+		 * buffers go back to the pool once the write completes.
+		 */
 		static OutputMessage_ptr getOutputMessage();
 
 		void addProtocolToAutosend(Protocol_ptr protocol);
@@ -14,13 +14,51 @@
 #include "security/rsa.h"
 #include "game/scheduling/tasks.h"
 
+namespace {
+
+// Smaller messages are never worth compressing
+constexpr uint32_t COMPRESSION_MIN_SIZE = 128;
+// Connections whose messages shrink less than this are sent uncompressed...
+constexpr float COMPRESSION_SKIP_RATIO = 0.9f;
+// ...except one message out of this many, to notice when the traffic changes
+constexpr uint32_t COMPRESSION_PROBE_INTERVAL = 32;
+// Share of the I/O threads time spent compressing above which level 1 is used
+constexpr double COMPRESSION_BUSY_SHARE = 0.25;
+
+std::atomic<uint64_t> compressedMessages {0};
+std::atomic<uint64_t> skippedMessages {0};
+std::atomic<uint64_t> compressionBytesIn {0};
+std::atomic<uint64_t> compressionBytesOut {0};
+std::atomic<uint64_t> compressionMicroseconds {0};
+
+// Time spent compressing by all I/O threads in the current and in the last second
+std::atomic<int64_t> compressionWindow {0};
+std::atomic<uint64_t> compressionWindowMicroseconds {0};
+std::atomic<uint64_t> compressionLastWindowMicroseconds {0};
+
+void addCompressionTime(uint64_t microseconds)
+{
+	compressionMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+
+	int64_t second = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t window = compressionWindow.load(std::memory_order_relaxed);
+	if (window != second && compressionWindow.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+		// A whole second without compressions means the last window was idle
+		uint64_t spent = compressionWindowMicroseconds.exchange(0, std::memory_order_relaxed);
+		compressionLastWindowMicroseconds.store(second - window == 1 ? spent : 0, std::memory_order_relaxed);
+	}
+	compressionWindowMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 Protocol::~Protocol() = default;
 
 void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 {
 	if (!rawMessages) {
 		uint32_t sendMessageChecksum = 0;
-		if (compreesionEnabled && msg->getLength() >= 128 && compression(*msg)) {
+		if (compreesionEnabled && msg->getLength() >= COMPRESSION_MIN_SIZE && compression(*msg)) {
 			sendMessageChecksum = (1U << 31);
 		}
 
@@ -44,15 +82,16 @@ void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 	}
 }
 
-bool Protocol::sendRecvMessageCallback(NetworkMessage& msg)
+bool Protocol::sendRecvMessageCallback(const InputMessage_ptr& msg)
 {
-	if (encryptionEnabled && !XTEA_decrypt(msg)) {
+	if (encryptionEnabled && !XTEA_decrypt(*msg)) {
 		SPDLOG_ERROR("[Protocol::onRecvMessage] - XTEA_decrypt Failed");
 		return false;
 	}
 
 	auto protocolWeak = std::weak_ptr<Protocol>(shared_from_this());
-	std::function<void (void)> callback = [protocolWeak, &msg]() {
+	// The task shares ownership of the packet, nothing is copied
+	auto callback = [protocolWeak, msg]() {
 		if (auto protocol = protocolWeak.lock()) {
 			if (auto protocolConnection = protocol->getConnection()) {
 				protocol->parsePacket(msg);
@@ -60,14 +99,14 @@ bool Protocol::sendRecvMessageCallback(NetworkMessage& msg)
 			}
 		}
 	};
-	g_dispatcher().addTask(createTask(callback));
+	g_dispatcher().addTask(createTask(std::move(callback)));
 	return true;
 }
 
-bool Protocol::onRecvMessage(NetworkMessage& msg)
+bool Protocol::onRecvMessage(const InputMessage_ptr& msg)
 {
 	if (checksumMethod != CHECKSUM_METHOD_NONE) {
-		uint32_t recvChecksum = msg.get<uint32_t>();
+		uint32_t recvChecksum = msg->get<uint32_t>();
 		if (checksumMethod == CHECKSUM_METHOD_SEQUENCE) {
 			if (recvChecksum == 0) {
 				// checksum 0 indicate that the packet should be connection ping - 0x1C packet header
@@ -87,10 +126,10 @@ bool Protocol::onRecvMessage(NetworkMessage& msg)
 			}
 		} else {
 			uint32_t checksum;
-			if (int32_t len = msg.getLength() - msg.getBufferPosition();
+			if (int32_t len = msg->getLength() - msg->getBufferPosition();
 			len > 0)
 			{
-				checksum = adlerChecksum(msg.getBuffer() + msg.getBufferPosition(), len);
+				checksum = adlerChecksum(msg->getBuffer() + msg->getBufferPosition(), len);
 			} else {
 				checksum = 0;
 			}
@@ -114,41 +153,20 @@ OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 		send(outputBuffer);
 		outputBuffer = OutputMessagePool::getOutputMessage();
 	}
+	// Grow the buffer to the size class that fits the new data
+	outputBuffer->reserve(outputBuffer->getBufferPosition() + size);
 	return outputBuffer;
 }
 
 void Protocol::XTEA_encrypt(OutputMessage& msg) const
 {
-	const uint32_t delta = 0x61C88647;
-
 	// The message must be a multiple of 8
 	size_t paddingBytes = msg.getLength() & 7;
 	if (paddingBytes != 0) {
 		msg.addPaddingBytes(8 - paddingBytes);
 	}
 
-	uint8_t* buffer = msg.getOutputBuffer();
-	auto messageLength = static_cast<int32_t>(msg.getLength());
-	int32_t readPos = 0;
-	const std::array<uint32_t, 4> newKey = {key[0], key[1], key[2], key[3]};
-	// TODO: refactor this for not use c-style
-	uint32_t precachedControlSum[32][2];
-	uint32_t sum = 0;
-	for (int32_t i = 0; i < 32; ++i) {
-		precachedControlSum[i][0] = (sum + newKey[sum & 3]);
-		sum -= delta;
-		precachedControlSum[i][1] = (sum + newKey[(sum >> 11) & 3]);
-	}
-	while (readPos < messageLength) {
-		std::array<uint32_t, 2> vData = {};
-		memcpy(vData.data(), buffer + readPos, 8);
-		for (int32_t i = 0; i < 32; ++i) {
-			vData[0] += ((vData[1] << 4 ^ vData[1] >> 5) + vData[1]) ^ precachedControlSum[i][0];
-			vData[1] += ((vData[0] << 4 ^ vData[0] >> 5) + vData[0]) ^ precachedControlSum[i][1];
-		}
-		memcpy(buffer + readPos, vData.data(), 8);
-		readPos += 8;
-	}
+	xtea::encrypt(msg.getOutputBuffer(), msg.getLength(), key);
 }
 
 bool Protocol::XTEA_decrypt(NetworkMessage& msg) const
@@ -158,30 +176,7 @@ bool Protocol::XTEA_decrypt(NetworkMessage& msg) const
 		return false;
 	}
 
-	const uint32_t delta = 0x61C88647;
-
-	uint8_t* buffer = msg.getBuffer() + msg.getBufferPosition();
-	auto messageLength = static_cast<int32_t>(msgLength);
-	int32_t readPos = 0;
-	const std::array<uint32_t, 4> newKey = {key[0], key[1], key[2], key[3]};
-	// TODO: refactor this for not use c-style
-	uint32_t precachedControlSum[32][2];
-	uint32_t sum = 0xC6EF3720;
-	for (int32_t i = 0; i < 32; ++i) {
-		precachedControlSum[i][0] = (sum + newKey[(sum >> 11) & 3]);
-		sum += delta;
-		precachedControlSum[i][1] = (sum + newKey[sum & 3]);
-	}
-	while (readPos < messageLength) {
-		std::array<uint32_t, 2> vData = {};
-		memcpy(vData.data(), buffer + readPos, 8);
-		for (int32_t i = 0; i < 32; ++i) {
-			vData[1] -= ((vData[0] << 4 ^ vData[0] >> 5) + vData[0]) ^ precachedControlSum[i][0];
-			vData[0] -= ((vData[1] << 4 ^ vData[1] >> 5) + vData[1]) ^ precachedControlSum[i][1];
-		}
-		memcpy(buffer + readPos, vData.data(), 8);
-		readPos += 8;
-	}
+	xtea::decrypt(msg.getBuffer() + msg.getBufferPosition(), msgLength, key);
 
 	uint16_t innerLength = msg.get<uint16_t>();
 	if (std::cmp_greater(innerLength, msgLength - 2)) {
@@ -216,15 +211,15 @@ uint32_t Protocol::getIP() const
 void Protocol::enableCompression()
 {
 	if (!compreesionEnabled) {
-		int32_t compressionLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
+		compressionLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
 		if (compressionLevel != 0) {
 			defStream.reset(new z_stream);
 			defStream->zalloc = Z_NULL;
 			defStream->zfree = Z_NULL;
 			defStream->opaque = Z_NULL;
 			if (deflateInit2(defStream.get(), compressionLevel, Z_DEFLATED, -15, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
-				defStream.reset();
 				SPDLOG_ERROR("[Protocol::enableCompression()] - Zlib deflateInit2 error: {}", (defStream->msg ? defStream->msg : " unknown error"));
+				defStream.reset();
 			} else {
 				compreesionEnabled = true;
 			}
@@ -232,7 +227,26 @@ void Protocol::enableCompression()
 	}
 }
 
-bool Protocol::compression(OutputMessage& msg) const
+CompressionStats Protocol::getCompressionStats()
+{
+	CompressionStats stats;
+	stats.compressedMessages = compressedMessages.load(std::memory_order_relaxed);
+	stats.skippedMessages = skippedMessages.load(std::memory_order_relaxed);
+	stats.bytesIn = compressionBytesIn.load(std::memory_order_relaxed);
+	stats.bytesOut = compressionBytesOut.load(std::memory_order_relaxed);
+	stats.microseconds = compressionMicroseconds.load(std::memory_order_relaxed);
+	return stats;
+}
+
+int32_t Protocol::getAdaptiveCompressionLevel() const
+{
+	int32_t configLevel = g_configManager().getNumber(COMPRESSION_LEVEL);
+	auto threads = std::max<int32_t>(1, g_configManager().getNumber(IO_THREADS));
+	double busyShare = static_cast<double>(compressionLastWindowMicroseconds.load(std::memory_order_relaxed)) / (1000000.0 * threads);
+	return busyShare > COMPRESSION_BUSY_SHARE ? 1 : configLevel;
+}
+
+bool Protocol::compression(OutputMessage& msg)
 {
 	auto outputMessageSize = msg.getLength();
 	if (outputMessageSize > NETWORKMESSAGE_MAXSIZE) {
@@ -240,23 +254,51 @@ bool Protocol::compression(OutputMessage& msg) const
 		return false;
 	}
 
+	bool adaptive = g_configManager().getBoolean(ADAPTIVE_COMPRESSION);
+	if (adaptive) {
+		if (compressionRatio > COMPRESSION_SKIP_RATIO && ++compressionSkips < COMPRESSION_PROBE_INTERVAL) {
+			skippedMessages.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		compressionSkips = 0;
+
+		// The stream was reset after the last message, so the level can change freely
+		if (int32_t level = getAdaptiveCompressionLevel();
+		level != compressionLevel && deflateParams(defStream.get(), level, Z_DEFAULT_STRATEGY) == Z_OK) {
+			compressionLevel = level;
+		}
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
 	static thread_local std::array<char, NETWORKMESSAGE_MAXSIZE> defBuffer;
 	defStream->next_in = msg.getOutputBuffer();
 	defStream->avail_in = outputMessageSize;
 	defStream->next_out = (Bytef*)defBuffer.data();
 	defStream->avail_out = NETWORKMESSAGE_MAXSIZE;
 
-	if (int32_t ret = deflate(defStream.get(), Z_FINISH);
-	ret != Z_OK && ret != Z_STREAM_END)
-	{
-		return false;
-	}
+	int32_t ret = deflate(defStream.get(), Z_FINISH);
 	auto totalSize = static_cast<uint32_t>(defStream->total_out);
 	deflateReset(defStream.get());
-	if (totalSize == 0) {
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	addCompressionTime(static_cast<uint64_t>(elapsed));
+
+	if ((ret != Z_OK && ret != Z_STREAM_END) || totalSize == 0) {
 		return false;
 	}
 
+	compressionRatio += (static_cast<float>(totalSize) / outputMessageSize - compressionRatio) / 8;
+	if (adaptive && totalSize >= outputMessageSize) {
+		// Nothing saved, the original message is still intact
+		skippedMessages.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	compressedMessages.fetch_add(1, std::memory_order_relaxed);
+	compressionBytesIn.fetch_add(outputMessageSize, std::memory_order_relaxed);
+	compressionBytesOut.fetch_add(totalSize, std::memory_order_relaxed);
+
 	msg.reset();
 	auto charData = static_cast<char*>(static_cast<void*>(defBuffer.data()));
 	msg.addBytes(charData, static_cast<size_t>(totalSize));
@@ -12,6 +12,16 @@
 
 #include "server/network/connection/connection.h"
 #include "config/configmanager.h"
+#include "security/xtea.h"
+
+struct CompressionStats {
+	uint64_t compressedMessages = 0;
+	// Messages sent uncompressed by the adaptive mode
+	uint64_t skippedMessages = 0;
+	uint64_t bytesIn = 0;
+	uint64_t bytesOut = 0;
+	uint64_t microseconds = 0;
+};
 
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
@@ -23,11 +33,11 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 		Protocol(const Protocol&) = delete;
 		Protocol& operator=(const Protocol&) = delete;
 
-		virtual void parsePacket(NetworkMessage&) {}
+		virtual void parsePacket(const InputMessage_ptr&) {}
 
 		virtual void onSendMessage(const OutputMessage_ptr& msg);
-		bool onRecvMessage(NetworkMessage& msg);
-		bool sendRecvMessageCallback(NetworkMessage& msg);
+		bool onRecvMessage(const InputMessage_ptr& msg);
+		bool sendRecvMessageCallback(const InputMessage_ptr& msg);
 		virtual void onRecvFirstMessage(NetworkMessage& msg) = 0;
 		virtual void onConnect() {}
 
@@ -41,6 +51,8 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 
 		uint32_t getIP() const;
 
+		static CompressionStats getCompressionStats();
+
 		//Use this function for autosend messages only
 		OutputMessage_ptr getOutputBuffer(int32_t size);
 
@@ -66,7 +78,9 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 			encryptionEnabled = true;
 		}
 		void setXTEAKey(const uint32_t* newKey) {
-			memcpy(this->key.data(), newKey, sizeof(*newKey) * 4);
+			std::array<uint32_t, 4> xteaKey;
+			memcpy(xteaKey.data(), newKey, sizeof(*newKey) * 4);
+			key = xtea::expandKey(xteaKey);
 		}
 		void setChecksumMethod(ChecksumMethods_t method) {
 			checksumMethod = method;
@@ -84,14 +98,19 @@ class Protocol : public std::enable_shared_from_this<Protocol>
 	private:
 		void XTEA_encrypt(OutputMessage& msg) const;
 		bool XTEA_decrypt(NetworkMessage& msg) const;
-		bool compression(OutputMessage& msg) const;
+		bool compression(OutputMessage& msg);
+		int32_t getAdaptiveCompressionLevel() const;
 
 
 		OutputMessage_ptr outputBuffer;
 		std::unique_ptr<z_stream> defStream;
+		int32_t compressionLevel = 0;
+		// Moving average of compressed / original size on this connection
+		float compressionRatio = 0.5f;
+		uint32_t compressionSkips = 0;
 
 		const ConnectionWeak_ptr connectionPtr;
-		std::array<uint32_t, 4> key = {};
+		xtea::round_keys key = {};
 		uint32_t serverSequenceNumber = 0;
 		uint32_t clientSequenceNumber = 0;
 		std::underlying_type_t<ChecksumMethods_t> checksumMethod = CHECKSUM_METHOD_NONE;
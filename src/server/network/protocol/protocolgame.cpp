@@ -17,6 +17,8 @@
 #include "io/iobestiary.h"
 #include "io/iologindata.h"
 #include "io/iomarket.h"
+#include "io/playerloader.h"
+#include "io/savewriter.h"
 #include "lua/modules/modules.h"
 #include "creatures/monsters/monster.h"
 #include "creatures/monsters/monsters.h"
@@ -268,145 +270,223 @@ void ProtocolGame::release()
 	Protocol::release();
 }
 
+struct ProtocolGame::LoginData
+{
+	std::string name;
+	uint32_t accountId = 0;
+	OperatingSystem_t operatingSystem = CLIENTOS_NONE;
+	std::chrono::steady_clock::time_point start;
+	uint64_t saveSequence = 0;
+
+	// Written by the loader thread
+	PlayerLoadData player;
+	BanInfo banInfo;
+	bool fetched = false;
+	bool namelocked = false;
+	bool banned = false;
+};
+
 void ProtocolGame::login(const std::string &name, uint32_t accountId, OperatingSystem_t operatingSystem)
 {
 	//dispatcher thread
 	Player *foundPlayer = g_game().getPlayerByName(name);
 	if (!foundPlayer || g_configManager().getBoolean(ALLOW_CLONES))
 	{
-		player = new Player(getThis());
-		player->setName(name);
+		auto loginData = std::make_shared<LoginData>();
+		loginData->name = name;
+		loginData->accountId = accountId;
+		loginData->operatingSystem = operatingSystem;
+		loginData->start = std::chrono::steady_clock::now();
+		fetchPlayer(loginData);
+		return;
+	}
 
-		player->incrementReferenceCounter();
-		player->setID();
+	if (eventConnect != 0 || !g_configManager().getBoolean(REPLACE_KICK_ON_LOGIN))
+	{
+		//Already trying to connect
+		disconnectClient("You are already logged in.");
+		return;
+	}
 
-		if (!IOLoginData::preloadPlayer(player, name))
-		{
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+	if (foundPlayer->client)
+	{
+		foundPlayer->disconnect();
+		foundPlayer->isConnecting = true;
 
-		if (IOBan::isPlayerNamelocked(player->getGUID()))
-		{
-			disconnectClient("Your character has been namelocked.");
-			return;
-		}
+		eventConnect = g_scheduler().addEvent(createSchedulerTask(1000, std::bind(&ProtocolGame::connect, getThis(), foundPlayer->getID(), operatingSystem)));
+	}
+	else
+	{
+		connect(foundPlayer->getID(), operatingSystem);
+	}
+	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+}
 
-		if (g_game().getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin))
-		{
-			disconnectClient("The game is just going down.\nPlease try again later.");
-			return;
-		}
+void ProtocolGame::fetchPlayer(const std::shared_ptr<LoginData> &loginData)
+{
+	//dispatcher thread
+	// The player is not online, so its last save is in the database. Any save
+	// made from now on, e.g. by a mailbox, means the rows read may be stale.
+	loginData->saveSequence = IOLoginData::getSaveSequence();
 
-		if (g_game().getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin))
+	g_playerLoader().addTask([protocol = getThis(), loginData]() {
+		//loader thread
+		loginData->player = PlayerLoadData();
+		loginData->fetched = IOLoginData::fetchPlayerByName(loginData->player, loginData->name);
+		if (loginData->fetched)
 		{
-			disconnectClient("Server is currently closed.\nPlease try again later.");
-			return;
+			loginData->namelocked = IOBan::isPlayerNamelocked(loginData->player.player->getNumber<uint32_t>("id"));
+			loginData->banned = IOBan::isAccountBanned(loginData->accountId, loginData->banInfo);
 		}
+		g_dispatcher().addTask(createTask(std::bind(&ProtocolGame::onPlayerFetched, protocol, loginData)));
+	});
+}
 
-		if (g_configManager().getBoolean(ONLY_PREMIUM_ACCOUNT) && !player->isPremium() && (player->getGroup()->id < account::GROUP_TYPE_GAMEMASTER || player->getAccountType() < account::ACCOUNT_TYPE_GAMEMASTER))
-		{
-			disconnectClient("Your premium time for this account is out.\n\nTo play please buy additional premium time from our website");
-			return;
-		}
+void ProtocolGame::onPlayerFetched(const std::shared_ptr<LoginData> &loginData)
+{
+	//dispatcher thread
+	if (isConnectionExpired())
+	{
+		return;
+	}
 
-		if (g_configManager().getBoolean(ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < account::ACCOUNT_TYPE_GAMEMASTER && g_game().getPlayerByAccount(player->getAccount()))
+	const std::string &name = loginData->name;
+	if (g_game().getPlayerByName(name) && !g_configManager().getBoolean(ALLOW_CLONES))
+	{
+		// Logged in by another connection in the meantime
+		login(name, loginData->accountId, loginData->operatingSystem);
+		return;
+	}
+
+	if (loginData->fetched)
+	{
+		uint32_t guid = loginData->player.player->getNumber<uint32_t>("id");
+		if (IOLoginData::isSavePending(guid))
 		{
-			disconnectClient("You may only login with one character\nof your account at the same time.");
+			// Its last save is still being written, fetch again once the writer is past it
+			g_saveWriter().addTask([protocol = getThis(), loginData]() {
+				g_dispatcher().addTask(createTask(std::bind(&ProtocolGame::fetchPlayer, protocol, loginData)));
+			});
 			return;
 		}
 
-		if (!player->hasFlag(PlayerFlags_t::CannotBeBanned))
+		if (IOLoginData::hasSavedSince(guid, loginData->saveSequence))
 		{
-			BanInfo banInfo;
-			if (IOBan::isAccountBanned(accountId, banInfo))
-			{
-				if (banInfo.reason.empty())
-				{
-					banInfo.reason = "(none)";
-				}
-
-				std::ostringstream ss;
-				if (banInfo.expiresAt > 0)
-				{
-					ss << "Your account has been banned until " << formatDateShort(banInfo.expiresAt) << " by " << banInfo.bannedBy << ".\n\nReason specified:\n"
-                      << banInfo.reason;
-				}
-				else
-				{
-					ss << "Your account has been permanently banned by " << banInfo.bannedBy << ".\n\nReason specified:\n"
-                      << banInfo.reason;
-				}
-				disconnectClient(ss.str());
-				return;
-			}
+			fetchPlayer(loginData);
+			return;
 		}
+	}
 
-		WaitingList &waitingList = WaitingList::getInstance();
-		if (!waitingList.clientLogin(player))
-		{
-			uint32_t currentSlot = waitingList.getClientSlot(player);
-			uint32_t retryTime = WaitingList::getTime(currentSlot);
-			std::ostringstream ss;
+	player = new Player(getThis());
+	player->setName(name);
 
-			ss << "Too many players online.\nYou are at place "
-               << currentSlot << " on the waiting list.";
+	player->incrementReferenceCounter();
+	player->setID();
 
-			auto output = OutputMessagePool::getOutputMessage();
-			output->addByte(0x16);
-			output->addString(ss.str());
-			output->addByte(retryTime);
-			send(output);
-			disconnect();
-			return;
-		}
+	if (!loginData->fetched || !IOLoginData::preloadPlayer(player, loginData->player))
+	{
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID()))
-		{
-			disconnectClient("Your character could not be loaded.");
-			SPDLOG_WARN("Player {} could not be loaded", player->getName());
-			return;
-		}
+	if (loginData->namelocked)
+	{
+		disconnectClient("Your character has been namelocked.");
+		return;
+	}
 
-		player->setOperatingSystem(operatingSystem);
+	if (g_game().getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin))
+	{
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return;
+	}
 
-		if (!g_game().placeCreature(player, player->getLoginPosition()) && !g_game().placeCreature(player, player->getTemplePosition(), false, true))
-		{
-			disconnectClient("Temple position is wrong. Please, contact the administrator.");
-			SPDLOG_WARN("Player {} temple position is wrong", player->getName());
-			return;
-		}
+	if (g_game().getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlags_t::CanAlwaysLogin))
+	{
+		disconnectClient("Server is currently closed.\nPlease try again later.");
+		return;
+	}
 
-		if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX)
-		{
-			player->registerCreatureEvent("ExtendedOpcode");
-		}
+	if (g_configManager().getBoolean(ONLY_PREMIUM_ACCOUNT) && !player->isPremium() && (player->getGroup()->id < account::GROUP_TYPE_GAMEMASTER || player->getAccountType() < account::ACCOUNT_TYPE_GAMEMASTER))
+	{
+		disconnectClient("Your premium time for this account is out.\n\nTo play please buy additional premium time from our website");
+		return;
+	}
 
-		player->lastIP = player->getIP();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
+	if (g_configManager().getBoolean(ONE_PLAYER_ON_ACCOUNT) && player->getAccountType() < account::ACCOUNT_TYPE_GAMEMASTER && g_game().getPlayerByAccount(player->getAccount()))
+	{
+		disconnectClient("You may only login with one character\nof your account at the same time.");
+		return;
 	}
-	else
+
+	if (!player->hasFlag(PlayerFlags_t::CannotBeBanned) && loginData->banned)
 	{
-		if (eventConnect != 0 || !g_configManager().getBoolean(REPLACE_KICK_ON_LOGIN))
+		BanInfo &banInfo = loginData->banInfo;
+		if (banInfo.reason.empty())
 		{
-			//Already trying to connect
-			disconnectClient("You are already logged in.");
-			return;
+			banInfo.reason = "(none)";
 		}
 
-		if (foundPlayer->client)
+		std::ostringstream ss;
+		if (banInfo.expiresAt > 0)
 		{
-			foundPlayer->disconnect();
-			foundPlayer->isConnecting = true;
-
-			eventConnect = g_scheduler().addEvent(createSchedulerTask(1000, std::bind(&ProtocolGame::connect, getThis(), foundPlayer->getID(), operatingSystem)));
+			ss << "Your account has been banned until " << formatDateShort(banInfo.expiresAt) << " by " << banInfo.bannedBy << ".\n\nReason specified:\n"
+              << banInfo.reason;
 		}
 		else
 		{
-			connect(foundPlayer->getID(), operatingSystem);
+			ss << "Your account has been permanently banned by " << banInfo.bannedBy << ".\n\nReason specified:\n"
+              << banInfo.reason;
 		}
+		disconnectClient(ss.str());
+		return;
 	}
+
+	WaitingList &waitingList = WaitingList::getInstance();
+	if (!waitingList.clientLogin(player))
+	{
+		uint32_t currentSlot = waitingList.getClientSlot(player);
+		uint32_t retryTime = WaitingList::getTime(currentSlot);
+		std::ostringstream ss;
+
+		ss << "Too many players online.\nYou are at place "
+               << currentSlot << " on the waiting list.";
+
+		auto output = OutputMessagePool::getOutputMessage();
+		output->addByte(0x16);
+		output->addString(ss.str());
+		output->addByte(retryTime);
+		send(output);
+		disconnect();
+		return;
+	}
+
+	if (!IOLoginData::loadPlayer(player, loginData->player))
+	{
+		disconnectClient("Your character could not be loaded.");
+		SPDLOG_WARN("Player {} could not be loaded", player->getName());
+		return;
+	}
+
+	player->setOperatingSystem(loginData->operatingSystem);
+
+	if (!g_game().placeCreature(player, player->getLoginPosition()) && !g_game().placeCreature(player, player->getTemplePosition(), false, true))
+	{
+		disconnectClient("Temple position is wrong. Please, contact the administrator.");
+		SPDLOG_WARN("Player {} temple position is wrong", player->getName());
+		return;
+	}
+
+	if (loginData->operatingSystem >= CLIENTOS_OTCLIENT_LINUX)
+	{
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	player->lastIP = player->getIP();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
+	g_playerLoader().addLoginTime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loginData->start));
 	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
 }
 
@@ -632,13 +712,16 @@ void ProtocolGame::writeToOutputBuffer(const NetworkMessage &msg)
 	out->append(msg);
 }
 
-void ProtocolGame::parsePacket(NetworkMessage& msg)
+void ProtocolGame::parsePacket(const InputMessage_ptr& inputMessage)
 {
+	NetworkMessage &msg = *inputMessage;
 	if (!acceptPackets || g_game().getGameState() == GAME_STATE_SHUTDOWN || msg.getLength() <= 0) {
 		return;
 	}
 
 	uint8_t recvbyte = msg.getByte();
+	// Both tasks below share the packet, each one starts reading from here
+	NetworkMessage::MsgSize_t position = msg.getBufferPosition();
 
 	if (!player || player->isRemoved()) {
 		if (recvbyte == 0x0F) {
@@ -654,10 +737,13 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 
 	// Modules system
 	if (player && recvbyte != 0xD3) {
-		g_dispatcher().addTask(createTask(std::bind(&Modules::executeOnRecvbyte, &g_modules(), player->getID(), msg, recvbyte)));
+		g_dispatcher().addTask(createTask([playerId = player->getID(), inputMessage, position, recvbyte]() {
+			inputMessage->setBufferPosition(position);
+			g_modules().executeOnRecvbyte(playerId, *inputMessage, recvbyte);
+		}));
 	}
 
-	g_dispatcher().addTask(createTask(std::bind(&ProtocolGame::parsePacketFromDispatcher, getThis(), msg, recvbyte)));
+	g_dispatcher().addTask(createTask(std::bind(&ProtocolGame::parsePacketFromDispatcher, getThis(), inputMessage, position, recvbyte)));
 }
 
 void ProtocolGame::parsePacketDead(uint8_t recvbyte)
@@ -709,8 +795,11 @@ void ProtocolGame::addBless()
 	}
 }
 
-void ProtocolGame::parsePacketFromDispatcher(NetworkMessage msg, uint8_t recvbyte)
+void ProtocolGame::parsePacketFromDispatcher(const InputMessage_ptr &inputMessage, NetworkMessage::MsgSize_t position, uint8_t recvbyte)
 {
+	NetworkMessage &msg = *inputMessage;
+	msg.setBufferPosition(position);
+
 	if (!acceptPackets || g_game().getGameState() == GAME_STATE_SHUTDOWN) {
 		return;
 	}
@@ -806,7 +895,7 @@ void ProtocolGame::parsePacketFromDispatcher(NetworkMessage msg, uint8_t recvbyt
 		case 0xCD: parseInspectionObject(msg); break;
 		case 0xD2: addGameTask(&Game::playerRequestOutfit, player->getID()); break;
 		//g_dispatcher().addTask(createTask(std::bind(&Modules::executeOnRecvbyte, g_modules, player, msg, recvbyte)));
-		case 0xD3: g_dispatcher().addTask(createTask(std::bind(&ProtocolGame::parseSetOutfit, getThis(), msg))); break;
+		case 0xD3: g_dispatcher().addTask(createTask([self = getThis(), inputMessage]() { self->parseSetOutfit(*inputMessage); })); break;
 		case 0xD4: parseToggleMount(msg); break;
 		case 0xD5: parseApplyImbuement(msg); break;
 		case 0xD6: parseClearImbuement(msg); break;
@@ -863,8 +952,103 @@ void ProtocolGame::parseHotkeyEquip(NetworkMessage &msg)
 	addGameTask(&Game::playerEquipItem, player->getID(), itemId, Item::items[itemId].upgradeClassification > 0, tier);
 }
 
+namespace {
+
+// Items on a tile encode the same for every viewer, except the ones showing a timer or charges
+bool hasStaticEncoding(const Item *item)
+{
+	const ItemType &it = Item::items[item->getID()];
+	return !it.isPodium && !it.expire && !it.expireStop && !it.clockExpire && !it.wearOut;
+}
+
+} // namespace
+
+const TileItemsEncoding* ProtocolGame::getTileItemsEncoding(const Tile *tile)
+{
+	const TileItemsEncoding* cached = tile->getItemsEncoding();
+	if (cached && cached->version == tile->getItemsVersion())
+	{
+		return cached->cacheable ? cached : nullptr;
+	}
+
+	TileItemsEncoding &encoding = tile->makeItemsEncoding();
+	encoding.version = tile->getItemsVersion();
+	encoding.cacheable = false;
+	encoding.topEntries = 0;
+	encoding.downEntries = 0;
+	encoding.data.clear();
+
+	// A description holds at most 10 things
+	std::array<const Item*, 20> entries;
+	if (Item *ground = tile->getGround())
+	{
+		entries[encoding.topEntries++] = ground;
+	}
+
+	if (const TileItemVector *items = tile->getItemList())
+	{
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end && encoding.topEntries < 10; ++it)
+		{
+			entries[encoding.topEntries++] = *it;
+		}
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end && encoding.downEntries < 10; ++it)
+		{
+			entries[encoding.topEntries + encoding.downEntries++] = *it;
+		}
+	}
+
+	const size_t entryCount = encoding.topEntries + encoding.downEntries;
+	for (size_t i = 0; i < entryCount; ++i)
+	{
+		if (!hasStaticEncoding(entries[i]))
+		{
+			return nullptr;
+		}
+	}
+
+	NetworkMessage entriesMsg;
+	const size_t start = entriesMsg.getBufferPosition();
+	encoding.data.resize(entryCount * sizeof(uint16_t));
+	for (size_t i = 0; i < entryCount; ++i)
+	{
+		AddItem(entriesMsg, entries[i]);
+		const auto end = static_cast<uint16_t>(entriesMsg.getBufferPosition() - start);
+		std::memcpy(encoding.data.data() + i * sizeof(uint16_t), &end, sizeof(uint16_t));
+	}
+	encoding.data.insert(encoding.data.end(), entriesMsg.getBuffer() + start, entriesMsg.getBuffer() + entriesMsg.getBufferPosition());
+	encoding.cacheable = true;
+	return &encoding;
+}
+
 void ProtocolGame::GetTileDescription(const Tile *tile, NetworkMessage &msg)
 {
+	if (const TileItemsEncoding* encoding = getTileItemsEncoding(tile))
+	{
+		const uint8_t* entries = encoding->getEntries();
+
+		// As below: ground and top items stop at 10 things, or 9 on the viewer's own tile to leave room for the viewer
+		int32_t count = std::min<int32_t>(encoding->topEntries, tile->getPosition() == player->getPosition() ? 9 : 10);
+		if (count > 0)
+		{
+			msg.addBytes(reinterpret_cast<const char*>(entries), encoding->getEnd(count - 1));
+		}
+		if (count == 10)
+		{
+			return;
+		}
+
+		AddTileCreatures(tile, msg, count);
+
+		const int32_t downCount = std::min<int32_t>(encoding->downEntries, 10 - count);
+		if (downCount > 0)
+		{
+			const size_t first = encoding->topEntries;
+			const size_t begin = first == 0 ? 0 : encoding->getEnd(first - 1);
+			msg.addBytes(reinterpret_cast<const char*>(entries + begin), encoding->getEnd(first + downCount - 1) - begin);
+		}
+		return;
+	}
+
 	int32_t count;
 	Item *ground = tile->getGround();
 	if (ground)
@@ -896,38 +1080,10 @@ void ProtocolGame::GetTileDescription(const Tile *tile, NetworkMessage &msg)
 		}
 	}
 
-	const CreatureVector *creatures = tile->getCreatures();
-	if (creatures)
+	AddTileCreatures(tile, msg, count);
+	if (count == 10)
 	{
-		bool playerAdded = false;
-		for (auto it = creatures->rbegin(); it != creatures->rend(); ++it)
-		{
-			const Creature *creature = *it;
-			if (!player->canSeeCreature(creature))
-			{
-				continue;
-			}
-
-			if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded)
-			{
-				creature = player;
-			}
-
-			if (creature->getID() == player->getID())
-			{
-				playerAdded = true;
-			}
-
-			bool known;
-			uint32_t removedKnown;
-			checkCreatureAsKnown(creature->getID(), known, removedKnown);
-			AddCreature(msg, creature, known, removedKnown);
-
-			if (++count == 10)
-			{
-				return;
-			}
-		}
+		return;
 	}
 
 	if (items)
@@ -944,6 +1100,45 @@ void ProtocolGame::GetTileDescription(const Tile *tile, NetworkMessage &msg)
 	}
 }
 
+void ProtocolGame::AddTileCreatures(const Tile *tile, NetworkMessage &msg, int32_t &count)
+{
+	const CreatureVector *creatures = tile->getCreatures();
+	if (!creatures)
+	{
+		return;
+	}
+
+	bool playerAdded = false;
+	for (auto it = creatures->rbegin(); it != creatures->rend(); ++it)
+	{
+		const Creature *creature = *it;
+		if (!player->canSeeCreature(creature))
+		{
+			continue;
+		}
+
+		if (tile->getPosition() == player->getPosition() && count == 9 && !playerAdded)
+		{
+			creature = player;
+		}
+
+		if (creature->getID() == player->getID())
+		{
+			playerAdded = true;
+		}
+
+		bool known;
+		uint32_t removedKnown;
+		checkCreatureAsKnown(creature->getID(), known, removedKnown);
+		AddCreature(msg, creature, known, removedKnown);
+
+		if (++count == 10)
+		{
+			return;
+		}
+	}
+}
+
 void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, NetworkMessage &msg)
 {
 	int32_t skip = -1;
@@ -4877,7 +5072,7 @@ void ProtocolGame::sendMarketDetail(uint16_t itemId, uint8_t tier)
 		msg.add<uint16_t>(0x00);
 	}
 
-	auto purchase = IOMarket::getInstance().getPurchaseStatistics()[itemId][tier];
+	auto purchase = IOMarket::getInstance().getPurchaseStatistics(itemId, tier);
 	if (const MarketStatistics* purchaseStatistics = &purchase; purchaseStatistics)
 	{
 		msg.addByte(0x01);
@@ -4891,7 +5086,7 @@ void ProtocolGame::sendMarketDetail(uint16_t itemId, uint8_t tier)
 		msg.addByte(0x00);
 	}
 
-	auto sale = IOMarket::getInstance().getSaleStatistics()[itemId][tier];
+	auto sale = IOMarket::getInstance().getSaleStatistics(itemId, tier);
 	if (const MarketStatistics* saleStatistics = &sale; saleStatistics)
 	{
 		msg.addByte(0x01);
@@ -20,6 +20,7 @@ class Game;
 class House;
 class Container;
 class Tile;
+struct TileItemsEncoding;
 class Connection;
 class Quest;
 class ProtocolGame;
@@ -82,6 +83,11 @@ private:
 	{
 		return std::static_pointer_cast<ProtocolGame>(shared_from_this());
 	}
+	// A login of a player that is not online: its rows are read on a loader thread, then it is built and placed here
+	struct LoginData;
+	void fetchPlayer(const std::shared_ptr<LoginData> &loginData);
+	void onPlayerFetched(const std::shared_ptr<LoginData> &loginData);
+
 	void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
 	void disconnectClient(const std::string &message) const;
 	void writeToOutputBuffer(const NetworkMessage &msg);
@@ -95,8 +101,8 @@ private:
 	bool canSee(const Position &pos) const;
 
 	// we have all the parse methods
-	void parsePacket(NetworkMessage &msg) override;
-	void parsePacketFromDispatcher(NetworkMessage msg, uint8_t recvbyte);
+	void parsePacket(const InputMessage_ptr &inputMessage) override;
+	void parsePacketFromDispatcher(const InputMessage_ptr &inputMessage, NetworkMessage::MsgSize_t position, uint8_t recvbyte);
 	void onRecvFirstMessage(NetworkMessage &msg) override;
 	void onConnect() override;
 
@@ -421,6 +427,8 @@ private:
 
 	// translate a tile to clientreadable format
 	void GetTileDescription(const Tile *tile, NetworkMessage &msg);
+	const TileItemsEncoding* getTileItemsEncoding(const Tile *tile);
+	void AddTileCreatures(const Tile *tile, NetworkMessage &msg, int32_t &count);
 
 	// translate a floor to clientreadable format
 	void GetFloorDescription(NetworkMessage &msg, int32_t x, int32_t y, int32_t z,
@@ -461,6 +469,7 @@ private:
 	void getForgeInfoMap(const Item *item, std::map<uint16_t, std::map<uint8_t, uint16_t>>& itemsMap) const;
 
 	friend class Player;
+	friend class TileItemsEncodingTest;
 
 	phmap::flat_hash_set<uint32_t> knownCreatureSet;
 	Player *player = nullptr;
@@ -17,23 +17,32 @@
 #include "server/network/message/outputmessage.h"
 
 std::map<uint32_t, int64_t> ProtocolStatus::ipConnectMap;
+std::mutex ProtocolStatus::ipConnectMapLock;
 const uint64_t ProtocolStatus::start = OTSYS_TIME();
 
 void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 {
 	uint32_t ip = getIP();
-	if (ip != 0x0100007F) {
-		std::string ipStr = convertIPToString(ip);
-		if (ipStr != g_configManager().getString(IP)) {
-			std::map<uint32_t, int64_t>::const_iterator it = ipConnectMap.find(ip);
-			if (it != ipConnectMap.end() && (OTSYS_TIME() < (it->second + g_configManager().getNumber(STATUSQUERY_TIMEOUT)))) {
-				disconnect();
-				return;
+	bool throttled = false;
+	{
+		std::lock_guard<std::mutex> lockClass(ipConnectMapLock);
+		if (ip != 0x0100007F) {
+			std::string ipStr = convertIPToString(ip);
+			if (ipStr != g_configManager().getString(IP)) {
+				std::map<uint32_t, int64_t>::const_iterator it = ipConnectMap.find(ip);
+				throttled = it != ipConnectMap.end() && (OTSYS_TIME() < (it->second + g_configManager().getNumber(STATUSQUERY_TIMEOUT)));
 			}
 		}
+
+		if (!throttled) {
+			ipConnectMap[ip] = OTSYS_TIME();
+		}
 	}
 
-	ipConnectMap[ip] = OTSYS_TIME();
+	if (throttled) {
+		disconnect();
+		return;
+	}
 
 	switch (msg.getByte()) {
 		//XML info protocol
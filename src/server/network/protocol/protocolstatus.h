@@ -35,6 +35,8 @@ class ProtocolStatus final : public Protocol
 
 	private:
 		static std::map<uint32_t, int64_t> ipConnectMap;
+		// Status requests are parsed on the I/O threads
+		static std::mutex ipConnectMapLock;
 };
 
 #endif  // SRC_SERVER_NETWORK_PROTOCOL_PROTOCOLSTATUS_H_
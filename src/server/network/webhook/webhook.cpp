@@ -31,10 +31,10 @@ void webhook_init() {
 		return;
 	}
 
+	g_webhook().start(headers);
 	init = true;
 }
 
-static int webhook_send_message_(const char *url, const char *payload, std::string *response_body);
 static std::string get_payload(std::string title, std::string message, int color);
 
 void webhook_send_message(std::string title, std::string message, int color, std::string url) {
@@ -53,16 +53,7 @@ void webhook_send_message(std::string title, std::string message, int color, std
 		return;
 	}
 
-	std::string payload = get_payload(title, message, color);
-	std::string response_body = "";
-	int response_code = webhook_send_message_(url.c_str(), payload.c_str(), &response_body);
-
-	if (response_code != 204 && response_code != -1) {
-		SPDLOG_ERROR("Failed to send webhook message; "
-                     "HTTP request failed with code: {}"
-                     "response body: {} request body: {}",
-                     response_code, response_body, payload);
-	}
+	g_webhook().addMessage(std::move(url), get_payload(title, message, color));
 }
 
 static std::string get_payload(std::string title, std::string message, int color) {
@@ -112,32 +103,239 @@ static std::string get_payload(std::string title, std::string message, int color
 	return out.str();
 }
 
-static int webhook_send_message_(const char *url, const char *payload, std::string *response_body) {
-	CURL *curl = curl_easy_init();
-	if (!curl) {
-		SPDLOG_ERROR("Failed to send webhook message; curl_easy_init failed");
-		return -1;
+static size_t webhook_write_response(char *data, size_t size, size_t count, void *userdata) {
+	// Only kept for the error log, the rest is discarded
+	auto response_body = static_cast<std::string *>(userdata);
+	const size_t length = size * count;
+	response_body->append(data, std::min<size_t>(length, 1024 - std::min<size_t>(1024, response_body->size())));
+	return length;
+}
+
+void Webhook::start(curl_slist* initHeaders) {
+	requestHeaders = initHeaders;
+	ThreadHolder::start();
+}
+
+void Webhook::shutdown() {
+	std::lock_guard<std::mutex> lockClass(messageLock);
+	if (getState() != THREAD_STATE_RUNNING) {
+		return;
 	}
 
-	curl_easy_setopt(curl, CURLOPT_URL, url);
-	curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_3);
-	curl_easy_setopt(curl, CURLOPT_POST, 1L);
-	curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, reinterpret_cast<void *>(&response_body));
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-	curl_easy_setopt(curl, CURLOPT_USERAGENT, "canary (https://github.com/Hydractify/canary)");
+	setState(THREAD_STATE_CLOSING);
+	shutdownDeadline = std::chrono::steady_clock::now() + SHUTDOWN_TIMEOUT;
+	if (multiHandle) {
+		curl_multi_wakeup(multiHandle);
+	}
+	messageSignal.notify_one();
+}
 
-	CURLcode res = curl_easy_perform(curl);
+bool Webhook::addMessage(std::string url, std::string payload) {
+	std::lock_guard<std::mutex> lockClass(messageLock);
+	if (getState() != THREAD_STATE_RUNNING) {
+		return false;
+	}
+
+	if (messages.size() >= MAX_QUEUED) {
+		SPDLOG_WARN("Dropped webhook message; {} messages are already waiting", messages.size());
+		return false;
+	}
 
-	int response_code = -1;
-	if (res == CURLE_OK) {
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+	messages.push_back({ std::move(url), std::move(payload), 0, std::chrono::steady_clock::now() });
+	if (multiHandle) {
+		curl_multi_wakeup(multiHandle);
+	}
+	messageSignal.notify_one();
+	return true;
+}
+
+void Webhook::threadMain() {
+	CURLM* multi = curl_multi_init();
+	if (!multi) {
+		SPDLOG_ERROR("Failed to init curl multi, no webhook messages may be sent");
+		setState(THREAD_STATE_TERMINATED);
+		return;
+	}
+	curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(MAX_TRANSFERS));
+
+	std::unique_lock<std::mutex> messageLockUnique(messageLock);
+	multiHandle = multi;
+	while (true) {
+		const auto now = std::chrono::steady_clock::now();
+		const bool closing = getState() != THREAD_STATE_RUNNING;
+		if (closing && ((messages.empty() && transfers.empty()) || now >= shutdownDeadline)) {
+			break;
+		}
+
+		// Start the due messages in order, each URL at most once per RATE_INTERVAL
+		auto wakeUp = closing ? shutdownDeadline : std::chrono::steady_clock::time_point::max();
+		for (auto it = messages.begin(); it != messages.end() && transfers.size() < MAX_TRANSFERS; ) {
+			auto &urlNextRequest = nextRequest[it->url];
+			const auto due = std::max(it->notBefore, urlNextRequest);
+			if (due > now) {
+				wakeUp = std::min(wakeUp, due);
+				++it;
+				continue;
+			}
+
+			urlNextRequest = now + RATE_INTERVAL;
+			startTransfer(multi, std::move(*it));
+			it = messages.erase(it);
+		}
+
+		if (transfers.empty()) {
+			if (wakeUp == std::chrono::steady_clock::time_point::max()) {
+				messageSignal.wait(messageLockUnique);
+			} else {
+				messageSignal.wait_until(messageLockUnique, wakeUp);
+			}
+			continue;
+		}
+
+		messageLockUnique.unlock();
+
+		int running = 0;
+		curl_multi_perform(multi, &running);
+
+		std::vector<std::pair<CURL*, CURLcode>> finished;
+		int queued = 0;
+		while (CURLMsg* info = curl_multi_info_read(multi, &queued)) {
+			if (info->msg == CURLMSG_DONE) {
+				finished.emplace_back(info->easy_handle, info->data.result);
+			}
+		}
+
+		if (finished.empty()) {
+			// Woken by curl_multi_wakeup for new messages and shutdown
+			const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(wakeUp - now);
+			curl_multi_poll(multi, nullptr, 0, static_cast<int>(std::clamp<int64_t>(timeout.count(), 0, 1000)), nullptr);
+		}
+
+		messageLockUnique.lock();
+		for (const auto &[handle, result] : finished) {
+			finishTransfer(multi, handle, result);
+		}
+	}
+
+	if (!messages.empty() || !transfers.empty()) {
+		SPDLOG_WARN("Dropped {} webhook messages on shutdown", messages.size() + transfers.size());
+	}
+	messages.clear();
+
+	for (const auto &[handle, transfer] : transfers) {
+		curl_multi_remove_handle(multi, handle);
+		curl_easy_cleanup(handle);
+	}
+	transfers.clear();
+
+	for (CURL* handle : idleHandles) {
+		curl_easy_cleanup(handle);
+	}
+	idleHandles.clear();
+
+	multiHandle = nullptr;
+	messageLockUnique.unlock();
+
+	curl_multi_cleanup(multi);
+	setState(THREAD_STATE_TERMINATED);
+}
+
+void Webhook::startTransfer(CURLM* multi, WebhookMessage&& message) {
+	CURL* handle;
+	if (!idleHandles.empty()) {
+		// Keeps the handle's connection, DNS and TLS session caches
+		handle = idleHandles.back();
+		idleHandles.pop_back();
+		curl_easy_reset(handle);
 	} else {
+		handle = curl_easy_init();
+	}
+
+	if (!handle) {
+		SPDLOG_ERROR("Failed to send webhook message; curl_easy_init failed");
+		return;
+	}
+
+	auto transfer = std::make_unique<Transfer>();
+	transfer->handle = handle;
+	transfer->message = std::move(message);
+	transfer->message.attempts++;
+
+	curl_easy_setopt(handle, CURLOPT_URL, transfer->message.url.c_str());
+	curl_easy_setopt(handle, CURLOPT_SSLVERSION, CURL_SSLVERSION_TLSv1_3);
+	curl_easy_setopt(handle, CURLOPT_POST, 1L);
+	curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer->message.payload.c_str());
+	curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->message.payload.size()));
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, webhook_write_response);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, reinterpret_cast<void *>(&transfer->responseBody));
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, requestHeaders);
+	curl_easy_setopt(handle, CURLOPT_USERAGENT, "canary (https://github.com/Hydractify/canary)");
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, 10000L);
+
+	curl_multi_add_handle(multi, handle);
+	transfers.emplace(handle, std::move(transfer));
+}
+
+void Webhook::finishTransfer(CURLM* multi, CURL* handle, CURLcode result) {
+	auto it = transfers.find(handle);
+	if (it == transfers.end()) {
+		return;
+	}
+
+	std::unique_ptr<Transfer> transfer = std::move(it->second);
+	transfers.erase(it);
+	curl_multi_remove_handle(multi, handle);
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto backoff = RETRY_DELAY * (1 << (transfer->message.attempts - 1));
+	if (result != CURLE_OK) {
 		SPDLOG_ERROR("Failed to send webhook message with the error: {}",
-						curl_easy_strerror(res));
+						curl_easy_strerror(result));
+		idleHandles.push_back(handle);
+		retry(std::move(transfer->message), now + backoff);
+		return;
 	}
 
-	curl_easy_cleanup(curl);
+	long responseCode = 0;
+	curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode);
+	curl_off_t retryAfter = 0;
+	if (responseCode == 429) {
+		curl_easy_getinfo(handle, CURLINFO_RETRY_AFTER, &retryAfter);
+	}
+	idleHandles.push_back(handle);
+
+	if (responseCode >= 200 && responseCode < 300) {
+		return;
+	}
+
+	if (responseCode == 429) {
+		// Rate limited, hold every message of the URL
+		const auto notBefore = now + std::max<std::chrono::milliseconds>(RETRY_DELAY, std::chrono::seconds(retryAfter));
+		nextRequest[transfer->message.url] = notBefore;
+		retry(std::move(transfer->message), notBefore);
+		return;
+	}
+
+	if (responseCode >= 500) {
+		SPDLOG_WARN("Failed to send webhook message; HTTP request failed with code: {}, retrying", responseCode);
+		retry(std::move(transfer->message), now + backoff);
+		return;
+	}
+
+	SPDLOG_ERROR("Failed to send webhook message; "
+                 "HTTP request failed with code: {} "
+                 "response body: {} request body: {}",
+                 responseCode, transfer->responseBody, transfer->message.payload);
+}
+
+void Webhook::retry(WebhookMessage&& message, std::chrono::steady_clock::time_point notBefore) {
+	if (message.attempts >= MAX_ATTEMPTS) {
+		SPDLOG_ERROR("Dropped webhook message after {} attempts, request body: {}", message.attempts, message.payload);
+		return;
+	}
 
-	return response_code;
+	message.notBefore = notBefore;
+	messages.push_front(std::move(message));
 }
@@ -10,6 +10,78 @@
 #ifndef SRC_SERVER_NETWORK_WEBHOOK_WEBHOOK_H_
 #define SRC_SERVER_NETWORK_WEBHOOK_WEBHOOK_H_
 
+#include "utils/thread_holder_base.h"
+
+struct WebhookMessage {
+	std::string url;
+	std::string payload;
+	uint8_t attempts = 0;
+	std::chrono::steady_clock::time_point notBefore;
+};
+
+/**
+ * Sends webhook messages from its own thread through curl_multi, so game
+ * code only queues them. Connections are reused between messages, each
+ * URL gets at most one request per RATE_INTERVAL (or longer when the
+ * endpoint answers 429), and failed requests are retried with backoff
+ * until MAX_ATTEMPTS. Messages are dropped when MAX_QUEUED are waiting.
+ */
+class Webhook : public ThreadHolder<Webhook>
+{
+	public:
+		static constexpr size_t MAX_QUEUED = 256;
+		static constexpr size_t MAX_TRANSFERS = 4;
+		static constexpr uint8_t MAX_ATTEMPTS = 3;
+		static constexpr std::chrono::milliseconds RATE_INTERVAL{400};
+		static constexpr std::chrono::milliseconds RETRY_DELAY{1000};
+		// How long shutdown waits for the queued messages
+		static constexpr std::chrono::milliseconds SHUTDOWN_TIMEOUT{5000};
+
+		Webhook() = default;
+
+		// non-copyable
+		Webhook(Webhook const&) = delete;
+		void operator=(Webhook const&) = delete;
+
+		static Webhook& getInstance() {
+			// Guaranteed to be destroyed
+			static Webhook instance;
+			// Instantiated on first use
+			return instance;
+		}
+
+		void start(curl_slist* initHeaders);
+		void shutdown();
+
+		bool addMessage(std::string url, std::string payload);
+
+		void threadMain();
+	private:
+		struct Transfer {
+			CURL* handle;
+			WebhookMessage message;
+			std::string responseBody;
+		};
+
+		void startTransfer(CURLM* multi, WebhookMessage&& message);
+		void finishTransfer(CURLM* multi, CURL* handle, CURLcode result);
+		void retry(WebhookMessage&& message, std::chrono::steady_clock::time_point notBefore);
+
+		curl_slist* requestHeaders = nullptr;
+		CURLM* multiHandle = nullptr;
+		std::deque<WebhookMessage> messages;
+		phmap::flat_hash_map<CURL*, std::unique_ptr<Transfer>> transfers;
+		std::vector<CURL*> idleHandles;
+		// By URL, the earliest time of the next request
+		phmap::flat_hash_map<std::string, std::chrono::steady_clock::time_point> nextRequest;
+		std::chrono::steady_clock::time_point shutdownDeadline;
+
+		std::mutex messageLock;
+		std::condition_variable messageSignal;
+};
+
+constexpr auto g_webhook = &Webhook::getInstance;
+
 void webhook_init();
 
 void webhook_send_message(std::string title, std::string message, int color, std::string url);
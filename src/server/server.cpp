@@ -35,7 +35,23 @@ void ServiceManager::run()
 {
 	assert(!running);
 	running = true;
+
+	// The calling thread is one of the I/O threads
+	auto threads = static_cast<size_t>(std::max<int32_t>(1, g_configManager().getNumber(IO_THREADS)));
+	std::vector<std::thread> ioThreads;
+	ioThreads.reserve(threads - 1);
+	for (size_t i = 1; i < threads; ++i) {
+		ioThreads.emplace_back([this]() {
+			io_service.run();
+		});
+	}
+
+	SPDLOG_INFO("Network running with {} I/O thread(s)", threads);
 	io_service.run();
+
+	for (auto &thread : ioThreads) {
+		thread.join();
+	}
 }
 
 void ServiceManager::stop()
@@ -48,7 +64,7 @@ void ServiceManager::stop()
 
 	for (auto& servicePortIt : acceptors) {
 		try {
-			io_service.post(std::bind_front(&ServicePort::onStopServer, servicePortIt.second));
+			asio::post(servicePortIt.second->strand, std::bind_front(&ServicePort::onStopServer, servicePortIt.second));
 		} catch (const std::system_error& e) {
 			SPDLOG_WARN("[ServiceManager::stop] - Network error: {}", e.what());
 		}
@@ -150,7 +166,7 @@ void ServicePort::onStopServer()
 void ServicePort::openAcceptor(std::weak_ptr<ServicePort> weak_service, uint16_t port)
 {
 	if (auto service = weak_service.lock()) {
-		service->open(port);
+		asio::post(service->strand, std::bind_front(&ServicePort::open, service, port));
 	}
 }
 
@@ -163,13 +179,13 @@ void ServicePort::open(uint16_t port)
 
 	try {
 		if (g_configManager().getBoolean(BIND_ONLY_GLOBAL_ADDRESS)) {
-														acceptor.reset(new asio::ip::tcp::acceptor(io_service,
+														acceptor.reset(new asio::ip::tcp::acceptor(strand,
 														asio::ip::tcp::endpoint(
 					asio::ip::address(
 						asio::ip::address_v4::from_string(
                            g_configManager().getString(IP))), serverPort)));
 		} else {
-			acceptor.reset(new asio::ip::tcp::acceptor(io_service,
+			acceptor.reset(new asio::ip::tcp::acceptor(strand,
 				asio::ip::tcp::endpoint(
 					asio::ip::address(
 						asio::ip::address_v4(INADDR_ANY)), serverPort)));
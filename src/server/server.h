@@ -51,7 +51,7 @@ class Service final : public ServiceBase
 class ServicePort : public std::enable_shared_from_this<ServicePort>
 {
 	public:
-		explicit ServicePort(asio::io_service& init_io_service) : io_service(init_io_service) {}
+		explicit ServicePort(asio::io_service& init_io_service) : io_service(init_io_service), strand(asio::make_strand(init_io_service)) {}
 		~ServicePort();
 
 		// non-copyable
@@ -71,9 +71,13 @@ class ServicePort : public std::enable_shared_from_this<ServicePort>
 		void onAccept(Connection_ptr connection, const std::error_code& error);
 
 	private:
+		friend class ServiceManager;
+
 		void accept();
 
 		asio::io_service& io_service;
+		// Serializes the acceptor handlers, the io_service runs on several threads
+		asio::strand<asio::io_service::executor_type> strand;
 		std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 		std::vector<Service_ptr> services;
 
@@ -0,0 +1,96 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_UTILS_ARENA_HPP_
+#define SRC_UTILS_ARENA_HPP_
+
+/**
+ * Bump allocator for objects living as long as their owner.
+ *
+ * Objects are placed one after another in CHUNK_SIZE chunks, so objects
+ * created together share cache lines and cost no allocator header. Memory
+ * is only given back when the arena is destroyed: classes created in an
+ * arena define an operator delete that skips the memory it owns, so
+ * deleting such an object runs its destructor and leaves the bytes unused.
+ */
+class Arena {
+	public:
+		static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+		Arena() = default;
+
+		// non-copyable
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		template <typename T, typename... Args>
+		T* create(Args&&... args) {
+			return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		void* allocate(size_t size, size_t alignment) {
+			auto address = reinterpret_cast<uintptr_t>(cursor);
+			uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+			if (!cursor || aligned + size > reinterpret_cast<uintptr_t>(end)) {
+				addChunk(std::max(size + alignment, CHUNK_SIZE));
+				address = reinterpret_cast<uintptr_t>(cursor);
+				aligned = (address + alignment - 1) & ~(alignment - 1);
+			}
+
+			cursor = reinterpret_cast<std::byte*>(aligned + size);
+			used += size;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		bool owns(const void* ptr) const {
+			if (ranges.empty()) {
+				return false;
+			}
+
+			const auto address = reinterpret_cast<uintptr_t>(ptr);
+			auto it = std::upper_bound(ranges.begin(), ranges.end(), address, [](uintptr_t value, const std::pair<uintptr_t, uintptr_t> &range) {
+				return value < range.first;
+			});
+			if (it == ranges.begin()) {
+				return false;
+			}
+			--it;
+			return address < it->second;
+		}
+
+		// Bytes handed out and bytes reserved in chunks
+		size_t getUsed() const {
+			return used;
+		}
+		size_t getReserved() const {
+			return reserved;
+		}
+
+	private:
+		void addChunk(size_t size) {
+			auto &chunk = chunks.emplace_back(std::make_unique_for_overwrite<std::byte[]>(size));
+			cursor = chunk.get();
+			end = cursor + size;
+			reserved += size;
+
+			const auto begin = reinterpret_cast<uintptr_t>(cursor);
+			auto it = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(begin, uintptr_t{0}));
+			ranges.emplace(it, begin, begin + size);
+		}
+
+		std::vector<std::unique_ptr<std::byte[]>> chunks;
+		// Address ranges of chunks, sorted for owns
+		std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+		std::byte* cursor = nullptr;
+		std::byte* end = nullptr;
+		size_t used = 0;
+		size_t reserved = 0;
+};
+
+#endif  // SRC_UTILS_ARENA_HPP_
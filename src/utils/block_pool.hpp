@@ -0,0 +1,188 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_UTILS_BLOCK_POOL_HPP_
+#define SRC_UTILS_BLOCK_POOL_HPP_
+
+struct BlockPoolStats {
+	uint64_t requests = 0;
+	// Requests served by a recycled block
+	uint64_t hits = 0;
+	// Blocks currently owned by the pool or its users
+	uint64_t residentBlocks = 0;
+};
+
+/**
+ * Fixed size block allocator with per-thread caches.
+ *
+ * Every thread keeps a small free list that is used without any
+ * synchronization. Blocks move between threads in batches of CacheSize
+ * through a shared depot, so the mutex is taken once per CacheSize
+ * allocations in the worst case (e.g. blocks allocated on the network
+ * thread and released on the dispatcher).
+ */
+template <size_t BlockSize, size_t CacheSize = 64>
+class BlockPool {
+	public:
+		static_assert(BlockSize >= sizeof(void*), "BlockSize must fit a pointer");
+
+		static void* allocate() {
+			LocalCache &cache = getLocalCache();
+			cache.requests.increment();
+			if (cache.head == nullptr) {
+				cache.refill();
+				if (cache.head == nullptr) {
+					cache.misses.increment();
+					return ::operator new(BlockSize);
+				}
+			}
+
+			FreeBlock* block = cache.head;
+			cache.head = block->next;
+			--cache.count;
+			return block;
+		}
+
+		static void deallocate(void* ptr) {
+			LocalCache &cache = getLocalCache();
+			auto block = static_cast<FreeBlock*>(ptr);
+			block->next = cache.head;
+			cache.head = block;
+			if (++cache.count >= CacheSize * 2) {
+				cache.release(CacheSize);
+			}
+		}
+
+		static BlockPoolStats getStats() {
+			Depot &depot = getDepot();
+			std::lock_guard<std::mutex> lockClass(depot.lock);
+			uint64_t requests = depot.retiredRequests;
+			uint64_t misses = depot.retiredMisses;
+			uint64_t freed = depot.retiredFreed;
+			for (const LocalCache* cache : depot.caches) {
+				requests += cache->requests.get();
+				misses += cache->misses.get();
+				freed += cache->freed.get();
+			}
+
+			BlockPoolStats stats;
+			stats.requests = requests;
+			stats.hits = requests - std::min(requests, misses);
+			// Every miss creates a block, they are only deleted when a thread exits
+			stats.residentBlocks = misses - std::min(misses, freed);
+			return stats;
+		}
+
+	private:
+		/**
+		 * Counter written only by the thread owning the cache. The relaxed
+		 * load and store compile to a plain increment, the atomic type only
+		 * keeps the concurrent read from getStats well defined.
+		 */
+		class LocalCounter {
+			public:
+				void increment(uint64_t amount = 1) {
+					value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+				}
+				uint64_t get() const {
+					return value.load(std::memory_order_relaxed);
+				}
+
+			private:
+				std::atomic<uint64_t> value {0};
+		};
+
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		struct LocalCache;
+
+		struct Depot {
+			std::mutex lock;
+			// Each entry is a chain of exactly CacheSize blocks
+			std::vector<FreeBlock*> batches;
+			// Caches of live threads, summed when the stats are read
+			std::vector<const LocalCache*> caches;
+			// Counters of caches whose thread already exited
+			uint64_t retiredRequests = 0;
+			uint64_t retiredMisses = 0;
+			uint64_t retiredFreed = 0;
+		};
+
+		static Depot &getDepot() {
+			static Depot depot;
+			return depot;
+		}
+
+		struct LocalCache {
+			LocalCache() {
+				Depot &depot = getDepot();
+				std::lock_guard<std::mutex> lockClass(depot.lock);
+				depot.caches.push_back(this);
+			}
+
+			~LocalCache() {
+				while (count >= CacheSize) {
+					release(CacheSize);
+				}
+				while (head != nullptr) {
+					FreeBlock* next = head->next;
+					::operator delete(head);
+					freed.increment();
+					head = next;
+				}
+
+				Depot &depot = getDepot();
+				std::lock_guard<std::mutex> lockClass(depot.lock);
+				depot.retiredRequests += requests.get();
+				depot.retiredMisses += misses.get();
+				depot.retiredFreed += freed.get();
+				std::erase(depot.caches, this);
+			}
+
+			void refill() {
+				Depot &depot = getDepot();
+				std::lock_guard<std::mutex> lockClass(depot.lock);
+				if (!depot.batches.empty()) {
+					head = depot.batches.back();
+					depot.batches.pop_back();
+					count = CacheSize;
+				}
+			}
+
+			void release(size_t amount) {
+				FreeBlock* first = head;
+				FreeBlock* last = head;
+				for (size_t i = 1; i < amount; ++i) {
+					last = last->next;
+				}
+				head = last->next;
+				last->next = nullptr;
+				count -= amount;
+
+				Depot &depot = getDepot();
+				std::lock_guard<std::mutex> lockClass(depot.lock);
+				depot.batches.push_back(first);
+			}
+
+			FreeBlock* head = nullptr;
+			size_t count = 0;
+			LocalCounter requests;
+			LocalCounter misses;
+			LocalCounter freed;
+		};
+
+		static LocalCache &getLocalCache() {
+			thread_local LocalCache cache;
+			return cache;
+		}
+};
+
+#endif  // SRC_UTILS_BLOCK_POOL_HPP_
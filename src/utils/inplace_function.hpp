@@ -0,0 +1,111 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_UTILS_INPLACE_FUNCTION_HPP_
+#define SRC_UTILS_INPLACE_FUNCTION_HPP_
+
+/**
+ * Move-only replacement for std::function<void(void)> that stores callables
+ * up to Capacity bytes inside the object itself. Bigger callables fall back
+ * to the heap, so any callable is accepted.
+ */
+template <size_t Capacity>
+class InplaceFunction {
+	public:
+		InplaceFunction() = default;
+
+		template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+		InplaceFunction(F&& f) {
+			using Fn = std::decay_t<F>;
+			if constexpr (fitsInline<Fn>()) {
+				new (&storage) Fn(std::forward<F>(f));
+				ops = &inlineOps<Fn>;
+			} else {
+				*reinterpret_cast<Fn**>(&storage) = new Fn(std::forward<F>(f));
+				ops = &heapOps<Fn>;
+			}
+		}
+
+		InplaceFunction(InplaceFunction&& other) noexcept {
+			moveFrom(other);
+		}
+
+		InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+			if (this != &other) {
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		// non-copyable
+		InplaceFunction(const InplaceFunction&) = delete;
+		InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+		~InplaceFunction() {
+			reset();
+		}
+
+		void operator()() {
+			ops->invoke(&storage);
+		}
+
+		explicit operator bool() const {
+			return ops != nullptr;
+		}
+
+	private:
+		struct Operations {
+			void (*invoke)(void*);
+			void (*move)(void*, void*);
+			void (*destroy)(void*);
+		};
+
+		template <typename Fn>
+		static constexpr bool fitsInline() {
+			return sizeof(Fn) <= Capacity && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<Fn>;
+		}
+
+		template <typename Fn>
+		static constexpr Operations inlineOps = {
+			[](void* data) { (*static_cast<Fn*>(data))(); },
+			[](void* dst, void* src) {
+				new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+				static_cast<Fn*>(src)->~Fn();
+			},
+			[](void* data) { static_cast<Fn*>(data)->~Fn(); }
+		};
+
+		template <typename Fn>
+		static constexpr Operations heapOps = {
+			[](void* data) { (**static_cast<Fn**>(data))(); },
+			[](void* dst, void* src) { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+			[](void* data) { delete *static_cast<Fn**>(data); }
+		};
+
+		void moveFrom(InplaceFunction &other) {
+			if (other.ops) {
+				other.ops->move(&storage, &other.storage);
+				ops = other.ops;
+				other.ops = nullptr;
+			}
+		}
+
+		void reset() {
+			if (ops) {
+				ops->destroy(&storage);
+				ops = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) std::byte storage[Capacity];
+		const Operations* ops = nullptr;
+};
+
+#endif  // SRC_UTILS_INPLACE_FUNCTION_HPP_
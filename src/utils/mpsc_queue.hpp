@@ -0,0 +1,95 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_UTILS_MPSC_QUEUE_HPP_
+#define SRC_UTILS_MPSC_QUEUE_HPP_
+
+/**
+ * Node embedded in every object that can be pushed into a MpscQueue.
+ */
+struct MpscNode {
+	std::atomic<MpscNode*> mpscNext {nullptr};
+};
+
+/**
+ * Intrusive, unbounded multi-producer/single-consumer queue.
+ *
+ * Any thread may push, only one thread may pop. Producers never block each
+ * other: a push is a single atomic exchange, so there is no lock for the
+ * network, scheduler and database threads to contend on.
+ *
+ * T must derive from MpscNode. The queue does not own the nodes.
+ */
+template <typename T>
+class MpscQueue {
+	public:
+		MpscQueue() : head(&stub), tail(&stub) {}
+
+		// non-copyable
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		void push(T* item) {
+			pushNode(static_cast<MpscNode*>(item));
+		}
+
+		/**
+		 * Returns the oldest node, or nullptr if the queue is empty or the
+		 * next node is still being linked by a producer. Consumer only.
+		 */
+		T* pop() {
+			MpscNode* first = tail;
+			MpscNode* next = first->mpscNext.load(std::memory_order_acquire);
+			if (first == &stub) {
+				if (next == nullptr) {
+					return nullptr;
+				}
+				tail = next;
+				first = next;
+				next = next->mpscNext.load(std::memory_order_acquire);
+			}
+
+			if (next != nullptr) {
+				tail = next;
+				return static_cast<T*>(first);
+			}
+
+			if (first != head.load(std::memory_order_acquire)) {
+				// A producer swapped the head but did not link it yet
+				return nullptr;
+			}
+
+			pushNode(&stub);
+			next = first->mpscNext.load(std::memory_order_acquire);
+			if (next != nullptr) {
+				tail = next;
+				return static_cast<T*>(first);
+			}
+			return nullptr;
+		}
+
+		bool empty() const {
+			return tail == &stub && stub.mpscNext.load(std::memory_order_acquire) == nullptr;
+		}
+
+	private:
+		void pushNode(MpscNode* node) {
+			node->mpscNext.store(nullptr, std::memory_order_relaxed);
+			MpscNode* prev = head.exchange(node, std::memory_order_acq_rel);
+			prev->mpscNext.store(node, std::memory_order_release);
+		}
+
+		MpscNode stub;
+		// Producers side
+		alignas(64) std::atomic<MpscNode*> head;
+		// Consumer side
+		alignas(64) MpscNode* tail;
+};
+
+#endif  // SRC_UTILS_MPSC_QUEUE_HPP_
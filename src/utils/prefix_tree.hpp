@@ -0,0 +1,90 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#ifndef SRC_UTILS_PREFIX_TREE_HPP_
+#define SRC_UTILS_PREFIX_TREE_HPP_
+
+/**
+ * Case-insensitive prefix tree mapping words to values.
+ *
+ * forEachPrefix visits every value whose words are a prefix of a text
+ * (compared as strncasecmp does), shortest words first, walking the text
+ * once. Words differing only in case share a node and keep all values.
+ */
+template <typename T>
+class PrefixTree {
+	public:
+		PrefixTree() {
+			clear();
+		}
+
+		void clear() {
+			nodes.clear();
+			nodes.emplace_back();
+		}
+
+		void insert(const std::string &words, T value) {
+			uint32_t index = 0;
+			for (char ch : words) {
+				const char key = toKey(ch);
+				uint32_t child = findChild(index, key);
+				if (child == 0) {
+					child = static_cast<uint32_t>(nodes.size());
+					nodes.emplace_back();
+					nodes[index].children.emplace_back(key, child);
+				}
+				index = child;
+			}
+			nodes[index].values.push_back(value);
+		}
+
+		template <typename F>
+		void forEachPrefix(std::string_view text, F &&function) const {
+			uint32_t index = 0;
+			for (size_t i = 0; ; ++i) {
+				for (const T &value : nodes[index].values) {
+					function(value);
+				}
+
+				if (i == text.size()) {
+					break;
+				}
+
+				index = findChild(index, toKey(text[i]));
+				if (index == 0) {
+					break;
+				}
+			}
+		}
+
+	private:
+		struct Node {
+			// Few children per node, a linear scan beats hashing
+			std::vector<std::pair<char, uint32_t>> children;
+			std::vector<T> values;
+		};
+
+		static char toKey(char ch) {
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+		}
+
+		uint32_t findChild(uint32_t index, char key) const {
+			for (const auto &[childKey, child] : nodes[index].children) {
+				if (childKey == key) {
+					return child;
+				}
+			}
+			// The root is never a child
+			return 0;
+		}
+
+		std::vector<Node> nodes;
+};
+
+#endif  // SRC_UTILS_PREFIX_TREE_HPP_
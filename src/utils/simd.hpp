@@ -67,4 +67,48 @@ __forceinline unsigned int _mm_ctz(unsigned int value)
 #define _mm_ctz __builtin_ctz
 #endif
 
+// Kernels for newer x86 instruction sets are compiled regardless of the build
+// flags (see SIMD_TARGET) and must only be called after checking the CPU
+#if !defined(__DISABLE_VECTORIZATION__) && (defined(__x86_64__) || defined(_M_X64))
+#define SIMD_X86_DISPATCH 1
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+inline bool cpuSupportsSSSE3()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+inline bool cpuSupportsAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	// OSXSAVE and AVX, the OS must also save the ymm registers
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
 #endif  // SRC_UTILS_SIMD_HPP_
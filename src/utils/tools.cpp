@@ -893,18 +893,150 @@ std::string getSkillName(uint8_t skillid)
 	}
 }
 
+namespace {
+
+constexpr uint32_t ADLER_MODULUS = 65521;
+// Largest n such that 255 * n * (n + 1) / 2 + (n + 1) * (ADLER_MODULUS - 1) fits 32 bits
+constexpr size_t ADLER_NMAX = 5552;
+// Bytes consumed by one iteration of the vectorized kernels
+constexpr size_t ADLER_BLOCK_SIZE = 32;
+
+/**
+ * Vectorized kernels consume whole ADLER_BLOCK_SIZE blocks, update a and b
+ * (both reduced modulo ADLER_MODULUS) and return the amount of bytes done.
+ * The scalar loop handles the tail.
+ */
+using AdlerKernel = size_t (*)(const uint8_t* data, size_t length, uint32_t &a, uint32_t &b);
+
+#if defined(SIMD_X86_DISPATCH)
+// Adler-32 with SSSE3, as done by Chromium's zlib: sad_epu8 sums the bytes
+// into a, maddubs_epi16 weights each byte by its distance to the block end
+// for b, and the a of the previous blocks is added 32 times afterwards
+SIMD_TARGET("ssse3") size_t adlerSSSE3(const uint8_t* data, size_t length, uint32_t &a, uint32_t &b)
+{
+	size_t blocks = length / ADLER_BLOCK_SIZE;
+	const size_t done = blocks * ADLER_BLOCK_SIZE;
+
+	const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+	const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+
+	while (blocks > 0) {
+		size_t count = std::min<size_t>(blocks, ADLER_NMAX / ADLER_BLOCK_SIZE);
+		blocks -= count;
+
+		__m128i previousA = _mm_set_epi32(0, 0, 0, static_cast<int32_t>(a * count));
+		__m128i vectorA = zero;
+		__m128i vectorB = _mm_set_epi32(0, 0, 0, static_cast<int32_t>(b));
+		do {
+			const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+			const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+			previousA = _mm_add_epi32(previousA, vectorA);
+
+			vectorA = _mm_add_epi32(vectorA, _mm_sad_epu8(bytes1, zero));
+			vectorB = _mm_add_epi32(vectorB, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+			vectorA = _mm_add_epi32(vectorA, _mm_sad_epu8(bytes2, zero));
+			vectorB = _mm_add_epi32(vectorB, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+
+			data += ADLER_BLOCK_SIZE;
+		} while (--count);
+
+		vectorB = _mm_add_epi32(vectorB, _mm_slli_epi32(previousA, 5));
+
+		// Horizontal sums
+		vectorA = _mm_add_epi32(vectorA, _mm_shuffle_epi32(vectorA, _MM_SHUFFLE(1, 0, 3, 2)));
+		vectorA = _mm_add_epi32(vectorA, _mm_shuffle_epi32(vectorA, _MM_SHUFFLE(2, 3, 0, 1)));
+		vectorB = _mm_add_epi32(vectorB, _mm_shuffle_epi32(vectorB, _MM_SHUFFLE(1, 0, 3, 2)));
+		vectorB = _mm_add_epi32(vectorB, _mm_shuffle_epi32(vectorB, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(vectorA))) % ADLER_MODULUS;
+		b = static_cast<uint32_t>(_mm_cvtsi128_si32(vectorB)) % ADLER_MODULUS;
+	}
+	return done;
+}
+
+// Same as SSSE3 with the whole 32 bytes block in one register
+SIMD_TARGET("avx2") size_t adlerAVX2(const uint8_t* data, size_t length, uint32_t &a, uint32_t &b)
+{
+	size_t blocks = length / ADLER_BLOCK_SIZE;
+	const size_t done = blocks * ADLER_BLOCK_SIZE;
+
+	const __m256i tap = _mm256_setr_epi8(
+		32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+	);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i ones = _mm256_set1_epi16(1);
+
+	while (blocks > 0) {
+		size_t count = std::min<size_t>(blocks, ADLER_NMAX / ADLER_BLOCK_SIZE);
+		blocks -= count;
+
+		__m256i previousA = _mm256_setr_epi32(static_cast<int32_t>(a * count), 0, 0, 0, 0, 0, 0, 0);
+		__m256i vectorA = zero;
+		__m256i vectorB = _mm256_setr_epi32(static_cast<int32_t>(b), 0, 0, 0, 0, 0, 0, 0);
+		do {
+			const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+			previousA = _mm256_add_epi32(previousA, vectorA);
+			vectorA = _mm256_add_epi32(vectorA, _mm256_sad_epu8(bytes, zero));
+			vectorB = _mm256_add_epi32(vectorB, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, tap), ones));
+			data += ADLER_BLOCK_SIZE;
+		} while (--count);
+
+		vectorB = _mm256_add_epi32(vectorB, _mm256_slli_epi32(previousA, 5));
+
+		// Horizontal sums
+		__m128i sumA = _mm_add_epi32(_mm256_castsi256_si128(vectorA), _mm256_extracti128_si256(vectorA, 1));
+		__m128i sumB = _mm_add_epi32(_mm256_castsi256_si128(vectorB), _mm256_extracti128_si256(vectorB, 1));
+		sumA = _mm_add_epi32(sumA, _mm_shuffle_epi32(sumA, _MM_SHUFFLE(1, 0, 3, 2)));
+		sumA = _mm_add_epi32(sumA, _mm_shuffle_epi32(sumA, _MM_SHUFFLE(2, 3, 0, 1)));
+		sumB = _mm_add_epi32(sumB, _mm_shuffle_epi32(sumB, _MM_SHUFFLE(1, 0, 3, 2)));
+		sumB = _mm_add_epi32(sumB, _mm_shuffle_epi32(sumB, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(sumA))) % ADLER_MODULUS;
+		b = static_cast<uint32_t>(_mm_cvtsi128_si32(sumB)) % ADLER_MODULUS;
+	}
+	return done;
+}
+#endif
+
+size_t adlerNone(const uint8_t*, size_t, uint32_t &, uint32_t &)
+{
+	return 0;
+}
+
+AdlerKernel selectAdlerKernel()
+{
+#if defined(SIMD_X86_DISPATCH)
+	if (cpuSupportsAVX2()) {
+		return adlerAVX2;
+	}
+	if (cpuSupportsSSSE3()) {
+		return adlerSSSE3;
+	}
+#endif
+	return adlerNone;
+}
+
+}  // namespace
+
 uint32_t adlerChecksum(const uint8_t* data, size_t length)
 {
 	if (length > NETWORKMESSAGE_MAXSIZE) {
 		return 0;
 	}
 
-	const uint16_t adler = 65521;
+	static const AdlerKernel kernel = selectAdlerKernel();
 
 	uint32_t a = 1, b = 0;
 
+	size_t done = kernel(data, length, a, b);
+	data += done;
+	length -= done;
+
 	while (length > 0) {
-		size_t tmp = length > 5552 ? 5552 : length;
+		size_t tmp = length > ADLER_NMAX ? ADLER_NMAX : length;
 		length -= tmp;
 
 		do {
@@ -912,8 +1044,8 @@ uint32_t adlerChecksum(const uint8_t* data, size_t length)
 			b += a;
 		} while (--tmp);
 
-		a %= adler;
-		b %= adler;
+		a %= ADLER_MODULUS;
+		b %= ADLER_MODULUS;
 	}
 
 	return (b << 16) | a;
@@ -0,0 +1,59 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "src/pch.hpp"
+#include "src/utils/tools.h"
+#include <catch2/catch.hpp>
+#include <random>
+
+namespace {
+
+uint32_t checksum(const std::string &str) {
+	return adlerChecksum(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+}
+
+}  // namespace
+
+TEST_CASE("Adler-32 reference vectors", "[UnitTest]") {
+	CHECK(checksum("") == 0x00000001);
+	CHECK(checksum("a") == 0x00620062);
+	CHECK(checksum("abc") == 0x024D0127);
+	CHECK(checksum("Wikipedia") == 0x11E60398);
+	CHECK(checksum("message digest") == 0x29750586);
+	CHECK(checksum("abcdefghijklmnopqrstuvwxyz") == 0x90860B20);
+}
+
+TEST_CASE("Adler-32 matches zlib", "[UnitTest]") {
+	// Spare bytes in front of the data, to start at every alignment
+	std::vector<uint8_t> buffer(NETWORKMESSAGE_MAXSIZE + 64);
+	std::mt19937 generator(11);
+	for (uint8_t &byte : buffer) {
+		byte = static_cast<uint8_t>(generator());
+	}
+
+	// Around the 16 bytes vector width and the 5552 bytes reduction interval
+	const std::array<size_t, 9> lengths = {0, 1, 15, 16, 31, 5552, 5553, 20000, NETWORKMESSAGE_MAXSIZE};
+	for (size_t offset = 0; offset < 32; ++offset) {
+		for (size_t length : lengths) {
+			INFO("Offset: " << offset << ", length: " << length);
+			const uint8_t* data = buffer.data() + offset;
+			const auto expected = static_cast<uint32_t>(adler32(1, data, static_cast<uInt>(length)));
+			CHECK(adlerChecksum(data, length) == expected);
+		}
+	}
+
+	SECTION("Bytes of 0xFF, the worst case for the sums") {
+		std::vector<uint8_t> ones(NETWORKMESSAGE_MAXSIZE, 0xFF);
+		for (size_t length : lengths) {
+			INFO("Length: " << length);
+			const auto expected = static_cast<uint32_t>(adler32(1, ones.data(), static_cast<uInt>(length)));
+			CHECK(adlerChecksum(ones.data(), length) == expected);
+		}
+	}
+}
@@ -0,0 +1,151 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "src/pch.hpp"
+#include "src/utils/prefix_tree.hpp"
+#include <catch2/catch.hpp>
+#include <random>
+
+namespace {
+
+using WordMap = std::map<std::string, int>;
+
+// Spells::getInstantSpell before the prefix tree: the longest words, ties to the first in map order
+const std::string* linearSpell(const WordMap &spells, const std::string &words) {
+	const std::string* result = nullptr;
+	for (const auto &it : spells) {
+		const std::string &spellWords = it.first;
+		size_t spellLen = spellWords.length();
+		if (strncasecmp(spellWords.c_str(), words.c_str(), spellLen) == 0) {
+			if (!result || spellLen > result->length()) {
+				result = &it.first;
+				if (words.length() == spellLen) {
+					break;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+// As Spells::getInstantSpell does now
+const std::string* treeSpell(const PrefixTree<const std::string*> &tree, const std::string &words) {
+	const std::string* result = nullptr;
+	tree.forEachPrefix(words, [&result](const std::string* spellWords) {
+		if (!result || spellWords->length() > result->length()
+				|| *spellWords < *result) {
+			result = spellWords;
+		}
+	});
+	return result;
+}
+
+// TalkActions::playerSaySpell before the prefix tree: every matching words, in map order
+std::vector<std::string> linearTalkActions(const WordMap &talkActions, const std::string &words) {
+	std::vector<std::string> result;
+	for (const auto &it : talkActions) {
+		const std::string &talkactionWords = it.first;
+		size_t talkactionLength = talkactionWords.length();
+		if (words.length() < talkactionLength || strncasecmp(words.c_str(), talkactionWords.c_str(), talkactionLength) != 0) {
+			continue;
+		}
+		result.push_back(talkactionWords);
+	}
+	return result;
+}
+
+// As TalkActions::playerSaySpell does now
+std::vector<std::string> treeTalkActions(const PrefixTree<WordMap::const_iterator> &tree, const std::string &words) {
+	std::vector<WordMap::const_iterator> candidates;
+	tree.forEachPrefix(words, [&candidates](WordMap::const_iterator it) {
+		candidates.push_back(it);
+	});
+	if (candidates.size() > 1) {
+		std::sort(candidates.begin(), candidates.end(), [](WordMap::const_iterator lhs, WordMap::const_iterator rhs) {
+			return lhs->first < rhs->first;
+		});
+	}
+
+	std::vector<std::string> result;
+	for (auto it : candidates) {
+		result.push_back(it->first);
+	}
+	return result;
+}
+
+struct Registry {
+	explicit Registry(const std::vector<std::string> &words) {
+		for (const std::string &word : words) {
+			if (auto [it, inserted] = map.try_emplace(word, 0); inserted) {
+				spellTree.insert(it->first, &it->first);
+				talkActionTree.insert(it->first, it);
+			}
+		}
+	}
+
+	void check(const std::string &words) const {
+		INFO("Said: " << words);
+		const std::string* expected = linearSpell(map, words);
+		const std::string* spell = treeSpell(spellTree, words);
+		CHECK(spell == expected);
+		CHECK(treeTalkActions(talkActionTree, words) == linearTalkActions(map, words));
+	}
+
+	WordMap map;
+	PrefixTree<const std::string*> spellTree;
+	PrefixTree<WordMap::const_iterator> talkActionTree;
+};
+
+}  // namespace
+
+TEST_CASE("PrefixTree matches the linear word scans", "[UnitTest]") {
+	const Registry registry({
+		"exura", "exura gran", "exura gran mas res", "exura vita", "Exura", "EXURA ico",
+		"exevo", "exevo gran mas vis", "utevo res", "utevo lux", "!online", "/i", "/info", "/", "!"
+	});
+
+	SECTION("Exact and case-insensitive words") {
+		for (const std::string words : {"exura", "EXURA", "eXuRa GrAn", "exura ico", "Exevo Gran Mas Vis", "utevo lux"}) {
+			registry.check(words);
+		}
+	}
+
+	SECTION("Words that are prefixes of other words") {
+		for (const std::string words : {"exura gra", "exura gran ", "exura gran mas", "exura gran mas res", "/inf", "/info", "!onlin", "ex"}) {
+			registry.check(words);
+		}
+	}
+
+	SECTION("Trailing parameters") {
+		for (const std::string words : {"utevo res \"rat", "/i 3031, 100", "/info Player", "!online now", "exura vitamin", "exura gran mas resurrect", ""}) {
+			registry.check(words);
+		}
+	}
+
+	SECTION("Random words") {
+		std::mt19937 generator(19);
+		const std::string alphabet = "aAeEuUrRsSx /!\"";
+		auto randomWords = [&](size_t maxLength) {
+			std::string words(generator() % (maxLength + 1), ' ');
+			for (char &ch : words) {
+				ch = alphabet[generator() % alphabet.size()];
+			}
+			return words;
+		};
+
+		std::vector<std::string> words;
+		for (int i = 0; i < 200; ++i) {
+			words.push_back(randomWords(6));
+		}
+		const Registry randomRegistry(words);
+		for (int i = 0; i < 20000; ++i) {
+			randomRegistry.check(randomWords(10));
+		}
+	}
+}
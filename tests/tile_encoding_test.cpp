@@ -0,0 +1,71 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "src/pch.hpp"
+#include "src/items/tile.h"
+#include "src/server/network/protocol/protocolgame.h"
+#include <catch2/catch.hpp>
+
+class TileItemsEncodingTest {
+	public:
+		// What a viewer gets for the tile's items, through the cache
+		static std::vector<uint8_t> cached(ProtocolGame &protocol, const Tile* tile) {
+			const TileItemsEncoding* encoding = protocol.getTileItemsEncoding(tile);
+			REQUIRE(encoding != nullptr);
+			const size_t entries = encoding->topEntries + encoding->downEntries;
+			if (entries == 0) {
+				return {};
+			}
+			return std::vector<uint8_t>(encoding->getEntries(), encoding->getEntries() + encoding->getEnd(entries - 1));
+		}
+
+		// The same items encoded one by one, as done without the cache
+		static std::vector<uint8_t> uncached(ProtocolGame &protocol, std::initializer_list<const Item*> items) {
+			NetworkMessage msg;
+			const size_t start = msg.getBufferPosition();
+			for (const Item* item : items) {
+				protocol.AddItem(msg, item);
+			}
+			return std::vector<uint8_t>(msg.getBuffer() + start, msg.getBuffer() + msg.getBufferPosition());
+		}
+};
+
+TEST_CASE("Tile items encoding follows attribute changes", "[UnitTest]") {
+	constexpr uint16_t splashId = 2886;
+	pugi::xml_document doc;
+	pugi::xml_node node = doc.append_child("item");
+	node.append_attribute("id") = splashId;
+	node.append_attribute("name") = "splash";
+	Item::items.parseItemNode(node, splashId);
+	Item::items.getItemType(splashId).group = ITEM_GROUP_SPLASH;
+
+	auto protocol = std::make_shared<ProtocolGame>(nullptr);
+	DynamicTile tile(100, 100, 7);
+	Item* splash = Item::CreateItem(splashId, FLUID_WATER);
+	tile.internalAddThing(splash);
+	splash->incrementReferenceCounter();
+
+	CHECK(TileItemsEncodingTest::cached(*protocol, &tile) == TileItemsEncodingTest::uncached(*protocol, {splash}));
+
+	SECTION("Changing the fluid in place") {
+		const uint32_t version = tile.getItemsVersion();
+		splash->setAttribute(ItemAttribute_t::FLUIDTYPE, FLUID_BLOOD);
+		splash->markTileChanged();
+		CHECK(tile.getItemsVersion() != version);
+		CHECK(TileItemsEncodingTest::cached(*protocol, &tile) == TileItemsEncodingTest::uncached(*protocol, {splash}));
+	}
+
+	SECTION("Items off the tile leave it alone") {
+		const uint32_t version = tile.getItemsVersion();
+		Item* loose = Item::CreateItem(splashId, FLUID_WATER);
+		loose->markTileChanged();
+		CHECK(tile.getItemsVersion() == version);
+		delete loose;
+	}
+}
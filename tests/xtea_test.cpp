@@ -0,0 +1,91 @@
+/**
+ * Canary - A free and open-source MMORPG server emulator
+ * Copyright (©) 2019-2022 OpenTibiaBR <opentibiabr@outlook.com>
+ * Repository: https://github.com/opentibiabr/canary
+ * License: https://github.com/opentibiabr/canary/blob/main/LICENSE
+ * Contributors: https://github.com/opentibiabr/canary/graphs/contributors
+ * Website: https://docs.opentibiabr.org/
+*/
+
+#include "src/pch.hpp"
+#include "src/security/xtea.h"
+#include <catch2/catch.hpp>
+#include <random>
+
+TEST_CASE("XTEA reference vector", "[UnitTest]") {
+	// Words are stored little endian on the wire, 0xDEE9D4D8 0xF7131ED9
+	std::array<uint8_t, 8> data = {};
+	const std::array<uint8_t, 8> expected = {0xD8, 0xD4, 0xE9, 0xDE, 0xD9, 0x1E, 0x13, 0xF7};
+	auto keys = xtea::expandKey({0, 0, 0, 0});
+
+	xtea::encrypt(data.data(), data.size(), keys);
+	CHECK(data == expected);
+
+	xtea::decrypt(data.data(), data.size(), keys);
+	CHECK(data == std::array<uint8_t, 8>{});
+}
+
+TEST_CASE("XTEA vectorized blocks", "[UnitTest]") {
+	// 9 blocks, so every kernel also leaves a block to the scalar tail
+	const std::array<uint8_t, 72> expected = {
+		0x25, 0x60, 0x04, 0xE1, 0xF5, 0x5B, 0xC0, 0xC7, 0xFF, 0x8E, 0x2B, 0x33,
+		0x26, 0x3A, 0x17, 0xF6, 0x20, 0xBB, 0xB5, 0x5D, 0x66, 0xA2, 0x6F, 0x6C,
+		0xB4, 0x64, 0xAA, 0x7B, 0x8B, 0xCE, 0x4B, 0x04, 0xF8, 0x78, 0x46, 0x32,
+		0x9F, 0xAE, 0x7B, 0xD5, 0x5F, 0x36, 0xF0, 0x03, 0x6B, 0x64, 0xD2, 0x8F,
+		0x39, 0xD5, 0x08, 0x0C, 0x9B, 0x40, 0x40, 0x11, 0x9C, 0xAA, 0x03, 0x5C,
+		0xAD, 0xE4, 0x88, 0xF3, 0x23, 0xDC, 0x61, 0xCC, 0x7B, 0x5D, 0x19, 0x13
+	};
+	std::array<uint8_t, 72> plain;
+	std::iota(plain.begin(), plain.end(), 0);
+	auto keys = xtea::expandKey({0x03020100, 0x07060504, 0x0B0A0908, 0x0F0E0D0C});
+
+	INFO("Kernel: " << xtea::getKernelName());
+	std::array<uint8_t, 72> data = plain;
+	xtea::encrypt(data.data(), data.size(), keys);
+	CHECK(data == expected);
+
+	xtea::decrypt(data.data(), data.size(), keys);
+	CHECK(data == plain);
+
+	SECTION("Every length round trips") {
+		for (size_t blocks = 1; blocks <= 9; ++blocks) {
+			std::array<uint8_t, 72> buffer = plain;
+			xtea::encrypt(buffer.data(), blocks * xtea::BLOCK_SIZE, keys);
+			CHECK(std::equal(buffer.begin(), buffer.begin() + blocks * xtea::BLOCK_SIZE, expected.begin()));
+			xtea::decrypt(buffer.data(), blocks * xtea::BLOCK_SIZE, keys);
+			CHECK(buffer == plain);
+		}
+	}
+}
+
+TEST_CASE("XTEA kernels match the scalar code", "[UnitTest]") {
+	const auto kernels = xtea::getSupportedKernels();
+	REQUIRE(kernels.size() >= 1);
+	const xtea::Kernels &scalar = kernels.front();
+	CHECK(std::string(scalar.name) == "scalar");
+
+	auto keys = xtea::expandKey({0x9E3779B9, 0x7F4A7C15, 0xF39CC060, 0x5CEDC834});
+	std::mt19937 generator(7);
+	// Up to 3 groups of the widest kernel, so every remainder is left to the tail
+	std::vector<uint8_t> plain(24 * xtea::BLOCK_SIZE);
+	for (uint8_t &byte : plain) {
+		byte = static_cast<uint8_t>(generator());
+	}
+
+	for (const xtea::Kernels &kernel : kernels) {
+		INFO("Kernel: " << kernel.name);
+		for (size_t blocks = 0; blocks <= 24; ++blocks) {
+			INFO("Blocks: " << blocks);
+			const size_t length = blocks * xtea::BLOCK_SIZE;
+			std::vector<uint8_t> reference(plain.begin(), plain.begin() + length);
+			xtea::encrypt(scalar, reference.data(), length, keys);
+
+			std::vector<uint8_t> data(plain.begin(), plain.begin() + length);
+			xtea::encrypt(kernel, data.data(), length, keys);
+			CHECK(data == reference);
+
+			xtea::decrypt(kernel, data.data(), length, keys);
+			CHECK(std::equal(data.begin(), data.end(), plain.begin()));
+		}
+	}
+}